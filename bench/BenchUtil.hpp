@@ -0,0 +1,29 @@
+#ifndef BENCHUTIL_HPP
+#define BENCHUTIL_HPP
+
+# include <algorithm>
+# include <chrono>
+# include <vector>
+
+// Runs fn `iterations` times and returns the median wall time in milliseconds.
+template <typename F>
+double medianMs(int iterations, F&& fn) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Keeps the optimiser from discarding a computed value.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
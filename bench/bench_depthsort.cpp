@@ -0,0 +1,130 @@
+// Back-to-front ordering of a moving army: 10k and 100k units in a loose
+// formation, marching with a slowly drifting per-unit heading, seen from a camera
+// above and behind them. Keys are built as RenderQueue does (inverted
+// squared distance over the row), with units outside a view rectangle
+// culled. Compares the median per-frame cost of std::sort, a full radix
+// sort and DepthOrder's repair of the previous order, for a fixed
+// camera, a camera following the army, and a camera cutting to a new
+// spot every second. Checks DepthOrder's order against std::sort.
+#include "BenchUtil.hpp"
+#include "DepthOrder.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const int kFrames = 240;
+static const float kDt = 1.0f / 60.0f;
+static const float kSpeed = 2.0f; // units per second
+static const float kViewX = 40.0f; // half extents of the visible rectangle
+static const float kViewZ = 30.0f;
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static float random01() {
+    return float(nextRand() % 65536) / 65536.0f;
+}
+
+struct Army {
+    std::vector<float> x, z, vx, vz;
+};
+
+static Army makeArmy(size_t count) {
+    Army a;
+    size_t side = size_t(std::sqrt(double(count)));
+    for (size_t i = 0; i < count; ++i) {
+        a.x.push_back(float(i % side) * 0.6f + random01() * 0.3f);
+        a.z.push_back(float(i / side) * 0.6f + random01() * 0.3f);
+        a.vx.push_back(kSpeed);
+        a.vz.push_back((random01() - 0.5f) * 0.4f);
+    }
+    return a;
+}
+
+static void march(Army& a) {
+    for (size_t i = 0; i < a.x.size(); ++i) {
+        // drift slowly around the marching direction
+        a.vz[i] = std::max(-0.3f, std::min(0.3f, a.vz[i] + (random01() - 0.5f) * 0.02f));
+        a.x[i] += a.vx[i] * kDt;
+        a.z[i] += a.vz[i] * kDt;
+    }
+}
+
+static void makeKeys(const Army& a, const glm::vec3& eye, const glm::vec2& target, std::vector<uint64_t>& keys) {
+    keys.resize(a.x.size());
+    for (size_t i = 0; i < a.x.size(); ++i) {
+        if (std::fabs(a.x[i] - target.x) > kViewX || std::fabs(a.z[i] - target.y) > kViewZ) {
+            keys[i] = DepthOrder::kCulled;
+            continue;
+        }
+        glm::vec3 d = glm::vec3(a.x[i], 0.5f, a.z[i]) - eye;
+        float dist2 = glm::dot(d, d);
+        uint32_t bits;
+        std::memcpy(&bits, &dist2, sizeof(bits));
+        keys[i] = (uint64_t(~bits) << 32) | uint32_t(i);
+    }
+}
+
+enum class Camera { Fixed, Follow, Cuts };
+
+int main() {
+    std::printf("units   camera   visible   std::sort ms   radix ms   repair ms   repairs  full  abandoned\n");
+    bool ok = true;
+    for (size_t count : {10000, 100000}) {
+        for (Camera camera : {Camera::Fixed, Camera::Follow, Camera::Cuts}) {
+            Army army = makeArmy(count);
+            float side = std::sqrt(float(count)) * 0.6f;
+            glm::vec2 target(side * 0.5f, side * 0.5f);
+            std::vector<uint64_t> keys, sorted;
+            std::vector<uint32_t> order;
+            std::vector<double> stdMs, radixMs, repairMs;
+            DepthOrder full, incremental;
+            size_t visible = 0;
+
+            for (int f = 0; f < kFrames; ++f) {
+                march(army);
+                if (camera == Camera::Follow) {
+                    target.x += kSpeed * kDt;
+                } else if (camera == Camera::Cuts && f % 60 == 59) {
+                    target = glm::vec2(random01() * side, random01() * side);
+                }
+                glm::vec3 eye(target.x, 25.0f, target.y + 35.0f);
+                makeKeys(army, eye, target, keys);
+
+                stdMs.push_back(medianMs(1, [&] {
+                    sorted.clear();
+                    for (uint64_t k : keys) {
+                        if (k != DepthOrder::kCulled) {
+                            sorted.push_back(k);
+                        }
+                    }
+                    std::sort(sorted.begin(), sorted.end());
+                }));
+                radixMs.push_back(medianMs(1, [&] { full.radixSort(keys); }));
+                repairMs.push_back(medianMs(1, [&] { incremental.sort(keys, order); }));
+
+                visible = sorted.size();
+                ok = ok && order.size() == sorted.size();
+                for (size_t i = 0; ok && i < order.size(); ++i) {
+                    ok = order[i] == uint32_t(sorted[i]);
+                }
+            }
+            auto median = [](std::vector<double>& v) {
+                std::sort(v.begin(), v.end());
+                return v[v.size() / 2];
+            };
+            const char* name = camera == Camera::Fixed ? "fixed" : camera == Camera::Follow ? "follow" : "cuts";
+            std::printf("%6zu   %-6s   %7zu   %12.3f   %8.3f   %9.3f   %7zu  %4zu  %9zu\n", count, name, visible,
+                        median(stdMs), median(radixMs), median(repairMs), incremental.repairs, incremental.fullSorts,
+                        incremental.abandoned);
+        }
+    }
+    std::printf("%s\n", ok ? "ok" : "ORDER MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+// Flow field build, incremental repair and per-unit lookup cost on maps of
+// 256^2 to 2048^2 tiles. Every repair is checked against a fresh build and
+// must stay incremental.
+// Orders to every tile of one sector then share a single cached field, and
+// walkers following one of those routes must end on its exact goal tile
+// until its field is evicted.
+#include "BenchUtil.hpp"
+#include "FlowField.hpp"
+#include <cstdio>
+#include <vector>
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Scattered rectangular obstacles and patches of rough (costlier) ground.
+static void makeMap(NavGrid& nav, int size) {
+    nav.create(size, size, 1.0f, 0.0f, 0.0f);
+    int blocks = size * size / 400;
+    for (int i = 0; i < blocks; ++i) {
+        int x = int(nextRand() % uint32_t(size)), y = int(nextRand() % uint32_t(size));
+        int w = 1 + int(nextRand() % 12), h = 1 + int(nextRand() % 12);
+        uint8_t c = (i % 3 == 0) ? uint8_t(2 + nextRand() % 6) : NavGrid::kBlocked;
+        for (int yy = y; yy < std::min(y + h, size); ++yy) {
+            for (int xx = x; xx < std::min(x + w, size); ++xx) {
+                nav.setCost(xx, yy, c);
+            }
+        }
+    }
+    nav.setCost(size / 2, size / 2, 1);
+    nav.trimChanges();
+}
+
+// Follows the route tile by tile from `start`; true if it ends on the goal.
+static bool walk(const NavGrid& nav, FlowRoute& route, uint32_t start, size_t maxSteps) {
+    static const int dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+    static const int dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    uint32_t t = start;
+    for (size_t step = 0; step < maxSteps; ++step) {
+        uint8_t d = route.direction(t);
+        if (d == FlowField::kNoDirection) {
+            return t == route.goal();
+        }
+        t = nav.index(int(t % uint32_t(nav.width())) + dx[d], int(t / uint32_t(nav.width())) + dy[d]);
+    }
+    return false;
+}
+
+static bool sameField(FlowField& a, FlowField& b, size_t tiles) {
+    for (uint32_t t = 0; t < tiles; ++t) {
+        if (a.distance(t) != b.distance(t) || a.direction(t) != b.direction(t)) {
+            std::printf("  field mismatch at tile %u\n", t);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::printf("%6s  %10s  %10s  %12s  %12s  %12s  %8s  %10s\n", "map", "build ms", "repair ms",
+                "repaired", "lazy ns/unit", "warm ns/unit", "orders", "route us");
+    const int sizes[] = {256, 512, 1024, 2048};
+    for (int size : sizes) {
+        NavGrid nav;
+        makeMap(nav, size);
+        const uint32_t goal = nav.index(size / 2, size / 2);
+        const size_t tiles = size_t(size) * size;
+
+        FlowField field;
+        double buildMs = medianMs(5, [&] { field.build(nav, goal); });
+
+        // units scattered over the map sampling their direction
+        const size_t units = 100000;
+        std::vector<float> ux(units), uz(units);
+        for (size_t i = 0; i < units; ++i) {
+            ux[i] = float(nextRand() % uint32_t(size * 64)) / 64.0f;
+            uz[i] = float(nextRand() % uint32_t(size * 64)) / 64.0f;
+        }
+        glm::vec2 sum(0.0f);
+        field.build(nav, goal);
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < units; ++i) {
+            sum += field.directionAt(ux[i], uz[i]);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double lazyNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / units;
+        double warmMs = medianMs(5, [&] {
+            for (size_t i = 0; i < units; ++i) {
+                sum += field.directionAt(ux[i], uz[i]);
+            }
+        });
+        doNotOptimize(sum);
+
+        // a few 6x6 buildings go up, then get torn down again
+        FlowFieldCache cache(4);
+        cache.get(nav, goal);
+        double repairMs = 0.0;
+        size_t repaired = 0;
+        int bx[4], by[4];
+        for (int i = 0; i < 4; ++i) {
+            bx[i] = int(nextRand() % uint32_t(size - 6));
+            by[i] = int(nextRand() % uint32_t(size - 6));
+        }
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < 4; ++i) {
+                for (int y = by[i]; y < by[i] + 6; ++y) {
+                    for (int x = bx[i]; x < bx[i] + 6; ++x) {
+                        if (nav.index(x, y) != goal) {
+                            nav.setCost(x, y, round == 0 ? NavGrid::kBlocked : 1);
+                        }
+                    }
+                }
+            }
+            auto r0 = std::chrono::steady_clock::now();
+            FlowField& cached = cache.get(nav, goal);
+            auto r1 = std::chrono::steady_clock::now();
+            repairMs += std::chrono::duration<double, std::milli>(r1 - r0).count() / 2.0;
+            repaired += cached.tilesRepaired / 2;
+            nav.trimChanges();
+
+            FlowField fresh;
+            fresh.build(nav, goal);
+            if (!sameField(cached, fresh, tiles)) {
+                std::printf("MISMATCH repair vs rebuild on %d^2 map\n", size);
+                return 1;
+            }
+            // a handful of small buildings must never cost a full build
+            if (cached.fullRebuilds != 0) {
+                std::printf("repair fell back to a full build on %d^2 map\n", size);
+                return 1;
+            }
+        }
+        // one order to each walkable tile of the goal's sector
+        const size_t buildsBefore = cache.builds;
+        const int sx = size / 2 / FlowField::kSector * FlowField::kSector;
+        const int sy = sx;
+        std::vector<uint32_t> orders;
+        for (int y = sy; y < sy + FlowField::kSector; ++y) {
+            for (int x = sx; x < sx + FlowField::kSector; ++x) {
+                if (nav.walkable(x, y)) {
+                    orders.push_back(nav.index(x, y));
+                }
+            }
+        }
+        auto o0 = std::chrono::steady_clock::now();
+        for (uint32_t order : orders) {
+            doNotOptimize(cache.route(nav, order).goal());
+        }
+        auto o1 = std::chrono::steady_clock::now();
+        double routeUs = std::chrono::duration<double, std::micro>(o1 - o0).count() / double(orders.size());
+        if (cache.builds != buildsBefore) {
+            std::printf("sector orders rebuilt the field %zu times on %d^2 map\n", cache.builds - buildsBefore,
+                        size);
+            return 1;
+        }
+
+        // walkers from random tiles that can reach the last order's tile
+        FlowRoute route = cache.route(nav, orders.back());
+        FlowField exact;
+        exact.build(nav, route.goal());
+        for (int i = 0; i < 256;) {
+            uint32_t start = nextRand() % uint32_t(tiles);
+            if (exact.distance(start) == FlowField::kUnreachable) {
+                continue;
+            }
+            if (!walk(nav, route, start, tiles)) {
+                std::printf("walker from tile %u missed goal %u on %d^2 map\n", start, route.goal(), size);
+                return 1;
+            }
+            ++i;
+        }
+
+        // orders to as many other sectors as the cache holds evict the
+        // route's field; the route must notice instead of steering there
+        for (int i = 1; i <= 4; ++i) {
+            cache.get(nav, nav.index((sx + i * FlowField::kSector) % size, sy));
+        }
+        if (route.valid() || route.direction(nav.index(sx, sy)) != FlowField::kNoDirection) {
+            std::printf("route outlived its evicted field on %d^2 map\n", size);
+            return 1;
+        }
+
+        std::printf("%4d^2  %10.2f  %10.3f  %12zu  %12.1f  %12.1f  %8zu  %10.1f\n", size, buildMs, repairMs,
+                    repaired, lazyNs, warmMs * 1e6 / units, orders.size(), routeUs);
+    }
+    return 0;
+}
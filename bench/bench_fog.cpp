@@ -0,0 +1,106 @@
+// Fog of war on a 512^2 grid, two players, 1k to 20k wandering viewers
+// with an 8-tile sight radius. Compares incremental restamping against
+// recomputing every player's visibility from scratch each tick, checks
+// both agree on every tile, and reports how much of the fog texture the
+// dirty rects would re-upload.
+#include "BenchUtil.hpp"
+#include "FogOfWar.hpp"
+#include <cstdio>
+#include <vector>
+
+static const int kSize = 512;
+static const int kTicks = 100;
+static const float kSight = 8.0f;
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static float randomCoord() {
+    return float(nextRand() % (kSize * 256)) / 256.0f;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t n : {size_t(1000), size_t(5000), size_t(20000)}) {
+        std::vector<float> x(n), z(n), vx(n), vz(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = randomCoord();
+            z[i] = randomCoord();
+            // a tile every 4..16 ticks, like a walking unit at 60 Hz
+            vx[i] = (float(nextRand() % 512) / 256.0f - 1.0f) * 0.2f;
+            vz[i] = (float(nextRand() % 512) / 256.0f - 1.0f) * 0.2f;
+        }
+        auto advance = [&] {
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += vx[i];
+                z[i] += vz[i];
+                if (x[i] < 0.0f || x[i] >= float(kSize)) {
+                    vx[i] = -vx[i];
+                    x[i] += 2.0f * vx[i];
+                }
+                if (z[i] < 0.0f || z[i] >= float(kSize)) {
+                    vz[i] = -vz[i];
+                    z[i] += 2.0f * vz[i];
+                }
+            }
+        };
+
+        FogOfWar fog;
+        fog.create(kSize, kSize, 1.0f, 0.0f, 0.0f, 2);
+        std::vector<uint32_t> ids(n);
+        for (size_t i = 0; i < n; ++i) {
+            ids[i] = fog.addViewer(int(i & 1), x[i], z[i], kSight);
+        }
+        std::vector<FogRect> rects;
+        fog.takeDirtyRects(0, rects);
+        fog.takeDirtyRects(1, rects);
+
+        FogOfWar fresh;
+        double incremental = 0.0, scratch = 0.0;
+        size_t uploaded = 0, rectCount = 0;
+        fog.viewersRestamped = 0;
+        for (int t = 0; t < kTicks; ++t) {
+            advance();
+            incremental += medianMs(1, [&] {
+                for (size_t i = 0; i < n; ++i) {
+                    fog.moveViewer(ids[i], x[i], z[i]);
+                }
+                rects.clear();
+                fog.takeDirtyRects(0, rects);
+            });
+            for (const FogRect& r : rects) {
+                uploaded += size_t(r.x1 - r.x0) * size_t(r.y1 - r.y0);
+            }
+            rectCount += rects.size();
+            fog.takeDirtyRects(1, rects);
+            scratch += medianMs(1, [&] {
+                fresh.create(kSize, kSize, 1.0f, 0.0f, 0.0f, 2);
+                for (size_t i = 0; i < n; ++i) {
+                    fresh.addViewer(int(i & 1), x[i], z[i], kSight);
+                }
+            });
+        }
+
+        size_t mismatches = 0;
+        for (int p = 0; p < 2; ++p) {
+            for (int y = 0; y < kSize; ++y) {
+                for (int xx = 0; xx < kSize; ++xx) {
+                    mismatches += fog.visible(p, xx, y) != fresh.visible(p, xx, y);
+                }
+            }
+        }
+        std::printf("%6zu viewers: incremental %7.3f ms/tick, from scratch %7.3f ms/tick (%.1fx)\n", n,
+                    incremental / kTicks, scratch / kTicks, scratch / incremental);
+        std::printf("               %.1f%% of viewers restamped per tick, %.1f rects/tick, %.1f%% of texture uploaded\n",
+                    100.0 * double(fog.viewersRestamped) / double(n * kTicks), double(rectCount) / kTicks,
+                    100.0 * double(uploaded) / double(kTicks) / double(kSize * kSize));
+        if (mismatches) {
+            std::printf("               MISMATCH: %zu tiles differ from a fresh build\n", mismatches);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+// The transform feedback particle backend next to the CPU pool, at 1M
+// particles with the same 1-3 s lifetimes and per-frame respawns as
+// bench_particles. Reports particles updated per millisecond for both
+// (the GPU figure waits for the update with glFinish), the time to draw
+// the GPU particles as billboards into a 512x512 target, and checks the
+// GPU state against the CPU pool after two seconds of simulation.
+// Runs headless on EGL; Mesa's llvmpipe is enough.
+#include "BenchUtil.hpp"
+#include "GpuParticles.hpp"
+#include "Particles.hpp"
+#include "thirdparty/glad/include/glad/glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const size_t kLive = 1000000;
+static const size_t kCheck = 4096;
+static const int kFrames = 60;
+static const float kDt = 1.0f / 60.0f;
+static const int kTarget = 512;
+
+static bool createContext() {
+    // no window system here: prefer Mesa's surfaceless platform
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        return false;
+    }
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint n = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &n) || n == 0 || !eglBindAPI(EGL_OPENGL_API)) {
+        return false;
+    }
+    const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                     EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+        return false;
+    }
+    return gladLoadGLLoader((GLADloadproc)eglGetProcAddress) != 0;
+}
+
+static std::string loadFile(const char* path) {
+    std::ifstream file(path);
+    std::stringstream buf;
+    buf << file.rdbuf();
+    return buf.str();
+}
+
+static GLuint compileParticleProgram() {
+    GLuint program = glCreateProgram();
+    const GLenum stages[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    const char* paths[] = {"src/shaders/particle.vert", "src/shaders/particle.frag"};
+    for (int i = 0; i < 2; ++i) {
+        std::string src = loadFile(paths[i]);
+        const char* s = src.c_str();
+        GLuint shader = glCreateShader(stages[i]);
+        glShaderSource(shader, 1, &s, nullptr);
+        glCompileShader(shader);
+        glAttachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    glLinkProgram(program);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked ? program : 0;
+}
+
+static void spawnRandom(ParticleSystem& ps, ParticlePool& pool, size_t n, float lifeMin, float lifeMax) {
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 v(ps.random() - 0.5f, 2.0f + ps.random(), ps.random() - 0.5f);
+        pool.spawn(glm::vec3(ps.random() * 100.0f, 0.0f, ps.random() * 100.0f), v,
+                   lifeMin + (lifeMax - lifeMin) * ps.random());
+    }
+}
+
+int main() {
+    if (!createContext()) {
+        std::printf("no headless GL 3.3 context (EGL), skipping\n");
+        return 0;
+    }
+    std::printf("GL %s, %s\n", (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+
+    float quad[] = {-0.5f, -0.5f, 0.0f, 0.0f,  0.5f, -0.5f, 1.0f, 0.0f,
+                     0.5f,  0.5f, 1.0f, 1.0f, -0.5f,  0.5f, 0.0f, 1.0f};
+    unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+    GLuint quadBuffer, indexBuffer;
+    glGenBuffers(1, &quadBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    ParticleType dust;
+    dust.gravity = -2.0f;
+    dust.drag = 1.5f;
+    bool ok = true;
+
+    // Same spawns on both backends, lives long enough that none expire:
+    // the GPU state must track the CPU pool up to float rounding.
+    {
+        dust.capacity = uint32_t(kCheck);
+        ParticleSystem ps;
+        uint16_t type = ps.addType(dust);
+        ParticlePool& cpu = ps.pools[type];
+        spawnRandom(ps, cpu, kCheck, 100.0f, 100.0f);
+        ParticlePool spawns;
+        spawns.init(dust);
+        spawns.count = cpu.count;
+        spawns.x = cpu.x; spawns.y = cpu.y; spawns.z = cpu.z;
+        spawns.vx = cpu.vx; spawns.vy = cpu.vy; spawns.vz = cpu.vz;
+        spawns.age = cpu.age; spawns.invLife = cpu.invLife;
+
+        GpuParticles gpu;
+        if (!gpu.init(dust, quadBuffer, indexBuffer)) {
+            std::printf("GpuParticles::init failed: %s\n", gpu.error.c_str());
+            return 1;
+        }
+        gpu.emit(spawns);
+        for (int f = 0; f < 2 * kFrames; ++f) {
+            cpu.update(kDt, SimdLevel::Scalar);
+            gpu.update(kDt);
+        }
+        std::vector<GpuParticle> state;
+        gpu.read(state);
+        float maxError = 0.0f;
+        ok = state.size() == cpu.count;
+        for (size_t i = 0; ok && i < state.size(); ++i) {
+            maxError = std::max(maxError, std::fabs(state[i].x - cpu.x[i]));
+            maxError = std::max(maxError, std::fabs(state[i].y - cpu.y[i]));
+            maxError = std::max(maxError, std::fabs(state[i].z - cpu.z[i]));
+            maxError = std::max(maxError, std::fabs(state[i].t - cpu.age[i] * cpu.invLife[i]));
+        }
+        ok = ok && maxError < 1e-3f;
+        std::printf("check: %zu particles, %d frames, max |gpu - cpu| %.2g\n", state.size(), 2 * kFrames, maxError);
+        gpu.destroy();
+    }
+
+    dust.capacity = uint32_t(kLive);
+    const size_t respawn = kLive / 120;
+
+    // CPU backend at its best SIMD level, refilled as particles expire
+    ParticleSystem ps;
+    uint16_t type = ps.addType(dust);
+    ParticlePool& cpu = ps.pools[type];
+    spawnRandom(ps, cpu, kLive, 1.0f, 3.0f);
+    for (int f = 0; f < 180; ++f) {
+        cpu.update(kDt);
+        spawnRandom(ps, cpu, kLive - cpu.count, 1.0f, 3.0f);
+    }
+    double cpuMs = medianMs(kFrames, [&] {
+        cpu.update(kDt);
+        spawnRandom(ps, cpu, kLive - cpu.count, 1.0f, 3.0f);
+    });
+
+    // GPU backend: the ring fills up, then each frame overwrites the oldest
+    ParticleType spawnType = dust;
+    spawnType.capacity = uint32_t(kLive);
+    ParticlePool spawns;
+    spawns.init(spawnType);
+    GpuParticles gpu;
+    if (!gpu.init(dust, quadBuffer, indexBuffer)) {
+        std::printf("GpuParticles::init failed: %s\n", gpu.error.c_str());
+        return 1;
+    }
+    spawnRandom(ps, spawns, kLive, 1.0f, 3.0f);
+    gpu.emit(spawns);
+    gpu.update(kDt);
+    for (int f = 0; f < 30; ++f) {
+        spawnRandom(ps, spawns, respawn, 1.0f, 3.0f);
+        gpu.emit(spawns);
+        gpu.update(kDt);
+    }
+    glFinish();
+    double gpuMs = medianMs(kFrames, [&] {
+        spawnRandom(ps, spawns, respawn, 1.0f, 3.0f);
+        gpu.emit(spawns);
+        gpu.update(kDt);
+        glFinish();
+    });
+
+    // draw the GPU state as billboards, as the game does
+    GLuint program = compileParticleProgram();
+    GLuint target, fbo;
+    glGenRenderbuffers(1, &target);
+    glBindRenderbuffer(GL_RENDERBUFFER, target);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kTarget, kTarget);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target);
+    glViewport(0, 0, kTarget, kTarget);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    double drawMs = -1.0;
+    if (program && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+        // looking straight down on the 100 x 100 spawn square
+        glm::mat4 viewProj(0.0f);
+        viewProj[0][0] = 0.02f;
+        viewProj[2][1] = 0.02f;
+        viewProj[1][2] = 0.001f;
+        viewProj[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+        glUseProgram(program);
+        glUniformMatrix4fv(glGetUniformLocation(program, "uViewProj"), 1, GL_FALSE, &viewProj[0][0]);
+        glUniform3f(glGetUniformLocation(program, "uRight"), 1.0f, 0.0f, 0.0f);
+        glUniform3f(glGetUniformLocation(program, "uUp"), 0.0f, 0.0f, 1.0f);
+        glUniform2f(glGetUniformLocation(program, "uSize"), 0.1f, 0.2f);
+        glUniform4f(glGetUniformLocation(program, "uColorStart"), 1.0f, 1.0f, 1.0f, 0.5f);
+        glUniform4f(glGetUniformLocation(program, "uColorEnd"), 1.0f, 1.0f, 1.0f, 0.0f);
+        glBindVertexArray(gpu.renderVao());
+        drawMs = medianMs(3, [&] {
+            glClear(GL_COLOR_BUFFER_BIT);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(gpu.activeSlots()));
+            glFinish();
+        });
+        glBindVertexArray(0);
+    }
+    ok = ok && glGetError() == GL_NO_ERROR && drawMs >= 0.0;
+
+    std::printf("backend         update ms   particles/ms   draw ms\n");
+    std::printf("cpu (%-6s)     %8.2f   %12.0f         -\n", simdLevelName(detectSimdLevel()), cpuMs, kLive / cpuMs);
+    std::printf("gpu (feedback)  %8.2f   %12.0f  %8.2f\n", gpuMs, kLive / gpuMs, drawMs);
+    std::printf("%s\n", ok ? "ok" : "MISMATCH");
+
+    gpu.destroy();
+    glDeleteProgram(program);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &target);
+    glDeleteBuffers(1, &quadBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// HPA* against flat A* on maps of 256^2 to 2048^2 tiles: query latency,
+// nodes expanded and path quality, then the cost of keeping the abstract
+// graph current while buildings go up and come down. Every path is
+// checked for continuity, and every incremental sync against a fresh build.
+#include "BenchUtil.hpp"
+#include "HierarchicalPathfinder.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Same terrain as bench_flowfield: rectangular obstacles and rough patches.
+static void makeMap(NavGrid& nav, int size) {
+    nav.create(size, size, 1.0f, 0.0f, 0.0f);
+    int blocks = size * size / 400;
+    for (int i = 0; i < blocks; ++i) {
+        int x = int(nextRand() % uint32_t(size)), y = int(nextRand() % uint32_t(size));
+        int w = 1 + int(nextRand() % 12), h = 1 + int(nextRand() % 12);
+        uint8_t c = (i % 3 == 0) ? uint8_t(2 + nextRand() % 6) : NavGrid::kBlocked;
+        for (int yy = y; yy < std::min(y + h, size); ++yy) {
+            for (int xx = x; xx < std::min(x + w, size); ++xx) {
+                nav.setCost(xx, yy, c);
+            }
+        }
+    }
+    nav.trimChanges();
+}
+
+static uint32_t randomOpenTile(const NavGrid& nav) {
+    for (;;) {
+        int x = int(nextRand() % uint32_t(nav.width())), y = int(nextRand() % uint32_t(nav.height()));
+        if (nav.walkable(x, y)) {
+            return nav.index(x, y);
+        }
+    }
+}
+
+// Recomputes the cost of a path step by step; kNoPath if it is broken.
+static uint32_t walkCost(const NavGrid& nav, const std::vector<uint32_t>& path) {
+    uint32_t total = 0;
+    const uint32_t w = uint32_t(nav.width());
+    for (size_t i = 1; i < path.size(); ++i) {
+        int x0 = int(path[i - 1] % w), y0 = int(path[i - 1] / w);
+        int x1 = int(path[i] % w), y1 = int(path[i] / w);
+        int dx = x1 - x0, dy = y1 - y0;
+        if (std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0) || !nav.walkable(x1, y1)) {
+            return GridAStar::kNoPath;
+        }
+        bool diagonal = dx != 0 && dy != 0;
+        if (diagonal && (!nav.walkable(x1, y0) || !nav.walkable(x0, y1))) {
+            return GridAStar::kNoPath;
+        }
+        total += gridStepCost(nav.cost(path[i - 1]), nav.cost(path[i]), diagonal);
+    }
+    return total;
+}
+
+static bool checkPath(const NavGrid& nav, const std::vector<uint32_t>& path, uint32_t start, uint32_t goal,
+                      uint32_t cost) {
+    if (path.empty() || path.front() != start || path.back() != goal || walkCost(nav, path) != cost) {
+        std::printf("  broken path %u -> %u\n", start, goal);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::printf("%6s  %8s  %7s  %10s  %10s  %10s  %10s  %8s  %10s  %9s\n", "map", "build ms", "nodes",
+                "A* us", "A* exp", "HPA* us", "HPA* exp", "cost +%", "sync us", "clusters");
+    const int sizes[] = {256, 512, 1024, 2048};
+    for (int size : sizes) {
+        NavGrid nav;
+        makeMap(nav, size);
+
+        HierarchicalPathfinder hpa;
+        double buildMs = medianMs(3, [&] { hpa.build(nav); });
+
+        const int queries = size >= 2048 ? 20 : 50;
+        std::vector<uint32_t> starts(queries), goals(queries);
+        for (int i = 0; i < queries; ++i) {
+            starts[i] = randomOpenTile(nav);
+            goals[i] = randomOpenTile(nav);
+        }
+
+        GridAStar flat;
+        std::vector<uint32_t> path;
+        double flatUs = 0.0, hpaUs = 0.0, flatExp = 0.0, hpaExp = 0.0, flatCost = 0.0, hpaCost = 0.0;
+        int found = 0;
+        for (int i = 0; i < queries; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            uint32_t a = flat.search(nav, starts[i], goals[i], path);
+            auto t1 = std::chrono::steady_clock::now();
+            if (a != GridAStar::kNoPath && !checkPath(nav, path, starts[i], goals[i], a)) {
+                return 1;
+            }
+            auto t2 = std::chrono::steady_clock::now();
+            uint32_t b = hpa.findPath(starts[i], goals[i], path);
+            auto t3 = std::chrono::steady_clock::now();
+            if (b != HierarchicalPathfinder::kNoPath && !checkPath(nav, path, starts[i], goals[i], b)) {
+                return 1;
+            }
+            if ((a == GridAStar::kNoPath) != (b == HierarchicalPathfinder::kNoPath) || b < a) {
+                std::printf("MISMATCH flat %u vs HPA* %u on %d^2 map\n", a, b, size);
+                return 1;
+            }
+            flatUs += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            hpaUs += std::chrono::duration<double, std::micro>(t3 - t2).count();
+            flatExp += double(flat.expanded);
+            hpaExp += double(hpa.expanded);
+            if (a != GridAStar::kNoPath) {
+                flatCost += a;
+                hpaCost += b;
+                ++found;
+            }
+        }
+
+        // 6x6 buildings go up, then come down; only nearby clusters rebuild
+        double syncUs = 0.0;
+        size_t rebuilt = 0;
+        const int edits = 8;
+        int bx[edits], by[edits];
+        for (int i = 0; i < edits; ++i) {
+            bx[i] = int(nextRand() % uint32_t(size - 6));
+            by[i] = int(nextRand() % uint32_t(size - 6));
+        }
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < edits; ++i) {
+                for (int y = by[i]; y < by[i] + 6; ++y) {
+                    for (int x = bx[i]; x < bx[i] + 6; ++x) {
+                        nav.setCost(x, y, round == 0 ? NavGrid::kBlocked : 1);
+                    }
+                }
+                auto t0 = std::chrono::steady_clock::now();
+                hpa.sync();
+                auto t1 = std::chrono::steady_clock::now();
+                syncUs += std::chrono::duration<double, std::micro>(t1 - t0).count();
+                rebuilt += hpa.clustersRebuilt;
+                nav.trimChanges();
+            }
+
+            HierarchicalPathfinder fresh;
+            fresh.build(nav);
+            if (fresh.nodeCount() != hpa.nodeCount() || fresh.edgeCount() != hpa.edgeCount()) {
+                std::printf("MISMATCH graph after sync on %d^2 map: %zu/%zu nodes, %zu/%zu edges\n", size,
+                            hpa.nodeCount(), fresh.nodeCount(), hpa.edgeCount(), fresh.edgeCount());
+                return 1;
+            }
+            for (int i = 0; i < queries; ++i) {
+                uint32_t s = randomOpenTile(nav), g = randomOpenTile(nav);
+                uint32_t a = hpa.findPath(s, g, path);
+                if (a != HierarchicalPathfinder::kNoPath && !checkPath(nav, path, s, g, a)) {
+                    return 1;
+                }
+                if (a != fresh.findPath(s, g, path)) {
+                    std::printf("MISMATCH synced vs rebuilt query on %d^2 map\n", size);
+                    return 1;
+                }
+            }
+        }
+
+        std::printf("%4d^2  %8.2f  %7zu  %10.1f  %10.0f  %10.1f  %10.0f  %8.2f  %10.1f  %9.1f\n", size, buildMs,
+                    hpa.nodeCount(), flatUs / queries, flatExp / queries, hpaUs / queries, hpaExp / queries,
+                    found ? (hpaCost / flatCost - 1.0) * 100.0 : 0.0, syncUs / (2 * edits),
+                    double(rebuilt) / (2 * edits));
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Scaling of the parallel update phases (animation, kinematics, culling and
+// sort-key generation) from 1 to N threads on 1M entities.
+#include "Animation.hpp"
+#include "BenchUtil.hpp"
+#include "JobSystem.hpp"
+#include "Registry.hpp"
+#include "RenderQueue.hpp"
+#include "Systems.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+int main(int argc, char** argv) {
+    const size_t count = 1000000;
+    const float dt = 1.0f / 60.0f;
+
+    // half the units walk, half stand in a still pose
+    AnimationLibrary clips;
+    clips.loadDefaults();
+    Registry reg;
+    reg.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        float x = float(i % 1000) * 0.02f - 10.0f;
+        float z = float(i / 1000) * 0.02f - 10.0f;
+        Entity e = spawnUnit(reg, glm::vec3(x, 0.5f, z), 0);
+        playClip(reg, clips, e, clips.find((i & 1) ? "walk" : "idle"), 0);
+        if (i % 4 == 0) {
+            jump(reg, e);
+        }
+    }
+
+    glm::vec3 eye(5.0f, 5.0f, 5.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0, 1, 0));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 1.2f, 0.1f, 100.0f);
+    glm::mat4 viewProj = proj * view;
+    RenderQueue queue;
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (argc > 1) {
+        maxThreads = static_cast<unsigned>(std::atoi(argv[1]));
+    }
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t = (t < 4) ? t + 1 : t * 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::printf("entities %zu\n", count);
+    std::printf("threads   update ms   cull+keys ms   speedup\n");
+    double base = 0.0;
+    for (unsigned threads : threadCounts) {
+        JobSystem jobs(threads);
+
+        double update = medianMs(30, [&] {
+            JobCounter phase;
+            auto animate = [&](size_t b, size_t e) { animationRows(reg, dt, b, e); };
+            auto integrate = [&](size_t b, size_t e) { kinematicsRows(reg, dt, b, e); };
+            jobs.parallelFor(phase, 0, reg.animations.size(), 4096, animate);
+            jobs.parallelFor(phase, 0, reg.transforms.size(), 4096, integrate);
+            jobs.wait(phase);
+        });
+
+        queue.prepare(reg, viewProj, eye);
+        double cull = medianMs(30, [&] {
+            JobCounter counter;
+            auto keys = [&](size_t b, size_t e) { queue.keyRows(reg, b, e); };
+            jobs.parallelFor(counter, 0, reg.sprites.size(), 4096, keys);
+            jobs.wait(counter);
+        });
+
+        double total = update + cull;
+        if (threads == 1) {
+            base = total;
+        }
+        std::printf("%7u   %9.3f   %12.3f   %6.2fx\n", threads, update, cull, base / total);
+    }
+
+    // Continuation: the second phase only runs once the first has finished.
+    JobSystem jobs(maxThreads);
+    JobCounter first;
+    JobCounter second;
+    auto animate = [&](size_t b, size_t e) { animationRows(reg, dt, b, e); };
+    auto integrate = [&](size_t b, size_t e) { kinematicsRows(reg, dt, b, e); };
+    double chained = medianMs(30, [&] {
+        jobs.parallelFor(first, 0, reg.animations.size(), 4096, animate);
+        jobs.parallelFor(second, 0, reg.transforms.size(), 4096, integrate, &first);
+        jobs.wait(second);
+    });
+    std::printf("chained phases (%u threads) %.3f ms\n", jobs.threadCount(), chained);
+    return 0;
+}
@@ -0,0 +1,140 @@
+// JPS+ against flat A* on uniform-cost maps of 256^2 to 2048^2 tiles:
+// query latency, nodes closed and heap pushes, then partial table updates
+// while buildings go up and come down. JPS+ costs must match A* exactly,
+// and every synced table must match a fresh build byte for byte.
+#include "BenchUtil.hpp"
+#include "GridAStar.hpp"
+#include "JumpPointSearch.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Rectangular obstacles on open ground, no rough patches.
+static void makeMap(NavGrid& nav, int size) {
+    nav.create(size, size, 1.0f, 0.0f, 0.0f);
+    int blocks = size * size / 400;
+    for (int i = 0; i < blocks; ++i) {
+        int x = int(nextRand() % uint32_t(size)), y = int(nextRand() % uint32_t(size));
+        int w = 1 + int(nextRand() % 12), h = 1 + int(nextRand() % 12);
+        for (int yy = y; yy < std::min(y + h, size); ++yy) {
+            for (int xx = x; xx < std::min(x + w, size); ++xx) {
+                nav.setCost(xx, yy, NavGrid::kBlocked);
+            }
+        }
+    }
+    nav.trimChanges();
+}
+
+static uint32_t randomOpenTile(const NavGrid& nav) {
+    for (;;) {
+        int x = int(nextRand() % uint32_t(nav.width())), y = int(nextRand() % uint32_t(nav.height()));
+        if (nav.walkable(x, y)) {
+            return nav.index(x, y);
+        }
+    }
+}
+
+// Recomputes the cost of a path step by step; kNoPath if it is broken.
+static uint32_t walkCost(const NavGrid& nav, const std::vector<uint32_t>& path) {
+    uint32_t total = 0;
+    const uint32_t w = uint32_t(nav.width());
+    for (size_t i = 1; i < path.size(); ++i) {
+        int x0 = int(path[i - 1] % w), y0 = int(path[i - 1] / w);
+        int x1 = int(path[i] % w), y1 = int(path[i] / w);
+        int dx = x1 - x0, dy = y1 - y0;
+        if (std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0) || !nav.walkable(x1, y1)) {
+            return GridAStar::kNoPath;
+        }
+        bool diagonal = dx != 0 && dy != 0;
+        if (diagonal && (!nav.walkable(x1, y0) || !nav.walkable(x0, y1))) {
+            return GridAStar::kNoPath;
+        }
+        total += gridStepCost(nav.cost(path[i - 1]), nav.cost(path[i]), diagonal);
+    }
+    return total;
+}
+
+int main() {
+    std::printf("%6s  %8s  %10s  %10s  %10s  %10s  %10s  %10s  %10s\n", "map", "build ms", "A* us",
+                "A* exp", "JPS+ us", "JPS+ exp", "JPS+ push", "sync us", "updated");
+    const int sizes[] = {256, 512, 1024, 2048};
+    for (int size : sizes) {
+        NavGrid nav;
+        makeMap(nav, size);
+
+        JumpPointSearch jps;
+        double buildMs = medianMs(3, [&] { jps.build(nav); });
+
+        GridAStar flat;
+        std::vector<uint32_t> path;
+        const int queries = size >= 2048 ? 20 : 50;
+        double flatUs = 0.0, jpsUs = 0.0, flatExp = 0.0, jpsExp = 0.0, jpsPush = 0.0;
+        for (int i = 0; i < queries; ++i) {
+            uint32_t s = randomOpenTile(nav), g = randomOpenTile(nav);
+            auto t0 = std::chrono::steady_clock::now();
+            uint32_t a = flat.search(nav, s, g, path);
+            auto t1 = std::chrono::steady_clock::now();
+            uint32_t b = jps.findPath(s, g, path);
+            auto t2 = std::chrono::steady_clock::now();
+            if (a != b || (b != JumpPointSearch::kNoPath &&
+                           (path.front() != s || path.back() != g || walkCost(nav, path) != b))) {
+                std::printf("MISMATCH A* %u vs JPS+ %u on %d^2 map\n", a, b, size);
+                return 1;
+            }
+            flatUs += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            jpsUs += std::chrono::duration<double, std::micro>(t2 - t1).count();
+            flatExp += double(flat.expanded);
+            jpsExp += double(jps.expanded);
+            jpsPush += double(jps.pushes);
+        }
+
+        // 6x6 buildings go up, then come down again
+        const int edits = 8;
+        int bx[edits], by[edits];
+        for (int i = 0; i < edits; ++i) {
+            bx[i] = int(nextRand() % uint32_t(size - 6));
+            by[i] = int(nextRand() % uint32_t(size - 6));
+        }
+        double syncUs = 0.0;
+        size_t updated = 0;
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < edits; ++i) {
+                for (int y = by[i]; y < by[i] + 6; ++y) {
+                    for (int x = bx[i]; x < bx[i] + 6; ++x) {
+                        nav.setCost(x, y, round == 0 ? NavGrid::kBlocked : 1);
+                    }
+                }
+                auto t0 = std::chrono::steady_clock::now();
+                jps.sync();
+                auto t1 = std::chrono::steady_clock::now();
+                syncUs += std::chrono::duration<double, std::micro>(t1 - t0).count();
+                updated += jps.tilesUpdated;
+                nav.trimChanges();
+            }
+            JumpPointSearch fresh;
+            fresh.build(nav);
+            if (fresh.table() != jps.table()) {
+                std::printf("MISMATCH synced vs rebuilt table on %d^2 map\n", size);
+                return 1;
+            }
+            for (int i = 0; i < queries; ++i) {
+                uint32_t s = randomOpenTile(nav), g = randomOpenTile(nav);
+                if (flat.search(nav, s, g, path) != jps.findPath(s, g, path)) {
+                    std::printf("MISMATCH A* vs JPS+ after sync on %d^2 map\n", size);
+                    return 1;
+                }
+            }
+        }
+
+        std::printf("%4d^2  %8.2f  %10.1f  %10.0f  %10.1f  %10.0f  %10.0f  %10.1f  %10zu\n", size, buildMs,
+                    flatUs / queries, flatExp / queries, jpsUs / queries, jpsExp / queries, jpsPush / queries,
+                    syncUs / (2 * edits), updated / (2 * edits));
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// 250 to 4000 point lights of 0.3-0.8 units scattered over the game's
+// 10x10 field, seen through the game's camera at 1200x1000 with a 1/4
+// resolution light buffer and 16 pixel tiles. Times the CPU binning and
+// counts the light evaluations of the tiled pass against one full-screen
+// pass per light. Also checks that each buffer pixel's tile lists every
+// light whose disc covers that pixel.
+#include "BenchUtil.hpp"
+#include "LightGrid.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <vector>
+
+static const int kWidth = 1200;
+static const int kHeight = 1000;
+static const int kScale = 4;
+static const int kTile = 16;
+static const float kField = 10.0f;
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static float random01() {
+    return float(nextRand() % 65536) / 65536.0f;
+}
+
+// Every pixel centre inside a visible light's disc must find that light
+// in its tile's list.
+static bool checkLists(const LightGrid& grid) {
+    std::vector<int32_t> tileOf(size_t(grid.tilesX) * grid.tilesY, -1);
+    for (size_t t = 0; t < grid.tiles.size(); ++t) {
+        tileOf[size_t(grid.tiles[t].y) * grid.tilesX + grid.tiles[t].x] = int32_t(t);
+    }
+    for (size_t l = 0; l < grid.visible; ++l) {
+        const float* disc = &grid.lightData[l * 8];
+        for (int y = 0; y < grid.height; ++y) {
+            for (int x = 0; x < grid.width; ++x) {
+                float dx = float(x) + 0.5f - disc[0], dy = float(y) + 0.5f - disc[1];
+                if (dx * dx + dy * dy >= disc[2] * disc[2]) {
+                    continue;
+                }
+                int32_t t = tileOf[size_t(y / grid.tileSize) * grid.tilesX + x / grid.tileSize];
+                if (t < 0) {
+                    return false;
+                }
+                const LightTile& tile = grid.tiles[t];
+                bool found = false;
+                for (uint32_t i = 0; i < tile.count && !found; ++i) {
+                    found = grid.indices[tile.first + i] == l;
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    glm::mat4 view = glm::lookAt(glm::vec3(5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), float(kWidth) / float(kHeight), 0.1f, 100.0f);
+    glm::mat4 viewProj = proj * view;
+
+    LightGrid grid;
+    grid.resize(kWidth / kScale, kHeight / kScale, kTile);
+    const double bufferPixels = double(grid.width) * grid.height;
+    const double screenPixels = double(kWidth) * kHeight;
+    bool ok = true;
+
+    std::printf("lights  visible  lit tiles  build ms   tiled evals  per-light screen evals  ratio\n");
+    for (size_t count : {250, 1000, 2000, 4000}) {
+        std::vector<PointLight> lights(count);
+        for (PointLight& l : lights) {
+            l.position = glm::vec3((random01() - 0.5f) * kField, 0.3f, (random01() - 0.5f) * kField);
+            l.radius = 0.3f + 0.5f * random01();
+            l.color = glm::vec3(1.0f, 0.6f, 0.25f);
+        }
+        double ms = medianMs(50, [&] { grid.build(lights.data(), lights.size(), viewProj); });
+
+        // the light pass shades each lit tile's pixels once per listed light
+        double tiled = 0.0;
+        for (const LightTile& t : grid.tiles) {
+            int w = std::min(kTile, grid.width - int(t.x) * kTile);
+            int h = std::min(kTile, grid.height - int(t.y) * kTile);
+            tiled += double(w) * h * (t.count + 1);
+        }
+        double naive = double(grid.visible) * screenPixels;
+        std::printf("%6zu  %7zu  %9zu  %8.3f  %12.3gM  %22.3gM  %5.0fx\n", count, grid.visible, grid.tiles.size(), ms,
+                    tiled / 1e6, naive / 1e6, naive / tiled);
+        ok = ok && checkLists(grid);
+    }
+    std::printf("light buffer %dx%d (%.0fk pixels), %dx%d tiles\n", grid.width, grid.height, bufferPixels / 1e3,
+                grid.tilesX, grid.tilesY);
+    std::printf("%s\n", ok ? "ok" : "MISSING LIGHT");
+    return ok ? 0 : 1;
+}
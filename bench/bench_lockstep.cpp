@@ -0,0 +1,145 @@
+// Two lockstep peers in one process, linked by a loopback transport that
+// drops some packets, single ones or bursts of many in a row. Each peer
+// steps its own Simulation from the exchanged commands; the state must
+// stay bit-identical every tick, a burst must never stall the session for
+// good, and the bytes sent per tick stay constant as the unit count grows.
+#include "BenchUtil.hpp"
+#include "JobSystem.hpp"
+#include "Lockstep.hpp"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Drops the last `burst` of every `period` outgoing packets, to exercise
+// the acks and resends.
+class LossyTransport : public Transport {
+public:
+    LossyTransport(Transport& inner, int period, int burst) : inner(inner), period(period), burst(burst) {}
+
+    void send(const uint8_t* data, size_t size) override {
+        if (sent++ % period < period - burst) {
+            inner.send(data, size);
+        }
+    }
+    bool receive(std::vector<uint8_t>& out) override { return inner.receive(out); }
+
+private:
+    Transport& inner;
+    int period;
+    int burst;
+    int sent = 0;
+};
+
+struct Peer {
+    Simulation sim;
+    LockstepSession session;
+    uint32_t rng;
+    JobSystem* jobs;
+    std::vector<uint64_t> hashes; // checksum after every executed tick
+
+    // Scripted player: random buttons held for a few ticks at a time.
+    PlayerCommand nextCommand() {
+        PlayerCommand cmd;
+        rng = rng * 1664525u + 1013904223u;
+        cmd.buttons = static_cast<uint8_t>((rng >> 24) & 0x1F);
+        return cmd;
+    }
+
+    void frame(uint32_t delay) {
+        session.poll();
+        if (session.scheduledTick() <= session.currentTick() + delay) {
+            session.submitLocal(nextCommand());
+        }
+        if (session.advance(sim, jobs)) {
+            hashes.push_back(sim.checksum);
+        }
+    }
+};
+
+}
+
+int main() {
+    const uint32_t kTicks = 600;
+    const uint32_t kDelay = 2;
+    JobSystem jobs;
+
+    struct Case {
+        int units;
+        int periodA, burstA; // a's outgoing packets
+        int periodB, burstB;
+        const char* loss;
+    };
+    const Case cases[] = {
+        {64, 7, 1, 5, 1, "1/7 1/5"},
+        {1000, 7, 1, 5, 1, "1/7 1/5"},
+        {5000, 7, 1, 5, 1, "1/7 1/5"},
+        {1000, 40, 12, 50, 20, "12/40 20/50"},
+        {1000, 300, 150, 7, 1, "150/300 1/7"},
+    };
+    // frames without either peer executing a tick before calling it a deadlock
+    const int kStuckFrames = 10000;
+
+    std::printf("%8s  %12s  %10s  %12s  %10s  %8s\n", "units", "loss", "ms/tick", "bytes/tick", "stalls", "result");
+    for (const Case& c : cases) {
+        const int units = c.units;
+        auto link = LoopbackTransport::createPair();
+        LossyTransport lossyA(*link.first, c.periodA, c.burstA);
+        LossyTransport lossyB(*link.second, c.periodB, c.burstB);
+
+        Peer a, b;
+        a.rng = 1;
+        b.rng = 2;
+        // one peer uses the job system, the other runs serially
+        a.jobs = &jobs;
+        b.jobs = nullptr;
+        a.sim.init(2, units, 7);
+        b.sim.init(2, units, 7);
+        a.session.start(0, 2, kDelay);
+        b.session.start(1, 2, kDelay);
+        a.session.addPeer(&lossyA);
+        b.session.addPeer(&lossyB);
+
+        size_t checked = 0;
+        bool diverged = false;
+        bool stuck = false;
+        int idleFrames = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        while (a.sim.tick < kTicks || b.sim.tick < kTicks) {
+            uint32_t before = a.sim.tick + b.sim.tick;
+            a.frame(kDelay);
+            b.frame(kDelay);
+            idleFrames = a.sim.tick + b.sim.tick == before ? idleFrames + 1 : 0;
+            if (idleFrames == kStuckFrames) {
+                std::printf("STALLED for good at ticks %u / %u\n", a.sim.tick, b.sim.tick);
+                stuck = true;
+                break;
+            }
+            // compare every tick both peers have run
+            for (; checked < a.hashes.size() && checked < b.hashes.size(); ++checked) {
+                if (a.hashes[checked] != b.hashes[checked]) {
+                    std::printf("DIVERGED at tick %u\n", unsigned(checked + 1));
+                    if (a.sim.tick == b.sim.tick) {
+                        std::printf("  first difference: %s\n",
+                                    a.sim.hasher.firstDivergence(b.sim.hasher).c_str());
+                    }
+                    diverged = true;
+                    break;
+                }
+            }
+            if (diverged) {
+                break;
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        double bytes = double(a.session.bytesSent + b.session.bytesSent) / (2.0 * kTicks);
+        std::printf("%8d  %12s  %10.4f  %12.2f  %10llu  %8s\n", units + 2, c.loss, ms / (2.0 * kTicks), bytes,
+                    (unsigned long long)(a.session.stalls + b.session.stalls),
+                    diverged ? "MISMATCH" : stuck ? "STUCK" : "ok");
+        if (diverged || stuck) {
+            return 1;
+        }
+    }
+    return 0;
+}
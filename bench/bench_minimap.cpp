@@ -0,0 +1,103 @@
+// Minimap upkeep on a 256 x 256 cell map at 4 pixels per cell (a 1024^2
+// terrain image) with 10k units. Compares reshading the whole image, as
+// redrawing the terrain into the minimap every time would, against a
+// terrain edit that only patches the tiles around it, and times the dot
+// list the composite pass is fed at each refresh.
+#include "BenchUtil.hpp"
+#include "Heightfield.hpp"
+#include "Minimap.hpp"
+#include "Systems.hpp"
+#include <cstdio>
+#include <vector>
+
+static const int kCells = 256;
+static const int kCellPixels = 4;
+static const int kUnits = 10000;
+static const float kFrameRate = 60.0f;
+
+static uint32_t rngState = 12345u;
+static uint32_t nextRand() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+int main() {
+    Heightfield terrain;
+    terrain.create(kCells, kCells, 0.5f, -64.0f, -64.0f);
+    terrain.generate(7, 1.0f);
+
+    Minimap minimap;
+    minimap.create(terrain, kCellPixels);
+    std::vector<MinimapRect> rects;
+    std::vector<uint8_t> pixels(size_t(minimap.width()) * minimap.height() * 4);
+
+    // the initial fill, and what every refresh would cost without patching
+    const MinimapRect whole = {0, 0, minimap.width(), minimap.height()};
+    double fullMs = medianMs(10, [&] {
+        minimap.shade(terrain, whole, pixels.data());
+        doNotOptimize(pixels.data());
+    });
+    minimap.takeDirtyRects(rects);
+
+    // a 3 x 3 sample brush raising the ground somewhere on the map
+    size_t patchedPixels = 0;
+    size_t patchedRects = 0;
+    double patchMs = medianMs(200, [&] {
+        int sx = 1 + int(nextRand() % (kCells - 3));
+        int sz = 1 + int(nextRand() % (kCells - 3));
+        for (int z = sz; z < sz + 3; ++z) {
+            for (int x = sx; x < sx + 3; ++x) {
+                terrain.setHeight(x, z, terrain.sample(x, z) + 0.05f);
+            }
+        }
+        minimap.invalidate(sx, sz, sx + 2, sz + 2);
+        rects.clear();
+        minimap.takeDirtyRects(rects);
+        for (const MinimapRect& r : rects) {
+            minimap.shade(terrain, r, pixels.data());
+            patchedPixels += size_t(r.x1 - r.x0) * (r.y1 - r.y0);
+        }
+        patchedRects += rects.size();
+        doNotOptimize(pixels.data());
+    });
+
+    Registry reg;
+    reg.reserve(kUnits);
+    std::vector<uint32_t> own, selection;
+    for (int i = 0; i < kUnits; ++i) {
+        float x = -64.0f + float(nextRand() % 12800) * 0.01f;
+        float z = -64.0f + float(nextRand() % 12800) * 0.01f;
+        Entity e = spawnUnit(reg, {x, 0.0f, z}, 0);
+        if (i % 4 == 0) {
+            own.push_back(e.index);
+        }
+        if (i % 50 == 0) {
+            selection.push_back(e.index);
+        }
+    }
+    std::vector<MinimapDot> dots;
+    double dotsMs = medianMs(200, [&] {
+        minimap.buildDots(reg, terrain, own, selection, dots);
+        doNotOptimize(dots.data());
+    });
+
+    // one second of frames against the refresh clock
+    Minimap clock;
+    clock.create(terrain, 1);
+    int composites = 0;
+    for (int f = 0; f < int(kFrameRate); ++f) {
+        composites += clock.tick(1.0f / kFrameRate) ? 1 : 0;
+    }
+
+    const double calls = 200.0;
+    std::printf("terrain image %d x %d, units %d\n", minimap.width(), minimap.height(), kUnits);
+    std::printf("full reshade   %8.3f ms   %8zu KB upload\n", fullMs,
+                size_t(minimap.width()) * minimap.height() * 4 / 1024);
+    std::printf("edit patch     %8.3f ms   %8.1f KB upload in %.2f rects\n", patchMs,
+                double(patchedPixels) * 4.0 / 1024.0 / calls, double(patchedRects) / calls);
+    std::printf("dot list       %8.3f ms   %8zu instances in one draw\n", dotsMs, dots.size());
+    std::printf("composites     %d per second at %.0f fps (refresh every %.2f s)\n", composites, kFrameRate,
+                clock.refreshInterval);
+    std::printf("%s\n", patchMs * 20.0 < fullMs ? "ok" : "PATCH NOT 20x CHEAPER");
+    return 0;
+}
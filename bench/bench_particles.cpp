@@ -0,0 +1,76 @@
+// One particle pool held at 1M live particles. Lifetimes are 1-3 s, so
+// once ages have spread out about 1/120 of them expire every 60 Hz frame
+// and are respawned. Times the update (integrate, age, swap-remove kill)
+// and the instance write per SIMD level, and checks that every level
+// leaves the pool bit-identical.
+#include "BenchUtil.hpp"
+#include "Particles.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const size_t kLive = 1000000;
+static const int kFrames = 120;
+static const float kDt = 1.0f / 60.0f;
+
+static void refill(ParticleSystem& ps) {
+    ParticlePool& pool = ps.pools[0];
+    while (pool.count < kLive) {
+        glm::vec3 v(ps.random() - 0.5f, 2.0f + ps.random(), ps.random() - 0.5f);
+        pool.spawn(glm::vec3(ps.random() * 100.0f, 0.0f, ps.random() * 100.0f), v, 1.0f + 2.0f * ps.random());
+    }
+}
+
+int main() {
+    ParticleType dust;
+    dust.capacity = uint32_t(kLive);
+    dust.gravity = -2.0f;
+    dust.drag = 1.5f;
+
+    std::vector<ParticleInstance> instances(kLive);
+    std::vector<float> reference;
+    bool ok = true;
+    std::printf("level    update ms   write ms   killed/frame   MB/frame\n");
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (level == SimdLevel::AVX2 && detectSimdLevel() != SimdLevel::AVX2) {
+            continue;
+        }
+        ParticleSystem ps;
+        ps.addType(dust);
+        refill(ps);
+        ParticlePool& pool = ps.pools[0];
+        // one full lifetime first, so ages are spread as in steady state
+        for (int f = 0; f < 180; ++f) {
+            pool.update(kDt, level);
+            refill(ps);
+        }
+
+        std::vector<double> updateMs, writeMs;
+        size_t killed = 0;
+        for (int f = 0; f < kFrames; ++f) {
+            updateMs.push_back(medianMs(1, [&] { pool.update(kDt, level); }));
+            killed += pool.killed;
+            writeMs.push_back(medianMs(1, [&] { pool.writeInstances(instances.data()); }));
+            doNotOptimize(instances[pool.count / 2]);
+            refill(ps);
+        }
+        std::sort(updateMs.begin(), updateMs.end());
+        std::sort(writeMs.begin(), writeMs.end());
+
+        std::vector<float> state;
+        for (const std::vector<float>* col : {&pool.x, &pool.y, &pool.z, &pool.vx, &pool.vy, &pool.vz, &pool.age}) {
+            state.insert(state.end(), col->begin(), col->begin() + pool.count);
+        }
+        bool same = reference.empty() ||
+                    (state.size() == reference.size() &&
+                     std::memcmp(state.data(), reference.data(), state.size() * sizeof(float)) == 0);
+        if (reference.empty()) {
+            reference.swap(state);
+        }
+        ok = ok && same;
+        std::printf("%-7s %9.3f %10.3f %14zu %10.2f%s\n", simdLevelName(level), updateMs[kFrames / 2],
+                    writeMs[kFrames / 2], killed / kFrames,
+                    double(kLive * sizeof(ParticleInstance)) / (1024.0 * 1024.0), same ? "" : "   MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
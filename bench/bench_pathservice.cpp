@@ -0,0 +1,197 @@
+// Path request service on a 512^2 map: 300 frames of unit orders (a few
+// player squads, a steady trickle of AI orders to shared rally points),
+// with buildings placed between frames. Frames are paced at 60 Hz, the
+// rest of each frame sleeping in place of game work. Compares main-thread
+// cost per frame against solving every request inside the frame, and
+// checks each ticket comes back once with the path a direct HPA* query
+// gives.
+#include "BenchUtil.hpp"
+#include "PathService.hpp"
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static void makeMap(NavGrid& nav, int size) {
+    nav.create(size, size, 1.0f, 0.0f, 0.0f);
+    int blocks = size * size / 400;
+    for (int i = 0; i < blocks; ++i) {
+        int x = int(nextRand() % uint32_t(size)), y = int(nextRand() % uint32_t(size));
+        int w = 1 + int(nextRand() % 12), h = 1 + int(nextRand() % 12);
+        uint8_t c = (i % 3 == 0) ? uint8_t(2 + nextRand() % 6) : NavGrid::kBlocked;
+        for (int yy = y; yy < std::min(y + h, size); ++yy) {
+            for (int xx = x; xx < std::min(x + w, size); ++xx) {
+                nav.setCost(xx, yy, c);
+            }
+        }
+    }
+    nav.trimChanges();
+}
+
+static uint32_t randomOpenTile(const NavGrid& nav) {
+    for (;;) {
+        int x = int(nextRand() % uint32_t(nav.width())), y = int(nextRand() % uint32_t(nav.height()));
+        if (nav.walkable(x, y)) {
+            return nav.index(x, y);
+        }
+    }
+}
+
+struct Order {
+    uint32_t start, goal;
+    PathPriority priority;
+};
+
+// Frame f's orders: every 30 frames a 24-unit player squad, plus 4 AI
+// orders a frame from a pool of 200 units heading to one of 8 rally points.
+static std::vector<std::vector<Order>> makeOrders(const NavGrid& nav, int frames) {
+    std::vector<uint32_t> units(200), rally(8);
+    for (uint32_t& u : units) {
+        u = randomOpenTile(nav);
+    }
+    for (uint32_t& r : rally) {
+        r = randomOpenTile(nav);
+    }
+    std::vector<std::vector<Order>> orders(static_cast<size_t>(frames));
+    for (int f = 0; f < frames; ++f) {
+        if (f % 30 == 0) {
+            uint32_t goal = randomOpenTile(nav);
+            for (int i = 0; i < 24; ++i) {
+                orders[size_t(f)].push_back({randomOpenTile(nav), goal, PathPriority::Player});
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            orders[size_t(f)].push_back({units[nextRand() % units.size()], rally[nextRand() % rally.size()],
+                                         PathPriority::Ai});
+        }
+    }
+    return orders;
+}
+
+static void placeBuilding(NavGrid& nav, int frame) {
+    int x = 64 + (frame * 37) % (nav.width() - 128), y = 64 + (frame * 53) % (nav.height() - 128);
+    for (int yy = y; yy < y + 6; ++yy) {
+        for (int xx = x; xx < x + 6; ++xx) {
+            nav.setCost(xx, yy, NavGrid::kBlocked);
+        }
+    }
+}
+
+static double percentile(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    return v[size_t(p / 100.0 * double(v.size() - 1))];
+}
+
+int main() {
+    const int size = 512, frames = 300;
+    NavGrid nav;
+    makeMap(nav, size);
+    const auto orders = makeOrders(nav, frames);
+
+    // baseline: every order solved in the frame it was issued
+    std::vector<double> syncFrames;
+    {
+        NavGrid grid;
+        rng = 12345;
+        makeMap(grid, size);
+        HierarchicalPathfinder hpa;
+        hpa.build(grid);
+        std::vector<uint32_t> path;
+        for (int f = 0; f < frames; ++f) {
+            if (f % 60 == 59) {
+                placeBuilding(grid, f);
+                hpa.sync();
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            for (const Order& o : orders[size_t(f)]) {
+                hpa.findPath(o.start, o.goal, path);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            syncFrames.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+    }
+    std::printf("in-frame: p50 %.2f ms  p99 %.2f ms  max %.2f ms per frame\n", percentile(syncFrames, 50),
+                percentile(syncFrames, 99), percentile(syncFrames, 100));
+
+    const unsigned threadCounts[] = {1, 4};
+    for (unsigned threads : threadCounts) {
+        NavGrid grid;
+        rng = 12345;
+        makeMap(grid, size);
+        HierarchicalPathfinder hpa;
+        hpa.build(grid);
+        HierarchicalPathfinder check;
+        check.build(grid);
+        JobSystem jobs(threads);
+        PathService service(grid, hpa, jobs);
+        service.budgetMs = 2.0;
+
+        std::vector<Order> byTicket(1);
+        std::vector<uint8_t> delivered(1);
+        std::vector<PathResult> results;
+        std::vector<double> frameMs;
+        std::vector<uint32_t> path;
+        size_t maxDepth = 0;
+        auto verify = [&](const std::vector<PathResult>& out) {
+            for (const PathResult& r : out) {
+                const Order& o = byTicket[r.ticket];
+                if (delivered[r.ticket]++ || r.cost != check.findPath(o.start, o.goal, path) ||
+                    (r.cost != HierarchicalPathfinder::kNoPath && *r.tiles != path)) {
+                    std::printf("MISMATCH ticket %u\n", r.ticket);
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        int frame = 0;
+        for (; frame < frames || service.queueDepth() > 0; ++frame) {
+            if (frame % 60 == 59 && frame < frames) {
+                results.clear();
+                service.finish(results);
+                if (!verify(results)) {
+                    return 1;
+                }
+                placeBuilding(grid, frame);
+                check.sync();
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            if (frame < frames) {
+                for (const Order& o : orders[size_t(frame)]) {
+                    uint32_t t = service.request(o.start, o.goal, o.priority);
+                    byTicket.resize(t + 1);
+                    delivered.resize(t + 1);
+                    byTicket[t] = o;
+                }
+            }
+            maxDepth = std::max(maxDepth, service.queueDepth());
+            results.clear();
+            service.update(results);
+            auto t1 = std::chrono::steady_clock::now();
+            frameMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+            if (!verify(results)) {
+                return 1;
+            }
+            std::this_thread::sleep_until(t0 + std::chrono::microseconds(16667));
+        }
+        results.clear();
+        service.finish(results);
+        if (!verify(results) || std::count(delivered.begin() + 1, delivered.end(), 1) != long(service.requests)) {
+            std::printf("MISMATCH: not every ticket was delivered once\n");
+            return 1;
+        }
+        std::printf("service, %u thread%s: main p50 %.2f ms  p99 %.2f ms  max %.2f ms; %d frames to drain\n",
+                    threads, threads > 1 ? "s" : " ", percentile(frameMs, 50), percentile(frameMs, 99),
+                    percentile(frameMs, 100), frame);
+        std::printf("  %zu requests, %zu solved, %zu merged, cache hit rate %.1f%%, max depth %zu\n",
+                    service.requests, service.solved, service.merged, service.cacheHitRate() * 100.0, maxDepth);
+        std::printf("  latency p50 %.1f ms  p90 %.1f ms  p99 %.1f ms\n", service.latencyPercentileMs(50),
+                    service.latencyPercentileMs(90), service.latencyPercentileMs(99));
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Sprite picking and drag-box selection through the BVH against a linear
+// scan over every sprite, for 1k to 50k units seen by an RTS-style camera.
+// Also times the rebuild and the per-frame refit, and checks that both
+// paths return the same sprites (with and without the alpha test).
+#include "Animation.hpp"
+#include "BenchUtil.hpp"
+#include "SpritePicker.hpp"
+#include "Systems.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+static const float kWidth = 1200.0f;
+static const float kHeight = 1000.0f;
+
+static uint32_t seed = 7;
+static float rnd() {
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24);
+}
+
+// A round blob per frame, so roughly a fifth of each quad is transparent.
+static SpriteAlphaMask makeMask() {
+    SpriteAlphaMask mask;
+    mask.width = 4 * 32;
+    mask.height = 7 * 32;
+    mask.alpha.resize(size_t(mask.width) * mask.height);
+    for (int y = 0; y < mask.height; ++y) {
+        for (int x = 0; x < mask.width; ++x) {
+            float u = float(x % 32) / 32.0f - 0.5f + 1.0f / 64.0f;
+            float v = float(y % 32) / 32.0f - 0.5f + 1.0f / 64.0f;
+            mask.alpha[size_t(y) * mask.width + x] = u * u + v * v < 0.25f ? 255 : 0;
+        }
+    }
+    return mask;
+}
+
+// The picking tests of SpritePicker applied to every sprite.
+static uint32_t linearPick(const Registry& reg, const SpritePicker& picker, const glm::mat4& view,
+                           const glm::mat4& proj, float mx, float my, const AnimationLibrary* clips) {
+    glm::mat4 inv = glm::inverse(proj * view);
+    float nx = 2.0f * mx / kWidth - 1.0f, ny = 1.0f - 2.0f * my / kHeight;
+    glm::vec4 a = inv * glm::vec4(nx, ny, -1.0f, 1.0f);
+    glm::vec4 b = inv * glm::vec4(nx, ny, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(a) / a.w;
+    glm::vec3 dir = glm::normalize(glm::vec3(b) / b.w - origin);
+    glm::vec3 right(view[0][0], view[1][0], view[2][0]);
+    glm::vec3 up(view[0][1], view[1][1], view[2][1]);
+    glm::vec3 back(view[0][2], view[1][2], view[2][2]);
+    float facing = glm::dot(dir, back);
+
+    float best = std::numeric_limits<float>::max();
+    uint32_t hit = SpritePicker::kNone;
+    const SpritePool& sp = reg.sprites;
+    const AnimationPool& ap = reg.animations;
+    for (uint32_t row = 0; row < sp.size(); ++row) {
+        glm::vec3 p = getPosition(reg, Entity{sp.entities[row], 0});
+        float t = glm::dot(p - origin, back) / facing;
+        if (t < 0.0f || t >= best) {
+            continue;
+        }
+        glm::vec3 d = origin + dir * t - p;
+        float u = glm::dot(d, right), w = glm::dot(d, up);
+        if (std::fabs(u) > 0.5f || std::fabs(w) > 0.5f) {
+            continue;
+        }
+        if (clips) {
+            uint32_t a = ap.row(sp.entities[row]);
+            const glm::vec4& rect = clips->uv(ap.uvBase[a] + uint32_t(ap.frameIndex[a]));
+            if (!picker.masks[sp.sheet[row]].opaque(rect, u + 0.5f, 0.5f - w)) {
+                continue;
+            }
+        }
+        best = t;
+        hit = sp.entities[row];
+    }
+    return hit;
+}
+
+static void linearSelect(const Registry& reg, const glm::mat4& viewProj, float x0, float y0, float x1, float y1,
+                         std::vector<uint32_t>& out) {
+    float nx0 = 2.0f * std::min(x0, x1) / kWidth - 1.0f;
+    float nx1 = 2.0f * std::max(x0, x1) / kWidth - 1.0f;
+    float ny0 = 1.0f - 2.0f * std::max(y0, y1) / kHeight;
+    float ny1 = 1.0f - 2.0f * std::min(y0, y1) / kHeight;
+    glm::mat4 m = glm::transpose(viewProj);
+    const glm::vec4 planes[6] = {
+        m[0] - nx0 * m[3], nx1 * m[3] - m[0], m[1] - ny0 * m[3], ny1 * m[3] - m[1], m[3] + m[2], m[3] - m[2],
+    };
+    for (uint32_t e : reg.sprites.entities) {
+        glm::vec3 p = getPosition(reg, Entity{e, 0});
+        bool in = true;
+        for (const glm::vec4& pl : planes) {
+            in = in && glm::dot(glm::vec3(pl), p) + pl.w >= 0.0f;
+        }
+        if (in) {
+            out.push_back(e);
+        }
+    }
+}
+
+int main() {
+    std::printf("%7s %9s %9s %11s %11s %9s %11s %11s %8s\n", "units", "build ms", "refit ms", "pick us",
+                "linear us", "nodes", "select us", "linear us", "picked");
+    AnimationLibrary clips;
+    clips.loadDefaults();
+    bool ok = true;
+    for (size_t n : {size_t(1000), size_t(10000), size_t(50000)}) {
+        // ~0.5 units per square metre on flat ground
+        float side = std::sqrt(float(n) * 2.0f);
+        Registry reg;
+        reg.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            Entity e = spawnUnit(reg, glm::vec3(rnd() * side, 0.5f, rnd() * side), 0);
+            playClip(reg, clips, e, uint16_t(rnd() * float(clips.clipCount())), int(rnd() * 8.0f));
+        }
+        AnimationPool& ap = reg.animations;
+        for (size_t a = 0; a < ap.size(); ++a) {
+            ap.frameIndex[a] = int32_t(rnd() * float(ap.frameCount[a]));
+        }
+
+        // looking down at the middle of the field from a corner, high up
+        glm::vec3 centre(side * 0.5f, 0.0f, side * 0.5f);
+        glm::mat4 view = glm::lookAt(centre + glm::vec3(0.0f, side * 0.6f, side * 0.6f), centre,
+                                     glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 proj = glm::perspective(glm::radians(60.0f), kWidth / kHeight, 0.1f, side * 4.0f);
+
+        SpritePicker picker;
+        picker.masks.push_back(makeMask());
+        double build = medianMs(1, [&] { picker.update(reg); });
+
+        // units wander a little each frame; refits keep up without rebuilding
+        double refit = 0.0;
+        const int frames = 20;
+        for (int f = 0; f < frames; ++f) {
+            for (size_t t = 0; t < reg.transforms.size(); ++t) {
+                reg.transforms.x[t] += (rnd() - 0.5f) * 0.1f;
+                reg.transforms.z[t] += (rnd() - 0.5f) * 0.1f;
+            }
+            refit += medianMs(1, [&] { picker.update(reg); });
+        }
+
+        const int queries = 500;
+        std::vector<float> mx(queries), my(queries);
+        for (int q = 0; q < queries; ++q) {
+            mx[q] = rnd() * kWidth;
+            my[q] = rnd() * kHeight;
+        }
+        std::vector<uint32_t> fast(queries), slow(queries);
+        size_t visited = 0, picked = 0;
+        double pick = medianMs(3, [&] {
+            visited = 0;
+            for (int q = 0; q < queries; ++q) {
+                fast[q] = picker.pick(reg, view, proj, kWidth, kHeight, mx[q], my[q], &clips);
+                visited += picker.nodesVisited;
+            }
+        });
+        double linear = medianMs(1, [&] {
+            for (int q = 0; q < queries; ++q) {
+                slow[q] = linearPick(reg, picker, view, proj, mx[q], my[q], &clips);
+            }
+        });
+        for (int q = 0; q < queries; ++q) {
+            picked += fast[q] != SpritePicker::kNone;
+            bool same = fast[q] == slow[q];
+            same = same && picker.pick(reg, view, proj, kWidth, kHeight, mx[q], my[q]) ==
+                               linearPick(reg, picker, view, proj, mx[q], my[q], nullptr);
+            if (!same) {
+                std::printf("  MISMATCH: pick %d\n", q);
+                ok = false;
+                break;
+            }
+        }
+
+        const int boxes = 100;
+        std::vector<uint32_t> a, b;
+        size_t selected = 0;
+        double select = 0.0, linearBox = 0.0;
+        for (int q = 0; q < boxes; ++q) {
+            float x0 = rnd() * kWidth, y0 = rnd() * kHeight;
+            float x1 = x0 + rnd() * 300.0f, y1 = y0 + rnd() * 200.0f;
+            a.clear();
+            b.clear();
+            select += medianMs(1, [&] { picker.selectRect(reg, proj * view, kWidth, kHeight, x0, y0, x1, y1, a); });
+            linearBox += medianMs(1, [&] { linearSelect(reg, proj * view, x0, y0, x1, y1, b); });
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            selected += a.size();
+            if (a != b) {
+                std::printf("  MISMATCH: box %d selected %zu, linear scan %zu\n", q, a.size(), b.size());
+                ok = false;
+                break;
+            }
+        }
+
+        std::printf("%7zu %9.3f %9.3f %11.2f %11.2f %9.1f %11.2f %11.2f %7.0f%%\n", n, build, refit / frames,
+                    pick * 1000.0 / queries, linear * 1000.0 / queries, double(visited) / queries,
+                    select * 1000.0 / boxes, linearBox * 1000.0 / boxes, 100.0 * double(picked) / queries);
+        std::printf("        %zu rebuilds, %zu refits, %.0f units per box\n", picker.rebuilds, picker.refits,
+                    double(selected) / boxes);
+    }
+    return ok ? 0 : 1;
+}
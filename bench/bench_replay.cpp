@@ -0,0 +1,164 @@
+// Replay recording size, headless playback speed and keyframe seeking.
+// With a path argument, plays that recorded session back instead, so a
+// captured game session can be profiled repeatedly.
+#include "BenchUtil.hpp"
+#include "Replay.hpp"
+#include "Snapshot.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+static int playFile(const char* path) {
+    AnimationLibrary clips;
+    clips.loadDefaults();
+    Replay replay;
+    if (!replay.load(path, clips)) {
+        std::printf("cannot load %s\n", path);
+        return 1;
+    }
+    Simulation sim;
+    ReplayPlayer player;
+    double ms = medianMs(3, [&] {
+        player.start(replay, sim);
+        while (player.step(sim)) {
+        }
+    });
+    std::printf("%s: %u ticks, %d units, %.3f ms/tick, %s\n", path, replay.tickCount,
+                int(sim.world.count()), ms / replay.tickCount,
+                player.desyncTick == ~0u ? "in sync" : "DESYNC");
+    return player.desyncTick == ~0u ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return playFile(argv[1]);
+    }
+
+    const uint32_t kTicks = 3600; // one minute at 60 Hz
+    const int kUnits = 5000;
+    Simulation sim;
+    sim.init(2, kUnits, 11);
+    ReplayRecorder recorder;
+    recorder.begin(sim, kUnits, 11, 600);
+
+    // scripted players holding keys for a while, like a human would
+    std::vector<uint64_t> checksums; // state before each tick
+    PlayerCommand cmds[2];
+    uint32_t rng = 77, hold[2] = {0, 0};
+    for (uint32_t t = 0; t < kTicks; ++t) {
+        for (int p = 0; p < 2; ++p) {
+            if (hold[p]-- == 0) {
+                rng = rng * 1664525u + 1013904223u;
+                cmds[p].buttons = static_cast<uint8_t>((rng >> 24) & 0x1F);
+                hold[p] = 10 + (rng >> 8) % 80;
+            }
+        }
+        checksums.push_back(sim.checksum);
+        recorder.record(sim, cmds);
+        sim.step(cmds);
+    }
+    checksums.push_back(sim.checksum);
+    recorder.finish();
+
+    const char* path = "bench/bin/synthetic.replay";
+    Replay replay;
+    if (!recorder.replay.save(path) || !replay.load(path, sim.clips)) {
+        std::printf("replay file round trip failed\n");
+        return 1;
+    }
+    // damaged copies must be refused rather than restored
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const char* damagedPath = "bench/bin/damaged.replay";
+        auto refused = [&](const std::vector<char>& data) {
+            std::ofstream(damagedPath, std::ios::binary).write(data.data(), std::streamsize(data.size()));
+            Replay damaged;
+            return !damaged.load(damagedPath, sim.clips);
+        };
+        std::vector<char> truncated(bytes.begin(), bytes.begin() + bytes.size() * 2 / 3);
+        std::vector<char> flipped = bytes;
+        flipped[bytes.size() - replay.keyframes.back().state.size() / 2] ^= 0x10;
+        if (!refused(truncated) || !refused(flipped)) {
+            std::printf("damaged replay file was accepted\n");
+            return 1;
+        }
+        // well-formed keyframes with matching checksums whose animation
+        // rows index past the clip library or its UV table
+        const Replay::Keyframe& last = replay.keyframes.back();
+        for (int corruption = 0; corruption < 5; ++corruption) {
+            Simulation crafted;
+            SnapshotReader reader{last.state.data(), last.state.data() + last.state.size()};
+            crafted.snapshot(reader);
+            AnimationPool& ap = crafted.world.animations;
+            switch (corruption) {
+            case 0: ap.clip[0] = uint16_t(sim.clips.clipCount()); break;
+            case 1: ap.facing[0] = AnimationClip::kFacings; break;
+            case 2: ap.frameCount[0] = 0; break;
+            case 3: ap.frameIndex[0] = ap.frameCount[0]; break;
+            default: ap.uvBase[0] = uint32_t(sim.clips.uvCount()); break;
+            }
+            ap.markDirty(0);
+            crafted.checksum = crafted.hasher.update(crafted.world);
+            Replay bad = replay;
+            Replay::Keyframe& kf = bad.keyframes.back();
+            kf.checksum = crafted.checksum;
+            SnapshotSizer sizer;
+            crafted.snapshot(sizer);
+            kf.state.resize(sizer.bytes);
+            SnapshotWriter writer{kf.state.data()};
+            crafted.snapshot(writer);
+            Replay reloaded;
+            if (!bad.save(damagedPath) || reloaded.load(damagedPath, sim.clips)) {
+                std::printf("keyframe with corrupted animation row %d was accepted\n", corruption);
+                return 1;
+            }
+        }
+        std::remove(damagedPath);
+    }
+    double loadMs = medianMs(3, [&] {
+        Replay again;
+        again.load(path, sim.clips);
+    });
+
+    size_t keyBytes = 0;
+    for (const Replay::Keyframe& kf : replay.keyframes) {
+        keyBytes += kf.state.size();
+    }
+    std::printf("%u ticks, %d units: commands %zu bytes (%.3f B/tick), %zu keyframes %.1f KB each\n",
+                kTicks, kUnits + 2, replay.stream.size(), double(replay.stream.size()) / kTicks,
+                replay.keyframes.size(), keyBytes / 1024.0 / replay.keyframes.size());
+    std::printf("load and validate %.3f ms; truncated, corrupted and out-of-range copies refused\n", loadMs);
+
+    Simulation play;
+    ReplayPlayer player;
+    double fullMs = medianMs(3, [&] {
+        player.start(replay, play);
+        while (player.step(play)) {
+        }
+    });
+    if (play.checksum != checksums.back() || player.desyncTick != ~0u) {
+        std::printf("MISMATCH full playback\n");
+        return 1;
+    }
+    std::printf("full playback      %9.2f ms (%.3f ms/tick)\n", fullMs, fullMs / kTicks);
+
+    // random seeks, forwards and backwards
+    double seekTotal = 0.0;
+    const int kSeeks = 40;
+    for (int i = 0; i < kSeeks; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t target = (rng >> 8) % (kTicks + 1);
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = player.seek(play, target);
+        auto t1 = std::chrono::steady_clock::now();
+        seekTotal += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (!ok || play.checksum != checksums[target]) {
+            std::printf("MISMATCH seeking to tick %u\n", target);
+            return 1;
+        }
+    }
+    std::printf("seek (avg of %d)   %9.2f ms\n", kSeeks, seekTotal / kSeeks);
+    return 0;
+}
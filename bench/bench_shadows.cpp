@@ -0,0 +1,114 @@
+// Blob shadows for 1k to 10k units scattered over the game's 10x10
+// field, a fifth of them airborne, seen through the game's camera at
+// 1200x1000. Compares per-unit draws against one instanced draw, and
+// rasterises the shadow quads on the CPU to count the fragments each
+// path shades: on screen, or into the 256^2 shadow layer the terrain
+// pass samples.
+#include "BenchUtil.hpp"
+#include "ShadowBatch.hpp"
+#include "Systems.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <vector>
+
+static const int kWidth = 1200;
+static const int kHeight = 1000;
+static const int kLayer = 256;
+static const float kField = 10.0f;
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static float randomCoord() {
+    return float(nextRand() % 65536) / 65536.0f * kField - kField * 0.5f;
+}
+
+static float edge(const glm::vec2& a, const glm::vec2& b, float x, float y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+// Counts pixel centres inside a convex quad into `coverage`; returns how many.
+static size_t rasterQuad(const glm::vec2* q, std::vector<uint16_t>& coverage, int w, int h) {
+    float minX = q[0].x, maxX = q[0].x, minY = q[0].y, maxY = q[0].y;
+    for (int k = 1; k < 4; ++k) {
+        minX = std::min(minX, q[k].x);
+        maxX = std::max(maxX, q[k].x);
+        minY = std::min(minY, q[k].y);
+        maxY = std::max(maxY, q[k].y);
+    }
+    int x0 = std::max(0, int(minX)), x1 = std::min(w - 1, int(maxX));
+    int y0 = std::max(0, int(minY)), y1 = std::min(h - 1, int(maxY));
+    float winding = edge(q[0], q[1], q[2].x, q[2].y) >= 0.0f ? 1.0f : -1.0f;
+    size_t shaded = 0;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            float px = float(x) + 0.5f, py = float(y) + 0.5f;
+            bool inside = true;
+            for (int k = 0; k < 4 && inside; ++k) {
+                inside = edge(q[k], q[(k + 1) & 3], px, py) * winding >= 0.0f;
+            }
+            if (inside) {
+                ++coverage[size_t(y) * w + x];
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
+
+int main() {
+    glm::mat4 view = glm::lookAt(glm::vec3(5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), float(kWidth) / float(kHeight), 0.1f, 100.0f);
+    glm::mat4 viewProj = proj * view;
+
+    std::printf("  units  draws before/after  upload KB before/after  build us   screen frags  overdraw"
+                "   layer frags  overdraw\n");
+    for (size_t n : {size_t(1000), size_t(5000), size_t(10000)}) {
+        Registry reg;
+        std::vector<uint32_t> order;
+        for (size_t i = 0; i < n; ++i) {
+            Entity e = spawnUnit(reg, glm::vec3(randomCoord(), 0.5f, randomCoord()), 0);
+            if (nextRand() % 5 == 0) {
+                jump(reg, e);
+            }
+            order.push_back(uint32_t(i));
+        }
+
+        ShadowBatch batch;
+        double buildMs = medianMs(20, [&] { batch.build(reg, order); });
+
+        std::vector<uint16_t> screen(size_t(kWidth) * kHeight, 0), layer(size_t(kLayer) * kLayer, 0);
+        size_t screenFrags = 0, layerFrags = 0;
+        for (const ShadowInstance& s : batch.instances) {
+            glm::vec2 onScreen[4], onLayer[4];
+            const float cx[4] = {-0.5f, 0.5f, 0.5f, -0.5f}, cz[4] = {-0.5f, -0.5f, 0.5f, 0.5f};
+            for (int k = 0; k < 4; ++k) {
+                glm::vec3 p(s.x + cx[k] * s.sx, s.y, s.z + cz[k] * s.sz);
+                glm::vec4 clip = viewProj * glm::vec4(p, 1.0f);
+                onScreen[k] = glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * kWidth,
+                                        (clip.y / clip.w * 0.5f + 0.5f) * kHeight);
+                onLayer[k] = glm::vec2((p.x / kField + 0.5f) * kLayer, (p.z / kField + 0.5f) * kLayer);
+            }
+            screenFrags += rasterQuad(onScreen, screen, kWidth, kHeight);
+            layerFrags += rasterQuad(onLayer, layer, kLayer, kLayer);
+        }
+        size_t screenCovered = 0, layerCovered = 0;
+        for (uint16_t c : screen) {
+            screenCovered += c != 0;
+        }
+        for (uint16_t c : layer) {
+            layerCovered += c != 0;
+        }
+
+        // per unit: MVP, tint and UV rect uniforms vs one ShadowInstance
+        double before = double(n) * (64 + 16 + 16) / 1024.0;
+        double after = double(n) * sizeof(ShadowInstance) / 1024.0;
+        std::printf("%7zu %11zu/%-7d %14.1f/%-8.1f %8.0f %14zu %9.2f %13zu %9.2f\n", n, n, 1, before, after,
+                    buildMs * 1000.0, screenFrags, double(screenFrags) / double(screenCovered), layerFrags,
+                    double(layerFrags) / double(layerCovered));
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Snapshot ring save/restore cost and heap traffic, plus a rollback check:
+// restoring a snapshot and replaying the same commands must reproduce the
+// same checksums.
+#include "BenchUtil.hpp"
+#include "Snapshot.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static size_t gAllocations = 0;
+
+void* operator new(size_t size) {
+    ++gAllocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main() {
+    std::printf("%8s  %10s  %10s  %10s  %8s  %8s\n", "units", "KB", "save us", "restore us",
+                "allocs", "rollback");
+    const int counts[] = {1000, 10000, 100000};
+    for (int units : counts) {
+        Simulation sim;
+        sim.init(2, units, 3);
+        SnapshotRing ring;
+        ring.reserve(8, sim.world.count(), sim.players.size());
+
+        PlayerCommand cmds[2];
+        auto script = [&](uint32_t t) {
+            cmds[0].buttons = static_cast<uint8_t>((t * 7) & 0x1F);
+            cmds[1].buttons = static_cast<uint8_t>((t * 13) & 0x1F);
+        };
+        for (uint32_t t = 0; t < 30; ++t) {
+            script(sim.tick);
+            sim.step(cmds);
+        }
+
+        // rollback: save, run ahead, restore, replay, compare
+        ring.save(sim);
+        const uint32_t from = sim.tick;
+        uint64_t ahead[20];
+        for (uint64_t& h : ahead) {
+            script(sim.tick);
+            sim.step(cmds);
+            h = sim.checksum;
+        }
+        bool ok = ring.restore(from, sim) && sim.tick == from;
+        for (int i = 0; ok && i < 20; ++i) {
+            script(sim.tick);
+            sim.step(cmds);
+            ok = sim.checksum == ahead[i];
+        }
+
+        // heap traffic of a rollback burst once the ring is warm
+        size_t before = gAllocations;
+        for (int i = 0; i < 16; ++i) {
+            ring.save(sim);
+            ring.restore(sim.tick, sim);
+        }
+        size_t allocs = gAllocations - before;
+
+        // timing: cycle through the ring as rollback would
+        double saveMs = medianMs(51, [&] { ring.save(sim); });
+        double restoreMs = medianMs(51, [&] { ring.restore(sim.tick, sim); });
+
+        std::printf("%8d  %10.1f  %10.2f  %10.2f  %8zu  %8s\n", units + 2, ring.lastBytes / 1024.0,
+                    saveMs * 1000.0, restoreMs * 1000.0, allocs, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            return 1;
+        }
+    }
+    return 0;
+}
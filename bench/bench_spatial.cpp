@@ -0,0 +1,67 @@
+// Spatial hash rebuild + overlap resolution for 50k moving units, plus
+// radius / AABB query cost.
+#include "BenchUtil.hpp"
+#include "SpatialHash.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const size_t counts[] = {5000, 20000, 50000, 100000};
+    std::printf("%8s  %10s  %12s  %10s  %12s  %12s\n",
+                "units", "build ms", "resolve ms", "pairs", "radius us", "aabb us");
+    for (size_t n : counts) {
+        // ~2 units per square metre, radius 0.3
+        float side = std::sqrt(float(n) * 0.5f);
+        std::vector<float> x(n), z(n), r(n, 0.3f), vx(n), vz(n), dx(n), dz(n);
+        uint32_t seed = 7;
+        auto rnd = [&] {
+            seed = seed * 1664525u + 1013904223u;
+            return float(seed >> 8) / float(1u << 24);
+        };
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = rnd() * side;
+            z[i] = rnd() * side;
+            vx[i] = rnd() - 0.5f;
+            vz[i] = rnd() - 0.5f;
+        }
+
+        SpatialHash hash;
+        size_t pairs = 0;
+        double build = 0.0, resolve = 0.0;
+        const int ticks = 20;
+        for (int t = 0; t < ticks; ++t) {
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += vx[i] * 0.016f;
+                z[i] += vz[i] * 0.016f;
+            }
+            build += medianMs(1, [&] { hash.build(x.data(), z.data(), r.data(), n); });
+            resolve += medianMs(1, [&] { pairs = hash.resolveOverlaps(dx.data(), dz.data()); });
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += dx[i];
+                z[i] += dz[i];
+            }
+        }
+
+        std::vector<uint32_t> out;
+        size_t found = 0;
+        const int queries = 1000;
+        double radius = medianMs(5, [&] {
+            for (int q = 0; q < queries; ++q) {
+                hash.queryRadius(rnd() * side, rnd() * side, 3.0f, out);
+                found += out.size();
+            }
+        });
+        double aabb = medianMs(5, [&] {
+            for (int q = 0; q < queries; ++q) {
+                float qx = rnd() * side, qz = rnd() * side;
+                hash.queryAABB(qx, qz, qx + 6.0f, qz + 4.0f, out);
+                found += out.size();
+            }
+        });
+        doNotOptimize(found);
+        std::printf("%8zu  %10.3f  %12.3f  %10zu  %12.3f  %12.3f\n", n, build / ticks, resolve / ticks,
+                    pairs, radius * 1000.0 / queries, aabb * 1000.0 / queries);
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Sprite instance streams for 1k to 100k animated units over 600 ticks,
+// with 1% of the units switching clip or facing every tick. Compares the
+// bytes each frame uploads for animation: per-draw uniforms (one MVP and
+// UV rect per sprite), instances carrying their current frame, and
+// instances whose clips the shader plays from a clock, where only clip
+// changes are sent. Also replays the shader's frame math on the CPU and
+// counts how often it disagrees with the simulated frame.
+#include "Animation.hpp"
+#include "BenchUtil.hpp"
+#include "SpriteBatch.hpp"
+#include "Systems.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const int kTicks = 600;
+static const float kDt = 1.0f / 60.0f;
+
+static uint32_t rng = 12345;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// sprite.vert's clipFrame()
+static uint32_t shaderUv(const SpriteBatch& batch, const std::vector<SpriteClipEntry>& table,
+                         uint32_t row, float clock) {
+    const SpriteClipState& s = batch.clipStates[row];
+    if (s.clip == AnimationLibrary::kNoClip) {
+        return 0;
+    }
+    const SpriteClipEntry& c = table[s.clip];
+    uint32_t frame = 0;
+    if (c.frameDuration > 0.0f) {
+        float elapsed = (clock - s.start) * s.rate;
+        float steps = std::floor(elapsed / c.frameDuration);
+        frame = uint32_t(steps - float(c.frames) * std::floor(steps / float(c.frames)));
+    }
+    return c.firstUv + s.facing * c.frames + frame;
+}
+
+int main() {
+    AnimationLibrary clips;
+    clips.loadDefaults();
+    std::vector<SpriteClipEntry> table;
+    SpriteBatch::clipTable(clips, table);
+    const uint16_t idle = clips.find("idle"), walk = clips.find("walk");
+
+    std::printf("  units   build us   uniforms KB   frames KB   clips KB   anim KB (frames/clips)   "
+                "mismatched\n");
+    for (size_t n : {size_t(1000), size_t(10000), size_t(100000)}) {
+        Registry reg;
+        reg.reserve(n);
+        std::vector<Entity> units;
+        std::vector<uint32_t> order, selection;
+        for (size_t i = 0; i < n; ++i) {
+            units.push_back(spawnUnit(reg, glm::vec3(float(i % 300), 0.5f, float(i / 300)), 0));
+            playClip(reg, clips, units.back(), (i & 1) ? walk : idle, int(nextRand() % 8));
+            order.push_back(uint32_t(i));
+        }
+
+        SpriteBatch frames, clipped;
+        double framesMs = 0.0, clipsMs = 0.0;
+        size_t framesBytes = 0, clipsBytes = 0, framesAnim = 0, clipsAnim = 0;
+        size_t checked = 0, mismatched = 0;
+        for (int t = 0; t < kTicks; ++t) {
+            for (size_t k = 0; k < n / 100; ++k) {
+                Entity e = units[nextRand() % n];
+                uint32_t r = nextRand();
+                playClip(reg, clips, e, (r & 1) ? walk : idle, int((r >> 1) % 8));
+            }
+            animationSystem(reg, kDt);
+            float clock = float(t + 1) * kDt;
+
+            framesMs += medianMs(1, [&] {
+                frames.build(reg, clips, order, selection, clock, SpriteBatch::Mode::Frames);
+            });
+            clipsMs += medianMs(1, [&] {
+                clipped.build(reg, clips, order, selection, clock, SpriteBatch::Mode::Clips);
+            });
+            // the first frame uploads every clip state; count steady state
+            if (t > 0) {
+                framesBytes += frames.instanceBytes;
+                framesAnim += frames.animationBytes;
+                clipsBytes += clipped.instanceBytes + clipped.animationBytes;
+                clipsAnim += clipped.animationBytes;
+            }
+
+            const AnimationPool& ap = reg.animations;
+            for (size_t a = 0; a < ap.size(); a += 7) {
+                ++checked;
+                mismatched += shaderUv(clipped, table, uint32_t(a), clock) != ap.uvBase[a] + uint32_t(ap.frameIndex[a]);
+            }
+        }
+        const double frameCount = double(kTicks - 1);
+        std::printf("%7zu %5.0f/%-5.0f %11.1f %11.1f %10.1f %12.1f /%8.2f   %9.3f%%\n", n,
+                    framesMs * 1000.0 / kTicks, clipsMs * 1000.0 / kTicks,
+                    double(n) * 80.0 / 1024.0, framesBytes / frameCount / 1024.0,
+                    clipsBytes / frameCount / 1024.0, framesAnim / frameCount / 1024.0,
+                    clipsAnim / frameCount / 1024.0, 100.0 * double(mismatched) / double(checked));
+    }
+    return 0;
+}
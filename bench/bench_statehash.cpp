@@ -0,0 +1,88 @@
+// Per-tick world checksums: raw hash throughput per SIMD level, then full
+// versus incremental (dirty chunk) rehash cost for quiet and busy ticks.
+#include "BenchUtil.hpp"
+#include "StateHash.hpp"
+#include "Systems.hpp"
+#include <cstdio>
+#include <vector>
+
+int main() {
+    // every level must agree, including odd tail sizes
+    std::vector<uint8_t> buf(1 << 20);
+    uint32_t seed = 5;
+    for (uint8_t& b : buf) {
+        seed = seed * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(seed >> 24);
+    }
+    const SimdLevel best = detectSimdLevel();
+    for (size_t n : {size_t(0), size_t(1), size_t(63), size_t(64), size_t(1000), buf.size()}) {
+        if (hashBytes(buf.data(), n, 7, SimdLevel::Scalar) != hashBytes(buf.data(), n, 7, best)) {
+            std::printf("MISMATCH scalar vs %s at %zu bytes\n", simdLevelName(best), n);
+            return 1;
+        }
+    }
+    for (SimdLevel level : {SimdLevel::Scalar, best}) {
+        uint64_t h = 0;
+        double ms = medianMs(21, [&] { h ^= hashBytes(buf.data(), buf.size(), h, level); });
+        doNotOptimize(h);
+        std::printf("hashBytes %-6s %8.2f GB/s\n", simdLevelName(level), buf.size() / (ms * 1e6));
+    }
+
+    std::printf("\n%8s  %10s  %12s  %12s  %10s\n", "units", "full ms", "quiet ms", "busy ms", "quiet chunks");
+    const size_t counts[] = {10000, 100000, 1000000};
+    for (size_t n : counts) {
+        Registry world;
+        world.reserve(n);
+        std::vector<Entity> units;
+        for (size_t i = 0; i < n; ++i) {
+            float x = float(i % 1000) * 0.7f;
+            float z = float(i / 1000) * 0.7f;
+            units.push_back(spawnUnit(world, glm::vec3(x, 0.5f, z), 0));
+        }
+        StateHasher hasher;
+        hasher.update(world, true);
+
+        double fullMs = medianMs(9, [&] { hasher.update(world, true); });
+
+        // quiet tick: 1% of units walk, the rest stand still
+        auto quietTick = [&] {
+            for (size_t i = 0; i < n; i += 100) {
+                translate(world, units[i], glm::vec3(0.01f, 0.0f, 0.0f));
+            }
+            animationSystem(world, 1.0f / 60.0f);
+        };
+        double workMs = medianMs(9, quietTick);
+        double quietMs = medianMs(9, [&] {
+            quietTick();
+            hasher.update(world);
+        }) - workMs;
+        size_t quietChunks = hasher.chunksHashed;
+
+        // busy tick: kinematics rewrites transforms, velocities and grounded
+        kinematicsSystem(world, 1.0f / 60.0f);
+        double kinMs = medianMs(9, [&] { kinematicsSystem(world, 1.0f / 60.0f); });
+        double busyMs = medianMs(9, [&] {
+            kinematicsSystem(world, 1.0f / 60.0f);
+            hasher.update(world);
+        }) - kinMs;
+
+        // incremental result must equal a from-scratch hash
+        StateHasher fresh;
+        Registry copy = world;
+        if (fresh.update(copy, true) != hasher.checksum()) {
+            std::printf("MISMATCH incremental vs full at %zu units\n", n);
+            return 1;
+        }
+        // a single flipped value is found and located
+        uint32_t row = world.transforms.row(units[n / 2].index);
+        copy.transforms.y[row] += 1e-3f;
+        copy.transforms.markDirty(row);
+        if (fresh.update(copy) == hasher.checksum()) {
+            std::printf("MISSED corruption at %zu units\n", n);
+            return 1;
+        }
+        std::printf("%8zu  %10.3f  %12.3f  %12.3f  %10zu   -> %s\n", n, fullMs, quietMs, busyMs,
+                    quietChunks, fresh.firstDivergence(hasher).c_str());
+    }
+    return 0;
+}
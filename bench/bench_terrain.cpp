@@ -0,0 +1,44 @@
+// Batched terrain height queries: per-unit cost should stay flat as the
+// number of units grows.
+#include "BenchUtil.hpp"
+#include "Heightfield.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    Heightfield terrain;
+    terrain.create(512, 512, 0.5f, 0.0f, 0.0f);
+    terrain.generate(3, 1.0f);
+
+    // sanity: bilinear lookups reproduce the samples exactly at grid points
+    for (int s = 0; s <= 512; s += 37) {
+        float h = terrain.heightAt(s * 0.5f, (512 - s) * 0.5f);
+        if (h != terrain.sample(s, 512 - s)) {
+            std::printf("MISMATCH at sample %d\n", s);
+            return 1;
+        }
+    }
+
+    std::printf("%10s  %10s  %10s\n", "units", "ms/frame", "ns/unit");
+    const size_t counts[] = {1000, 10000, 100000, 1000000};
+    for (size_t n : counts) {
+        std::vector<float> x(n), z(n), h(n);
+        uint32_t seed = 99;
+        for (size_t i = 0; i < n; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            x[i] = float(seed >> 8) / float(1u << 24) * terrain.maxX();
+            seed = seed * 1664525u + 1013904223u;
+            z[i] = float(seed >> 8) / float(1u << 24) * terrain.maxZ();
+        }
+        int reps = int(2000000 / n) + 1;
+        double ms = medianMs(15, [&] {
+            for (int r = 0; r < reps; ++r) {
+                terrain.heightsAt(x.data(), z.data(), h.data(), n);
+            }
+        });
+        doNotOptimize(h);
+        std::printf("%10zu  %10.4f  %10.3f\n", n, ms / reps, ms * 1e6 / (double(n) * reps));
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Bakes printable ASCII of a font into the 1-bit glyph atlas header used
+// by the overlay (src/DebugFont.hpp). Any font FreeType can open works,
+// bitmap (BDF, PCF) or outline; outlines are rendered monochrome so the
+// text stays crisp at 1:1. Glyphs go in fixed cells, 16 per row, from
+// ' ' to '~', followed by one solid cell the overlay uses for rectangles.
+//
+// Usage: fontatlas FONT PIXELS > src/DebugFont.hpp   (or: make font)
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const int kColumns = 16;
+static const int kFirst = 32;
+static const int kLast = 126;
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s FONT PIXELS\n", argv[0]);
+        return 2;
+    }
+    FT_Library lib;
+    FT_Face face;
+    if (FT_Init_FreeType(&lib) || FT_New_Face(lib, argv[1], 0, &face)) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    if (FT_Set_Pixel_Sizes(face, 0, FT_UInt(std::atoi(argv[2])))) {
+        std::fprintf(stderr, "no %s px size in %s\n", argv[2], argv[1]);
+        return 1;
+    }
+    const int ascender = int(face->size->metrics.ascender >> 6);
+    const int cellW = int(face->size->metrics.max_advance >> 6);
+    const int cellH = ascender - int(face->size->metrics.descender >> 6);
+    const int glyphs = kLast - kFirst + 2; // plus the solid cell
+    const int rows = (glyphs + kColumns - 1) / kColumns;
+    const int width = kColumns * cellW;
+    const int height = rows * cellH;
+    std::vector<uint8_t> pixels(size_t(width) * height, 0);
+
+    for (int c = kFirst; c <= kLast + 1; ++c) {
+        int cx = (c - kFirst) % kColumns * cellW;
+        int cy = (c - kFirst) / kColumns * cellH;
+        if (c == kLast + 1) {
+            for (int y = 0; y < cellH; ++y) {
+                std::fill_n(&pixels[size_t(cy + y) * width + cx], cellW, 1);
+            }
+            continue;
+        }
+        if (FT_Load_Char(face, FT_ULong(c), FT_LOAD_RENDER | FT_LOAD_TARGET_MONO | FT_LOAD_MONOCHROME)) {
+            continue;
+        }
+        const FT_Bitmap& bm = face->glyph->bitmap;
+        int ox = face->glyph->bitmap_left;
+        int oy = ascender - face->glyph->bitmap_top;
+        for (int y = 0; y < int(bm.rows); ++y) {
+            for (int x = 0; x < int(bm.width); ++x) {
+                bool on = bm.pixel_mode == FT_PIXEL_MODE_MONO
+                    ? (bm.buffer[y * bm.pitch + x / 8] >> (7 - x % 8)) & 1
+                    : bm.buffer[y * bm.pitch + x] >= 128;
+                int px = ox + x, py = oy + y;
+                if (on && px >= 0 && px < cellW && py >= 0 && py < cellH) {
+                    pixels[size_t(cy + py) * width + cx + px] = 1;
+                }
+            }
+        }
+    }
+
+    std::string name = argv[1];
+    name = name.substr(name.find_last_of('/') + 1);
+    std::printf("// Generated by scripts/fontatlas.cpp from %s at %s px; do not edit.\n", name.c_str(), argv[2]);
+    std::printf("#ifndef DEBUGFONT_HPP\n#define DEBUGFONT_HPP\n\n# include <cstdint>\n\n");
+    std::printf("// Glyph atlas for ' '..'~' in %dx%d cells, %d per row, then a solid\n", cellW, cellH, kColumns);
+    std::printf("// cell; one bit per pixel, rows top to bottom, most significant bit left.\n");
+    std::printf("namespace DebugFont {\n");
+    std::printf("static constexpr int kCellWidth = %d;\n", cellW);
+    std::printf("static constexpr int kCellHeight = %d;\n", cellH);
+    std::printf("static constexpr int kColumns = %d;\n", kColumns);
+    std::printf("static constexpr int kFirst = %d;\n", kFirst);
+    std::printf("static constexpr int kLast = %d;\n", kLast);
+    std::printf("static constexpr int kSolid = %d; // glyph index of the solid cell\n", glyphs - 1);
+    std::printf("static constexpr int kWidth = %d;\n", width);
+    std::printf("static constexpr int kHeight = %d;\n", height);
+    std::printf("static const uint8_t kBits[] = {");
+    const int stride = (width + 7) / 8;
+    for (int y = 0; y < height; ++y) {
+        std::printf("\n   ");
+        for (int b = 0; b < stride; ++b) {
+            unsigned byte = 0;
+            for (int k = 0; k < 8; ++k) {
+                int x = b * 8 + k;
+                byte = (byte << 1) | (x < width ? pixels[size_t(y) * width + x] : 0);
+            }
+            std::printf(" 0x%02x,", byte);
+        }
+    }
+    std::printf("\n};\n}\n\n#endif\n");
+    FT_Done_Face(face);
+    FT_Done_FreeType(lib);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "Animation.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+# define ANIMATION_SSE2 1
+# include <emmintrin.h>
+#endif
+
+// Sheet2.png: 4 x 7 cells. Rows 0-4 stand facing up, up-right, right,
+// down-right and down; 5 and 6 walk down and up. The left-hand facings
+// mirror the right-hand ones.
+static const char* kDefaultClips =
+    "sheet 4 7\n"
+    "clip idle 1 0   0 1 2 3 4 3m 2m 1m\n"
+    "clip walk 4 0.1 6 6 5 5 5 5m 5m 6m\n";
+
+bool AnimationLibrary::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream buf;
+    buf << file.rdbuf();
+    return parse(buf.str());
+}
+
+void AnimationLibrary::loadDefaults() {
+    parse(kDefaultClips);
+}
+
+bool AnimationLibrary::parse(const std::string& text) {
+    std::vector<AnimationClip> parsed;
+    std::vector<glm::vec4> table;
+    int cols = 1, rows = 1;
+
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string directive;
+        if (!(words >> directive)) {
+            continue;
+        }
+        if (directive == "sheet") {
+            if (!(words >> cols >> rows) || cols < 1 || rows < 1) {
+                error = "line " + std::to_string(lineNo) + ": bad sheet size";
+                return false;
+            }
+            continue;
+        }
+        if (directive != "clip") {
+            error = "line " + std::to_string(lineNo) + ": unknown directive " + directive;
+            return false;
+        }
+
+        AnimationClip c;
+        if (!(words >> c.name >> c.frames >> c.frameDuration) || c.frames < 1 || c.frameDuration < 0.0f) {
+            error = "line " + std::to_string(lineNo) + ": bad clip header";
+            return false;
+        }
+        c.firstUv = uint32_t(table.size());
+        for (int f = 0; f < AnimationClip::kFacings; ++f) {
+            std::string cell;
+            if (!(words >> cell)) {
+                error = "line " + std::to_string(lineNo) + ": expected a row per facing";
+                return false;
+            }
+            bool mirror = cell.back() == 'm';
+            int row = std::atoi(cell.c_str());
+            if (row < 0 || row * cols + c.frames > cols * rows) {
+                error = "line " + std::to_string(lineNo) + ": row out of the sheet";
+                return false;
+            }
+            for (int k = 0; k < c.frames; ++k) {
+                int at = row * cols + k;
+                float u0 = float(at % cols) / float(cols), u1 = float(at % cols + 1) / float(cols);
+                float v0 = float(at / cols) / float(rows), v1 = float(at / cols + 1) / float(rows);
+                table.push_back(mirror ? glm::vec4(u1, v0, u0, v1) : glm::vec4(u0, v0, u1, v1));
+            }
+        }
+        parsed.push_back(c);
+    }
+    if (parsed.empty() || parsed.size() >= kNoClip) {
+        error = "no clips";
+        return false;
+    }
+    clips.swap(parsed);
+    uvs.swap(table);
+    error.clear();
+    return true;
+}
+
+uint16_t AnimationLibrary::find(const char* name) const {
+    for (size_t i = 0; i < clips.size(); ++i) {
+        if (clips[i].name == name) {
+            return uint16_t(i);
+        }
+    }
+    return kNoClip;
+}
+
+int facingFromDirection(float x, float y) {
+    // within 22.5 degrees of an axis when the other component is small
+    const float tan22 = 0.41421356f;
+    float ax = std::fabs(x), ay = std::fabs(y);
+    if (ax <= ay * tan22) {
+        return y >= 0.0f ? 0 : 4;
+    }
+    if (ay <= ax * tan22) {
+        return x >= 0.0f ? 2 : 6;
+    }
+    if (x >= 0.0f) {
+        return y >= 0.0f ? 1 : 3;
+    }
+    return y >= 0.0f ? 7 : 5;
+}
+
+int advanceAnimations(int32_t* frame, float* timer, const int32_t* frameCount,
+                      const float* frameDuration, size_t count, float dt) {
+    size_t i = 0;
+    int playing = 0;
+#ifdef ANIMATION_SSE2
+    const __m128 vdt = _mm_set1_ps(dt);
+    __m128i anyPlaying = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128 duration = _mm_loadu_ps(frameDuration + i);
+        __m128 animated = _mm_cmpgt_ps(duration, _mm_setzero_ps());
+        __m128 t = _mm_add_ps(_mm_loadu_ps(timer + i), _mm_and_ps(vdt, animated));
+        __m128 step = _mm_and_ps(animated, _mm_cmpge_ps(t, duration));
+        t = _mm_sub_ps(t, _mm_and_ps(duration, step));
+        // masks are all ones, so subtracting one adds a frame
+        __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frameCount + i));
+        __m128i f = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + i)),
+                                  _mm_castps_si128(step));
+        f = _mm_sub_epi32(f, _mm_andnot_si128(_mm_cmplt_epi32(f, n), n));
+        _mm_storeu_ps(timer + i, t);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(frame + i), f);
+        anyPlaying = _mm_or_si128(anyPlaying, _mm_castps_si128(animated));
+    }
+    playing = _mm_movemask_epi8(anyPlaying) != 0;
+#endif
+    for (; i < count; ++i) {
+        // selects instead of branches; a still pose never steps
+        int animated = frameDuration[i] > 0.0f;
+        float t = timer[i] + dt * float(animated);
+        int step = animated & int(t >= frameDuration[i]);
+        t -= frameDuration[i] * float(step);
+        int32_t f = frame[i] + step;
+        f -= frameCount[i] & -int32_t(f >= frameCount[i]);
+        timer[i] = t;
+        frame[i] = f;
+        playing |= animated;
+    }
+    return playing;
+}
@@ -0,0 +1,71 @@
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <vector>
+# include <glm/glm.hpp>
+
+// A sprite animation: `frames` consecutive sheet cells per facing, each
+// shown for `frameDuration` seconds (0 = a still pose). Facings run
+// clockwise from "up the screen" in kFacings steps, each with its own
+// start row and optional horizontal mirroring.
+struct AnimationClip {
+    static constexpr int kFacings = 8;
+
+    std::string name;
+    int frames = 1;
+    float frameDuration = 0.0f;
+    uint32_t firstUv = 0; // table index of facing 0, frame 0
+};
+
+// Clip definitions loaded from text, plus the UV rect of every frame of
+// every clip at every facing, computed once at load so neither the
+// animation update nor the renderer does any sheet arithmetic.
+//
+// Format, one directive per line, '#' starts a comment:
+//     sheet <cols> <rows>
+//     clip <name> <frames> <frameDuration> <row>[m] x kFacings
+// A clip uses the last sheet grid given before it; an 'm' after a row
+// mirrors that facing.
+class AnimationLibrary {
+public:
+    static constexpr uint16_t kNoClip = 0xFFFF;
+
+    bool load(const std::string& path);
+    bool parse(const std::string& text);
+    // The built-in clips for the unit sheet, matching the shipped data.
+    void loadDefaults();
+
+    bool empty() const { return clips.empty(); }
+    uint16_t find(const char* name) const;
+    const AnimationClip& clip(uint16_t id) const { return clips[id]; }
+    size_t clipCount() const { return clips.size(); }
+
+    // u0, v0, u1, v1; u0 > u1 for mirrored facings. v0 is the top edge.
+    const glm::vec4& uv(uint32_t index) const { return uvs[index]; }
+    size_t uvCount() const { return uvs.size(); }
+    uint32_t uvIndex(uint16_t clip, int facing, int frame) const {
+        return clips[clip].firstUv + uint32_t(facing * clips[clip].frames + frame);
+    }
+
+    std::string error; // what the last failed load/parse choked on
+
+private:
+    std::vector<AnimationClip> clips;
+    std::vector<glm::vec4> uvs;
+};
+
+// Steps `count` playback rows by dt: timers run, frames advance past their
+// duration and wrap at the frame count. Rows with a zero duration are
+// left as they are. Returns nonzero if any row is playing. The SSE2 and
+// scalar paths give identical results.
+int advanceAnimations(int32_t* frame, float* timer, const int32_t* frameCount,
+                      const float* frameDuration, size_t count, float dt);
+
+// Facing 0..kFacings-1 (clockwise from +y) of a 2D direction, from sign
+// and slope tests rather than atan2, so every platform agrees on it.
+int facingFromDirection(float x, float y);
+
+#endif
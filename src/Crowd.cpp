@@ -0,0 +1,291 @@
+#include "Crowd.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+# define CROWD_X86 1
+# include <immintrin.h>
+#endif
+
+// Constants and helpers shared by both kernels. min/max and every select
+// follow the SIMD instructions' semantics exactly, so lanes and scalar
+// rows round the same way.
+static const float kTinyDist = 1e-4f;
+static const float kTinySq = 1e-6f;
+static const float kTtcBias = 0.1f; // caps the push for imminent contacts
+
+static inline float minf(float a, float b) { return a < b ? a : b; }
+static inline float maxf(float a, float b) { return a > b ? a : b; }
+
+namespace {
+struct SteerInputs {
+    const float *px, *pz, *vx, *vz, *tx, *tz, *r, *ms;
+    const uint32_t* nb;
+    size_t n;
+    float *outX, *outZ, *outVx, *outVz;
+};
+struct SteerConsts {
+    float dt, invSlow, arriveGain, separation, cohesion, avoidance, horizon;
+};
+}
+
+static void steerScalar(const SteerInputs& in, const SteerConsts& c, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const float px = in.px[i], pz = in.pz[i], vx = in.vx[i], vz = in.vz[i];
+        const float r = in.r[i], ms = in.ms[i];
+
+        // arrival: full speed towards the target, braking inside slowRadius
+        float dx = in.tx[i] - px, dz = in.tz[i] - pz;
+        float dist = std::sqrt(dx * dx + dz * dz);
+        float speed = ms * minf(dist * c.invSlow, 1.0f);
+        float inv = dist > kTinyDist ? speed / maxf(dist, kTinyDist) : 0.0f;
+        float ax = (dx * inv - vx) * c.arriveGain;
+        float az = (dz * inv - vz) * c.arriveGain;
+
+        float sepX = 0.0f, sepZ = 0.0f, cohX = 0.0f, cohZ = 0.0f, count = 0.0f, avX = 0.0f, avZ = 0.0f;
+        for (uint32_t k = 0; k < Crowd::kMaxNeighbours; ++k) {
+            const uint32_t j = in.nb[k * in.n + i];
+            const bool valid = j != uint32_t(i);
+            float rx = in.px[j] - px, rz = in.pz[j] - pz;
+            float d2 = rx * rx + rz * rz;
+            float invD2 = 1.0f / maxf(d2, kTinySq);
+            sepX = sepX - (valid ? rx * invD2 : 0.0f);
+            sepZ = sepZ - (valid ? rz * invD2 : 0.0f);
+            cohX = cohX + (valid ? rx : 0.0f);
+            cohZ = cohZ + (valid ? rz : 0.0f);
+            count = count + (valid ? 1.0f : 0.0f);
+
+            // first contact of the two discs at the current relative velocity
+            float wx = in.vx[j] - vx, wz = in.vz[j] - vz;
+            float rr = r + in.r[j];
+            float a = wx * wx + wz * wz;
+            float b = rx * wx + rz * wz;
+            float cc = d2 - rr * rr;
+            float disc = b * b - a * cc;
+            float tau = (0.0f - b - std::sqrt(maxf(disc, 0.0f))) / maxf(a, kTinySq);
+            tau = maxf(tau, 0.0f);
+            bool hit = valid && a > kTinySq && disc > 0.0f && b < 0.0f && tau < c.horizon;
+            float mag = (c.horizon - tau) / (tau + kTtcBias);
+            float qx = rx + wx * tau, qz = rz + wz * tau;
+            float il = 1.0f / maxf(std::sqrt(qx * qx + qz * qz), kTinyDist);
+            avX = avX - (hit ? qx * il * mag : 0.0f);
+            avZ = avZ - (hit ? qz * il * mag : 0.0f);
+        }
+
+        float cohScale = c.cohesion / maxf(count, 1.0f);
+        ax = ax + c.separation * sepX;
+        az = az + c.separation * sepZ;
+        ax = ax + cohX * cohScale;
+        az = az + cohZ * cohScale;
+        ax = ax + c.avoidance * avX;
+        az = az + c.avoidance * avZ;
+
+        float nvx = vx + ax * c.dt, nvz = vz + az * c.dt;
+        float s2 = nvx * nvx + nvz * nvz;
+        float scale = s2 > ms * ms ? ms / std::sqrt(maxf(s2, kTinySq)) : 1.0f;
+        nvx = nvx * scale;
+        nvz = nvz * scale;
+        in.outVx[i] = nvx;
+        in.outVz[i] = nvz;
+        in.outX[i] = px + nvx * c.dt;
+        in.outZ[i] = pz + nvz * c.dt;
+    }
+}
+
+#ifdef CROWD_X86
+
+__attribute__((target("avx2")))
+static size_t steerAVX2(const SteerInputs& in, const SteerConsts& c, size_t begin, size_t end) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 tinyDist = _mm256_set1_ps(kTinyDist);
+    const __m256 tinySq = _mm256_set1_ps(kTinySq);
+    const __m256 ttcBias = _mm256_set1_ps(kTtcBias);
+    const __m256 dt = _mm256_set1_ps(c.dt);
+    const __m256 invSlow = _mm256_set1_ps(c.invSlow);
+    const __m256 gain = _mm256_set1_ps(c.arriveGain);
+    const __m256 horizon = _mm256_set1_ps(c.horizon);
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 px = _mm256_loadu_ps(in.px + i), pz = _mm256_loadu_ps(in.pz + i);
+        const __m256 vx = _mm256_loadu_ps(in.vx + i), vz = _mm256_loadu_ps(in.vz + i);
+        const __m256 r = _mm256_loadu_ps(in.r + i), ms = _mm256_loadu_ps(in.ms + i);
+
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(in.tx + i), px);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(in.tz + i), pz);
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz)));
+        __m256 speed = _mm256_mul_ps(ms, _mm256_min_ps(_mm256_mul_ps(dist, invSlow), one));
+        __m256 inv = _mm256_and_ps(_mm256_cmp_ps(dist, tinyDist, _CMP_GT_OQ),
+                                   _mm256_div_ps(speed, _mm256_max_ps(dist, tinyDist)));
+        __m256 ax = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(dx, inv), vx), gain);
+        __m256 az = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(dz, inv), vz), gain);
+
+        __m256 sepX = zero, sepZ = zero, cohX = zero, cohZ = zero, count = zero, avX = zero, avZ = zero;
+        const __m256i self = _mm256_add_epi32(_mm256_set1_epi32(int(i)), lane);
+        for (uint32_t k = 0; k < Crowd::kMaxNeighbours; ++k) {
+            const __m256i j = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.nb + k * in.n + i));
+            const __m256 valid = _mm256_castsi256_ps(
+                _mm256_xor_si256(_mm256_cmpeq_epi32(j, self), _mm256_set1_epi32(-1)));
+            __m256 rx = _mm256_sub_ps(_mm256_i32gather_ps(in.px, j, 4), px);
+            __m256 rz = _mm256_sub_ps(_mm256_i32gather_ps(in.pz, j, 4), pz);
+            __m256 d2 = _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(rz, rz));
+            __m256 invD2 = _mm256_div_ps(one, _mm256_max_ps(d2, tinySq));
+            sepX = _mm256_sub_ps(sepX, _mm256_and_ps(valid, _mm256_mul_ps(rx, invD2)));
+            sepZ = _mm256_sub_ps(sepZ, _mm256_and_ps(valid, _mm256_mul_ps(rz, invD2)));
+            cohX = _mm256_add_ps(cohX, _mm256_and_ps(valid, rx));
+            cohZ = _mm256_add_ps(cohZ, _mm256_and_ps(valid, rz));
+            count = _mm256_add_ps(count, _mm256_and_ps(valid, one));
+
+            __m256 wx = _mm256_sub_ps(_mm256_i32gather_ps(in.vx, j, 4), vx);
+            __m256 wz = _mm256_sub_ps(_mm256_i32gather_ps(in.vz, j, 4), vz);
+            __m256 rr = _mm256_add_ps(r, _mm256_i32gather_ps(in.r, j, 4));
+            __m256 a = _mm256_add_ps(_mm256_mul_ps(wx, wx), _mm256_mul_ps(wz, wz));
+            __m256 b = _mm256_add_ps(_mm256_mul_ps(rx, wx), _mm256_mul_ps(rz, wz));
+            __m256 cc = _mm256_sub_ps(d2, _mm256_mul_ps(rr, rr));
+            __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, cc));
+            __m256 tau = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), _mm256_sqrt_ps(_mm256_max_ps(disc, zero))),
+                                       _mm256_max_ps(a, tinySq));
+            tau = _mm256_max_ps(tau, zero);
+            __m256 hit = _mm256_and_ps(valid, _mm256_cmp_ps(a, tinySq, _CMP_GT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(disc, zero, _CMP_GT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(b, zero, _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(tau, horizon, _CMP_LT_OQ));
+            __m256 mag = _mm256_div_ps(_mm256_sub_ps(horizon, tau), _mm256_add_ps(tau, ttcBias));
+            __m256 qx = _mm256_add_ps(rx, _mm256_mul_ps(wx, tau));
+            __m256 qz = _mm256_add_ps(rz, _mm256_mul_ps(wz, tau));
+            __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(qx, qx), _mm256_mul_ps(qz, qz)));
+            __m256 il = _mm256_div_ps(one, _mm256_max_ps(len, tinyDist));
+            avX = _mm256_sub_ps(avX, _mm256_and_ps(hit, _mm256_mul_ps(_mm256_mul_ps(qx, il), mag)));
+            avZ = _mm256_sub_ps(avZ, _mm256_and_ps(hit, _mm256_mul_ps(_mm256_mul_ps(qz, il), mag)));
+        }
+
+        __m256 cohScale = _mm256_div_ps(_mm256_set1_ps(c.cohesion), _mm256_max_ps(count, one));
+        const __m256 sepW = _mm256_set1_ps(c.separation), avW = _mm256_set1_ps(c.avoidance);
+        ax = _mm256_add_ps(ax, _mm256_mul_ps(sepW, sepX));
+        az = _mm256_add_ps(az, _mm256_mul_ps(sepW, sepZ));
+        ax = _mm256_add_ps(ax, _mm256_mul_ps(cohX, cohScale));
+        az = _mm256_add_ps(az, _mm256_mul_ps(cohZ, cohScale));
+        ax = _mm256_add_ps(ax, _mm256_mul_ps(avW, avX));
+        az = _mm256_add_ps(az, _mm256_mul_ps(avW, avZ));
+
+        __m256 nvx = _mm256_add_ps(vx, _mm256_mul_ps(ax, dt));
+        __m256 nvz = _mm256_add_ps(vz, _mm256_mul_ps(az, dt));
+        __m256 s2 = _mm256_add_ps(_mm256_mul_ps(nvx, nvx), _mm256_mul_ps(nvz, nvz));
+        __m256 limit = _mm256_div_ps(ms, _mm256_sqrt_ps(_mm256_max_ps(s2, tinySq)));
+        __m256 scale = _mm256_blendv_ps(one, limit, _mm256_cmp_ps(s2, _mm256_mul_ps(ms, ms), _CMP_GT_OQ));
+        nvx = _mm256_mul_ps(nvx, scale);
+        nvz = _mm256_mul_ps(nvz, scale);
+        _mm256_storeu_ps(in.outVx + i, nvx);
+        _mm256_storeu_ps(in.outVz + i, nvz);
+        _mm256_storeu_ps(in.outX + i, _mm256_add_ps(px, _mm256_mul_ps(nvx, dt)));
+        _mm256_storeu_ps(in.outZ + i, _mm256_add_ps(pz, _mm256_mul_ps(nvz, dt)));
+    }
+    return i;
+}
+
+#endif
+
+uint32_t Crowd::add(float px, float pz, float r, float speed) {
+    uint32_t id = uint32_t(x.size());
+    x.push_back(px);
+    z.push_back(pz);
+    vx.push_back(0.0f);
+    vz.push_back(0.0f);
+    targetX.push_back(px);
+    targetZ.push_back(pz);
+    radius.push_back(r);
+    maxSpeed.push_back(speed);
+    return id;
+}
+
+void Crowd::gatherNeighbours(size_t begin, size_t end) {
+    const size_t n = sx.size();
+    uint32_t list[kMaxNeighbours];
+    for (size_t s = begin; s < end; ++s) {
+        uint32_t found = grid.nearestSlots(uint32_t(s), params.neighbourRange, kMaxNeighbours, list);
+        linkCounts[s] = found;
+        for (uint32_t k = 0; k < kMaxNeighbours; ++k) {
+            neighbours[k * n + s] = k < found ? list[k] : uint32_t(s);
+        }
+    }
+}
+
+void Crowd::steerRows(float dt, size_t begin, size_t end, SimdLevel level) {
+    SteerInputs in = {sx.data(), sz.data(), svx.data(), svz.data(), stx.data(), stz.data(), sr.data(), sms.data(),
+                      neighbours.data(), sx.size(), outX.data(), outZ.data(), outVx.data(), outVz.data()};
+    SteerConsts c = {dt, 1.0f / params.slowRadius, params.arriveGain, params.separation,
+                     params.cohesion, params.avoidance, params.horizon};
+    size_t i = begin;
+#ifdef CROWD_X86
+    if (level == SimdLevel::AVX2) {
+        i = steerAVX2(in, c, begin, end);
+    }
+#else
+    (void)level;
+#endif
+    steerScalar(in, c, i, end);
+}
+
+void Crowd::step(float dt, JobSystem* jobs) {
+    step(dt, jobs, detectSimdLevel());
+}
+
+void Crowd::step(float dt, JobSystem* jobs, SimdLevel level) {
+    const size_t n = x.size();
+    if (n == 0) {
+        return;
+    }
+    // the neighbour walk covers 3x3 cells, so a cell must span the range
+    // and still hold the largest agent
+    float maxR = *std::max_element(radius.begin(), radius.end());
+    float cell = std::max(params.neighbourRange, 2.0f * maxR);
+    if (cell != gridCell) {
+        grid = SpatialHash(cell);
+        gridCell = cell;
+    }
+    grid.build(x.data(), z.data(), radius.data(), n);
+
+    const uint32_t* order = grid.sortedIds();
+    for (std::vector<float>* v : {&sx, &sz, &svx, &svz, &stx, &stz, &sr, &sms, &outX, &outZ, &outVx, &outVz}) {
+        v->resize(n);
+    }
+    neighbours.resize(n * kMaxNeighbours);
+    linkCounts.resize(n);
+    for (size_t s = 0; s < n; ++s) {
+        uint32_t a = order[s];
+        sx[s] = x[a];
+        sz[s] = z[a];
+        svx[s] = vx[a];
+        svz[s] = vz[a];
+        stx[s] = targetX[a];
+        stz[s] = targetZ[a];
+        sr[s] = radius[a];
+        sms[s] = maxSpeed[a];
+    }
+
+    // Both phases only write their own rows; steering reads the neighbour
+    // lists of other rows, so the phases are ordered by a dependency.
+    auto gather = [&](size_t b, size_t e) { gatherNeighbours(b, e); };
+    auto steer = [&](size_t b, size_t e) { steerRows(dt, b, e, level); };
+    if (jobs) {
+        JobCounter lists, steered;
+        jobs->parallelFor(lists, 0, n, 1024, gather);
+        jobs->parallelFor(steered, 0, n, 1024, steer, &lists);
+        jobs->wait(steered);
+    } else {
+        gather(0, n);
+        steer(0, n);
+    }
+
+    neighbourLinks = 0;
+    for (size_t s = 0; s < n; ++s) {
+        uint32_t a = order[s];
+        x[a] = outX[s];
+        z[a] = outZ[s];
+        vx[a] = outVx[s];
+        vz[a] = outVz[s];
+        neighbourLinks += linkCounts[s];
+    }
+}
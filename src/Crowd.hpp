@@ -0,0 +1,76 @@
+#ifndef CROWD_HPP
+#define CROWD_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include "Kinematics.hpp"
+# include "SpatialHash.hpp"
+
+class JobSystem;
+
+struct CrowdParams {
+    float neighbourRange = 2.0f; // lower bound of the spatial hash cell size
+    float slowRadius = 1.5f;     // arrival starts braking this far out
+    float arriveGain = 4.0f;     // how quickly velocity follows the desired one
+    float separation = 1.0f;
+    float cohesion = 0.2f;
+    float avoidance = 2.0f;
+    float horizon = 2.0f; // seconds ahead that predicted collisions are avoided
+};
+
+// Local steering for large unit groups: arrival at a target, separation,
+// cohesion, and avoidance of predicted collisions. The avoidance is the
+// reactive time-to-collision form of reciprocal velocity obstacles: a
+// relative velocity inside the velocity obstacle (colliding within
+// `horizon`) pushes both agents apart along the closest-approach
+// direction, harder the sooner the contact.
+//
+// Each step sorts agents into spatial hash cell order, builds a list of
+// the kMaxNeighbours nearest neighbours per agent, then steers batches of
+// 8 agents in SIMD lanes over those sorted SoA copies. The scalar and AVX2
+// kernels produce bit-identical results, and neither reads what the
+// other batches write, so both phases split across the job system.
+class Crowd {
+public:
+    static constexpr uint32_t kMaxNeighbours = 8;
+
+    // Agent state by agent id.
+    std::vector<float> x, z;
+    std::vector<float> vx, vz;
+    std::vector<float> targetX, targetZ;
+    std::vector<float> radius;
+    std::vector<float> maxSpeed;
+
+    CrowdParams params;
+
+    uint32_t add(float px, float pz, float r, float speed);
+    void setTarget(uint32_t agent, float tx, float tz) {
+        targetX[agent] = tx;
+        targetZ[agent] = tz;
+    }
+    size_t size() const { return x.size(); }
+
+    void step(float dt, JobSystem* jobs = nullptr);
+    void step(float dt, JobSystem* jobs, SimdLevel level);
+
+    size_t neighbourLinks = 0; // neighbour list entries filled by the last step
+
+private:
+    void gatherNeighbours(size_t begin, size_t end);
+    void steerRows(float dt, size_t begin, size_t end, SimdLevel level);
+
+    SpatialHash grid;
+    float gridCell = 0.0f;
+
+    // Per step, in the hash's sorted slot order. Neighbour lists are stored
+    // as kMaxNeighbours planes of n slots (plane k holds every agent's k-th
+    // neighbour) so 8 consecutive agents load one vector of indices; short
+    // lists are padded with the agent's own slot.
+    std::vector<float> sx, sz, svx, svz, stx, stz, sr, sms;
+    std::vector<uint32_t> neighbours;
+    std::vector<uint32_t> linkCounts;
+    std::vector<float> outX, outZ, outVx, outVz;
+};
+
+#endif
@@ -0,0 +1,112 @@
+// Generated by scripts/fontatlas.cpp from DejaVuSansMono.ttf at 12 px; do not edit.
+#ifndef DEBUGFONT_HPP
+#define DEBUGFONT_HPP
+
+# include <cstdint>
+
+// Glyph atlas for ' '..'~' in 7x15 cells, 16 per row, then a solid
+// cell; one bit per pixel, rows top to bottom, most significant bit left.
+namespace DebugFont {
+static constexpr int kCellWidth = 7;
+static constexpr int kCellHeight = 15;
+static constexpr int kColumns = 16;
+static constexpr int kFirst = 32;
+static constexpr int kLast = 126;
+static constexpr int kSolid = 95; // glyph index of the solid cell
+static constexpr int kWidth = 112;
+static constexpr int kHeight = 90;
+static const uint8_t kBits[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x20, 0xa0, 0x01, 0x0c, 0x07, 0x08, 0x08, 0x20, 0x40, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x20, 0xa0, 0xa3, 0x92, 0x08, 0x08, 0x08, 0x21, 0x50, 0x00, 0x00, 0x00, 0x02,
+    0x00, 0x20, 0xa1, 0x25, 0x52, 0x08, 0x08, 0x10, 0x10, 0xe0, 0x80, 0x00, 0x00, 0x02,
+    0x00, 0x20, 0x03, 0xf5, 0x0c, 0x8c, 0x00, 0x10, 0x10, 0xe0, 0x80, 0x00, 0x00, 0x04,
+    0x00, 0x20, 0x01, 0x47, 0x03, 0x0c, 0x00, 0x10, 0x11, 0x50, 0x80, 0x00, 0x00, 0x04,
+    0x00, 0x20, 0x01, 0x41, 0xcd, 0x92, 0x80, 0x10, 0x10, 0x47, 0xf0, 0x07, 0x00, 0x08,
+    0x00, 0x00, 0x07, 0xe1, 0x42, 0x53, 0x80, 0x10, 0x10, 0x00, 0x80, 0x00, 0x00, 0x08,
+    0x00, 0x20, 0x02, 0x45, 0x42, 0x59, 0x00, 0x08, 0x20, 0x00, 0x81, 0x00, 0x04, 0x10,
+    0x00, 0x20, 0x02, 0x83, 0x81, 0x8e, 0x80, 0x08, 0x20, 0x00, 0x81, 0x00, 0x04, 0x10,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0c, 0x60, 0x00, 0x02, 0x00, 0x00, 0x20,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3c, 0xe0, 0xf1, 0xe0, 0xcf, 0x87, 0x3f, 0x3c, 0x78, 0x00, 0x00, 0x00, 0x00, 0x0e,
+    0x24, 0x21, 0x0a, 0x10, 0xc8, 0x08, 0x83, 0x42, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x11,
+    0x42, 0x20, 0x08, 0x11, 0x48, 0x10, 0x02, 0x42, 0x84, 0x00, 0x00, 0x20, 0x10, 0x01,
+    0x42, 0x20, 0x08, 0x13, 0x4f, 0x97, 0x02, 0x42, 0x84, 0x40, 0x81, 0xc0, 0x0e, 0x06,
+    0x4a, 0x20, 0x10, 0xe2, 0x40, 0xd9, 0x84, 0x3c, 0x8c, 0x40, 0x86, 0x0f, 0xc1, 0x8c,
+    0x42, 0x20, 0x20, 0x14, 0x40, 0x50, 0x84, 0x42, 0x74, 0x00, 0x06, 0x00, 0x01, 0x88,
+    0x42, 0x20, 0x40, 0x17, 0xe0, 0x50, 0x88, 0x42, 0x04, 0x00, 0x01, 0xcf, 0xce, 0x00,
+    0x24, 0x20, 0x82, 0x10, 0x48, 0xc9, 0x88, 0x42, 0x88, 0x40, 0x80, 0x20, 0x10, 0x08,
+    0x3c, 0xf9, 0xf9, 0xe0, 0x47, 0x8f, 0x10, 0x3c, 0x70, 0x40, 0x80, 0x00, 0x00, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x31, 0xf0, 0xe7, 0x8f, 0xdf, 0x8e, 0x42, 0xf8, 0x72, 0x14, 0x08, 0x58, 0x9e,
+    0x1c, 0x31, 0x09, 0x14, 0x48, 0x10, 0x11, 0x42, 0x20, 0x12, 0x24, 0x0c, 0xd8, 0x92,
+    0x26, 0x31, 0x0a, 0x04, 0x28, 0x10, 0x20, 0x42, 0x20, 0x12, 0x44, 0x0c, 0xd4, 0xa1,
+    0x42, 0x49, 0x0a, 0x04, 0x28, 0x10, 0x20, 0x42, 0x20, 0x12, 0x84, 0x0b, 0x54, 0xa1,
+    0x4e, 0x49, 0xf2, 0x04, 0x2f, 0xdf, 0xa3, 0x7e, 0x20, 0x13, 0x84, 0x0b, 0x56, 0xa1,
+    0x52, 0x49, 0x0a, 0x04, 0x28, 0x10, 0x21, 0x42, 0x20, 0x12, 0x44, 0x0b, 0x52, 0xa1,
+    0x52, 0x79, 0x0a, 0x04, 0x28, 0x10, 0x21, 0x42, 0x20, 0x12, 0x64, 0x08, 0x52, 0xa1,
+    0x4e, 0x85, 0x09, 0x14, 0x48, 0x10, 0x11, 0x42, 0x21, 0x12, 0x24, 0x08, 0x51, 0x92,
+    0x60, 0x85, 0xf0, 0xe7, 0x8f, 0xd0, 0x0e, 0x42, 0xf8, 0xe2, 0x17, 0xe8, 0x51, 0x9e,
+    0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x06, 0x00, 0x00,
+    0x7c, 0x79, 0xf1, 0xef, 0xe8, 0x50, 0xc1, 0x43, 0x05, 0xf8, 0x84, 0x02, 0x0c, 0x00,
+    0x42, 0x49, 0x0a, 0x11, 0x08, 0x50, 0xc9, 0x24, 0x88, 0x18, 0x82, 0x02, 0x12, 0x00,
+    0x42, 0x85, 0x0a, 0x01, 0x08, 0x49, 0x49, 0x24, 0x50, 0x10, 0x82, 0x02, 0x21, 0x00,
+    0x42, 0x85, 0x0b, 0x01, 0x08, 0x49, 0x55, 0x18, 0x50, 0x20, 0x81, 0x02, 0x00, 0x00,
+    0x7c, 0x85, 0xf1, 0xe1, 0x08, 0x49, 0x55, 0x18, 0x20, 0x60, 0x81, 0x02, 0x00, 0x00,
+    0x40, 0x85, 0x10, 0x11, 0x08, 0x49, 0x55, 0x18, 0x20, 0x40, 0x80, 0x82, 0x00, 0x00,
+    0x40, 0x85, 0x08, 0x11, 0x08, 0x46, 0x36, 0x24, 0x20, 0x80, 0x80, 0x82, 0x00, 0x00,
+    0x40, 0x4d, 0x0a, 0x11, 0x08, 0x46, 0x22, 0x24, 0x21, 0x80, 0x80, 0x42, 0x00, 0x00,
+    0x40, 0x79, 0x01, 0xe1, 0x07, 0x86, 0x22, 0x42, 0x21, 0xf8, 0x80, 0x42, 0x00, 0x00,
+    0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x26, 0x00, 0x00,
+    0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x01, 0x00, 0x00, 0x40, 0x03, 0x00, 0x40, 0x20, 0x22, 0x07, 0x00, 0x00, 0x00,
+    0x08, 0x01, 0x00, 0x00, 0x40, 0x04, 0x00, 0x40, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x40, 0x04, 0x00, 0x40, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x71, 0xe1, 0xc3, 0xc7, 0x1f, 0x1e, 0x58, 0xe0, 0xe2, 0x21, 0x0f, 0x96, 0x1c,
+    0x00, 0x89, 0x13, 0x24, 0x4c, 0x84, 0x22, 0x64, 0x20, 0x22, 0x41, 0x0a, 0x99, 0x22,
+    0x00, 0x09, 0x12, 0x04, 0x48, 0x84, 0x22, 0x44, 0x20, 0x22, 0x81, 0x0a, 0x91, 0x22,
+    0x00, 0x79, 0x12, 0x04, 0x4f, 0x84, 0x22, 0x44, 0x20, 0x23, 0x01, 0x0a, 0x91, 0x22,
+    0x00, 0x89, 0x12, 0x04, 0x48, 0x04, 0x22, 0x44, 0x20, 0x22, 0x81, 0x0a, 0x91, 0x22,
+    0x00, 0x89, 0x13, 0x04, 0x48, 0x84, 0x22, 0x44, 0x20, 0x22, 0x41, 0x0a, 0x91, 0x22,
+    0x00, 0x79, 0xe1, 0xe3, 0xc7, 0x04, 0x1e, 0x44, 0xf8, 0x22, 0x20, 0xca, 0x91, 0x1c,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe1, 0x0e, 0x00, 0x7f,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x02, 0x00, 0x7f,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x02, 0x00, 0x7f,
+    0x78, 0x78, 0xf1, 0xc7, 0xc8, 0x91, 0x41, 0x44, 0x89, 0xf0, 0x81, 0x02, 0x00, 0x7f,
+    0x44, 0x88, 0xca, 0x21, 0x08, 0x91, 0x41, 0x28, 0x88, 0x10, 0x81, 0x02, 0x00, 0x7f,
+    0x44, 0x88, 0x82, 0x01, 0x08, 0x8a, 0x2a, 0x28, 0x50, 0x23, 0x01, 0x01, 0x9c, 0x7f,
+    0x44, 0x88, 0x81, 0xc1, 0x08, 0x8a, 0x2a, 0x10, 0x50, 0x40, 0x81, 0x02, 0x03, 0xff,
+    0x44, 0x88, 0x80, 0x21, 0x08, 0x8a, 0x36, 0x28, 0x50, 0x80, 0x81, 0x02, 0x00, 0x7f,
+    0x44, 0x88, 0x82, 0x21, 0x08, 0x84, 0x14, 0x28, 0x61, 0x00, 0x81, 0x02, 0x00, 0x7f,
+    0x78, 0x78, 0x81, 0xc1, 0xc7, 0x84, 0x14, 0x44, 0x21, 0xf0, 0x81, 0x02, 0x00, 0x7f,
+    0x40, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0xe1, 0x0e, 0x00, 0x7f,
+    0x40, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x01, 0x00, 0x00, 0x7f,
+    0x40, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x7f,
+};
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "DepthOrder.hpp"
+#include <algorithm>
+#include <cstring>
+
+void DepthOrder::sort(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order) {
+    if (valid && cooldown == 0 && repair(keys)) {
+        ++repairs;
+    } else {
+        if (cooldown > 0) {
+            --cooldown;
+        } else if (valid) {
+            cooldown = retryFrames; // the repair just failed
+        }
+        radixSort(keys);
+        ++fullSorts;
+    }
+    valid = true;
+    order.resize(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        order[i] = static_cast<uint32_t>(sorted[i]);
+    }
+}
+
+bool DepthOrder::repair(const std::vector<uint64_t>& keys) {
+    // re-key last frame's rows in last frame's order
+    if (++frame == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        frame = 1;
+    }
+    stamp.resize(keys.size(), 0);
+    size_t n = 0;
+    size_t descents = 0;
+    for (uint64_t old : sorted) {
+        uint32_t row = static_cast<uint32_t>(old);
+        if (row >= keys.size() || keys[row] == kCulled) {
+            continue;
+        }
+        uint64_t k = keys[row];
+        stamp[row] = frame;
+        descents += n > 0 && sorted[n - 1] > k;
+        sorted[n++] = k;
+    }
+    sorted.resize(n);
+    lastDescents = descents;
+    lastMoves = 0;
+    if (float(descents) > maxDisorder * float(n)) {
+        ++abandoned;
+        return false;
+    }
+
+    // insertion sort; each move shifts one key up by a slot
+    const size_t budget = movesPerKey * n;
+    size_t moves = 0;
+    uint64_t* a = sorted.data();
+    for (size_t i = 1; i < n; ++i) {
+        uint64_t k = a[i];
+        if (a[i - 1] <= k) {
+            continue;
+        }
+        size_t j = i;
+        do {
+            a[j] = a[j - 1];
+            --j;
+        } while (j > 0 && a[j - 1] > k);
+        a[j] = k;
+        moves += i - j;
+        if (moves > budget) {
+            lastMoves = moves;
+            ++abandoned;
+            return false;
+        }
+    }
+    lastMoves = moves;
+
+    // rows that just came into view are sorted apart and merged in
+    added.clear();
+    for (size_t r = 0; r < keys.size(); ++r) {
+        if (keys[r] != kCulled && stamp[r] != frame) {
+            added.push_back(keys[r]);
+        }
+    }
+    if (!added.empty()) {
+        std::sort(added.begin(), added.end());
+        scratch.resize(n + added.size());
+        std::merge(sorted.begin(), sorted.end(), added.begin(), added.end(), scratch.begin());
+        sorted.swap(scratch);
+    }
+    return true;
+}
+
+void DepthOrder::radixSort(const std::vector<uint64_t>& keys) {
+    // Visible keys in row order; rows only break ties of the high half,
+    // so a stable sort on those 32 bits alone gives full key order.
+    sorted.clear();
+    for (uint64_t k : keys) {
+        if (k != kCulled) {
+            sorted.push_back(k);
+        }
+    }
+    const size_t n = sorted.size();
+    scratch.resize(n);
+    uint64_t* src = sorted.data();
+    uint64_t* dst = scratch.data();
+    // three 11-bit digits of the high half
+    for (int shift = 32; shift < 64; shift += 11) {
+        uint32_t count[2048];
+        std::memset(count, 0, sizeof(count));
+        for (size_t i = 0; i < n; ++i) {
+            ++count[(src[i] >> shift) & 2047];
+        }
+        uint32_t sum = 0;
+        for (uint32_t& c : count) {
+            uint32_t first = sum;
+            sum += c;
+            c = first;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            dst[count[(src[i] >> shift) & 2047]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    // three passes leave the result in scratch
+    sorted.swap(scratch);
+}
@@ -0,0 +1,56 @@
+#ifndef DEPTHORDER_HPP
+#define DEPTHORDER_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// Keeps sprite rows sorted by a 64-bit key from one frame to the next.
+// Keys carry the row in their low 32 bits, so last frame's sorted keys
+// also give last frame's order. Units move little per frame, so the rows
+// are re-keyed in that order and an insertion sort repairs the few that
+// swapped places. When the sequence is too disordered for that (too many
+// descents, or the insertion sort runs past its move budget), or after
+// reset(), it falls back to a full radix sort of the keys. A failed
+// repair costs a pass over the keys, so after one the next few frames go
+// straight to the radix sort.
+class DepthOrder {
+public:
+    static constexpr uint64_t kCulled = ~0ull;
+
+    // descents per key above which the repair is skipped for a full sort
+    float maxDisorder = 0.25f;
+    // element moves per key the insertion sort may spend before giving up
+    size_t movesPerKey = 2;
+    // frames to sort from scratch after a failed repair
+    uint32_t retryFrames = 8;
+
+    // paths taken, for tuning and the benchmark
+    size_t repairs = 0;     // insertion sort finished the job
+    size_t fullSorts = 0;   // radix sort, from reset or disorder
+    size_t abandoned = 0;   // repairs given up on, too disordered or out of budget
+    size_t lastDescents = 0;
+    size_t lastMoves = 0;
+
+    // `keys` has one entry per row, kCulled for rows not drawn. Writes the
+    // other rows to `order` in ascending key order.
+    void sort(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order);
+    // Forgets the previous order, e.g. when rows were added or removed.
+    void reset() { sorted.clear(); valid = false; cooldown = 0; }
+
+    // The fallback, also used on its own by the benchmark.
+    void radixSort(const std::vector<uint64_t>& keys);
+
+private:
+    bool repair(const std::vector<uint64_t>& keys);
+
+    std::vector<uint64_t> sorted;  // visible keys in order
+    std::vector<uint64_t> scratch;
+    std::vector<uint64_t> added;   // rows visible this frame but not last
+    std::vector<uint32_t> stamp;   // per row: frame it was last re-keyed
+    uint32_t frame = 0;
+    uint32_t cooldown = 0;
+    bool valid = false;
+};
+
+#endif
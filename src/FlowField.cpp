@@ -0,0 +1,403 @@
+#include "FlowField.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+static const int kDx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int kDy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const float kDiag = 0.70710678f;
+static const glm::vec2 kDirVec[9] = {
+    {1, 0}, {kDiag, kDiag}, {0, 1}, {-kDiag, kDiag},
+    {-1, 0}, {-kDiag, -kDiag}, {0, -1}, {kDiag, -kDiag}, {0, 0},
+};
+
+// Edge costs are at most 254, so every value waiting in the bucket queue
+// lies within 256 of the one being settled: a ring of 256 buckets suffices.
+static constexpr uint32_t kBuckets = 256;
+
+void FlowField::build(const NavGrid& grid, uint32_t goal) {
+    nav = &grid;
+    width = grid.width();
+    height = grid.height();
+    sectorsX = (width + kSector - 1) / kSector;
+    int sectorsY = (height + kSector - 1) / kSector;
+    goalTile = goal;
+
+    const size_t n = size_t(width) * height;
+    integration.assign(n, kUnreachable);
+    directions.resize(n);
+    sectorReady.assign(size_t(sectorsX) * sectorsY, 0);
+
+    integration[goal] = 0;
+    seeds.clear();
+    seeds.push_back({0, goal});
+    propagate(false);
+}
+
+size_t FlowField::propagate(bool markTouched) {
+    // Dial's algorithm: Dijkstra with a bucket queue over integer costs.
+    // Seeds (sorted by value) join the ring when the sweep reaches them and
+    // empty stretches between seeds are skipped.
+    const NavGrid& grid = *nav;
+    buckets.resize(kBuckets);
+    std::sort(seeds.begin(), seeds.end());
+    size_t next = 0, pending = 0, touched = 0;
+    uint32_t value = seeds.empty() ? 0 : seeds[0].first;
+    while (next < seeds.size() || pending > 0) {
+        if (pending == 0 && seeds[next].first > value) {
+            value = seeds[next].first;
+        }
+        std::vector<uint32_t>& bucket = buckets[value % kBuckets];
+        for (; next < seeds.size() && seeds[next].first == value; ++next) {
+            bucket.push_back(seeds[next].second);
+            ++pending;
+        }
+        // relaxations only push into later buckets, never this one
+        for (size_t k = 0; k < bucket.size(); ++k) {
+            uint32_t t = bucket[k];
+            if (integration[t] != value) {
+                continue; // stale entry
+            }
+            int x = int(t % uint32_t(width)), y = int(t / uint32_t(width));
+            for (int d = 0; d < 8; d += 2) {
+                int nx = x + kDx[d], ny = y + kDy[d];
+                if (!grid.walkable(nx, ny)) {
+                    continue;
+                }
+                uint32_t nt = grid.index(nx, ny);
+                uint32_t nv = value + grid.cost(nt);
+                if (nv < integration[nt]) {
+                    integration[nt] = nv;
+                    buckets[nv % kBuckets].push_back(nt);
+                    ++pending;
+                    if (markTouched) {
+                        markSectors(nt);
+                        ++touched;
+                    }
+                }
+            }
+        }
+        pending -= bucket.size();
+        bucket.clear();
+        ++value;
+    }
+    return touched;
+}
+
+void FlowField::markSectors(uint32_t tile) {
+    // a tile's change affects its own and its neighbours' directions; the
+    // sectors of the 3x3 block are the sectors of its corners
+    int x = int(tile % uint32_t(width)), y = int(tile / uint32_t(width));
+    int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, width - 1);
+    int y0 = std::max(y - 1, 0), y1 = std::min(y + 1, height - 1);
+    sectorReady[(y0 / kSector) * sectorsX + x0 / kSector] = 0;
+    sectorReady[(y0 / kSector) * sectorsX + x1 / kSector] = 0;
+    sectorReady[(y1 / kSector) * sectorsX + x0 / kSector] = 0;
+    sectorReady[(y1 / kSector) * sectorsX + x1 / kSector] = 0;
+}
+
+void FlowField::repair(const uint32_t* tiles, size_t count) {
+    tilesRepaired = 0;
+    if (count == 0) {
+        return;
+    }
+    if (count > integration.size() / 32) {
+        // large edit: a full rebuild is cheaper than tracking dependencies
+        build(*nav, goalTile);
+        tilesRepaired = integration.size();
+        ++fullRebuilds;
+        return;
+    }
+    const NavGrid& grid = *nav;
+
+    // 1. Invalidate every tile whose distance can no longer be derived
+    //    without an edited tile. Tiles go by old value, so when one is
+    //    looked at every possible parent (all at value - cost) has been
+    //    settled; it stays if any of them is still valid.
+    invalid.clear();
+    stack.clear();
+    auto byValue = std::greater<std::pair<uint32_t, uint32_t>>();
+    auto invalidate = [&](uint32_t t) {
+        const uint32_t oldValue = integration[t];
+        integration[t] = kUnreachable;
+        invalid.push_back(t);
+        int x = int(t % uint32_t(width)), y = int(t / uint32_t(width));
+        for (int d = 0; d < 8; d += 2) {
+            int nx = x + kDx[d], ny = y + kDy[d];
+            if (!grid.inside(nx, ny)) {
+                continue;
+            }
+            uint32_t nt = grid.index(nx, ny);
+            uint32_t v = integration[nt];
+            if (nt != goalTile && v != kUnreachable && v == oldValue + grid.cost(nt)) {
+                stack.push_back({v, nt});
+                std::push_heap(stack.begin(), stack.end(), byValue);
+            }
+        }
+    };
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t t = tiles[i];
+        if (t != goalTile && integration[t] != kUnreachable) {
+            invalidate(t);
+        }
+    }
+    while (!stack.empty()) {
+        std::pop_heap(stack.begin(), stack.end(), byValue);
+        auto [value, t] = stack.back();
+        stack.pop_back();
+        if (integration[t] != value) {
+            continue; // already invalidated through another parent
+        }
+        const uint32_t parentValue = value - grid.cost(t);
+        int x = int(t % uint32_t(width)), y = int(t / uint32_t(width));
+        bool supported = false;
+        for (int d = 0; d < 8 && !supported; d += 2) {
+            int nx = x + kDx[d], ny = y + kDy[d];
+            supported = grid.inside(nx, ny) && integration[grid.index(nx, ny)] == parentValue;
+        }
+        if (!supported) {
+            invalidate(t);
+        }
+    }
+
+    if (invalid.size() > integration.size() / 4) {
+        build(grid, goalTile);
+        tilesRepaired = integration.size();
+        ++fullRebuilds;
+        return;
+    }
+
+    // 2. Seed the invalidated region and the edited tiles from their still
+    //    valid neighbours.
+    seeds.clear();
+    auto seed = [&](uint32_t t) {
+        if (t == goalTile || grid.cost(t) == NavGrid::kBlocked) {
+            return;
+        }
+        int x = int(t % uint32_t(width)), y = int(t / uint32_t(width));
+        uint32_t best = integration[t];
+        for (int d = 0; d < 8; d += 2) {
+            int nx = x + kDx[d], ny = y + kDy[d];
+            if (grid.inside(nx, ny)) {
+                uint32_t v = integration[grid.index(nx, ny)];
+                if (v != kUnreachable && v + grid.cost(t) < best) {
+                    best = v + grid.cost(t);
+                }
+            }
+        }
+        if (best < integration[t]) {
+            integration[t] = best;
+            seeds.push_back({best, t});
+        }
+    };
+    for (uint32_t t : invalid) {
+        seed(t);
+        markSectors(t);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        seed(tiles[i]);
+        markSectors(tiles[i]);
+    }
+
+    // 3. Sweep from the seeds; improvements may spread past the region.
+    tilesRepaired = invalid.size() + propagate(true);
+}
+
+void FlowField::fillSector(uint32_t sector) {
+    const NavGrid& grid = *nav;
+    int sx = int(sector % uint32_t(sectorsX)) * kSector;
+    int sy = int(sector / uint32_t(sectorsX)) * kSector;
+    int ex = std::min(sx + kSector, width), ey = std::min(sy + kSector, height);
+    for (int y = sy; y < ey; ++y) {
+        for (int x = sx; x < ex; ++x) {
+            uint32_t t = grid.index(x, y);
+            uint32_t best = integration[t];
+            uint8_t dir = kNoDirection;
+            if (best != kUnreachable && t != goalTile) {
+                for (int d = 0; d < 8; ++d) {
+                    int nx = x + kDx[d], ny = y + kDy[d];
+                    if (!grid.walkable(nx, ny)) {
+                        continue;
+                    }
+                    // no corner cutting past a blocked tile
+                    if ((d & 1) && (!grid.walkable(x + kDx[d], y) || !grid.walkable(x, y + kDy[d]))) {
+                        continue;
+                    }
+                    uint32_t v = integration[grid.index(nx, ny)];
+                    if (v < best) {
+                        best = v;
+                        dir = static_cast<uint8_t>(d);
+                    }
+                }
+            }
+            directions[t] = dir;
+        }
+    }
+    sectorReady[sector] = 1;
+}
+
+glm::vec2 FlowField::directionAt(float x, float z) {
+    return kDirVec[direction(nav->tileAt(x, z))];
+}
+
+void FlowField::prepareAll() {
+    for (uint32_t s = 0; s < sectorReady.size(); ++s) {
+        if (!sectorReady[s]) {
+            fillSector(s);
+        }
+    }
+}
+
+static uint32_t sectorKey(const NavGrid& nav, uint32_t tile) {
+    uint32_t x = tile % uint32_t(nav.width()), y = tile / uint32_t(nav.width());
+    uint32_t sectorsX = uint32_t(nav.width() + FlowField::kSector - 1) / FlowField::kSector;
+    return (y / FlowField::kSector) * sectorsX + x / FlowField::kSector;
+}
+
+size_t FlowFieldCache::acquire(const NavGrid& nav, uint32_t goal) {
+    sync(nav);
+    ++useClock;
+    const uint32_t sector = sectorKey(nav, goal);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].sector == sector) {
+            entries[i].lastUse = useClock;
+            ++hits;
+            return i;
+        }
+    }
+    size_t i = entries.size();
+    if (entries.size() < capacity) {
+        entries.push_back(Entry());
+        entries.back().field.reset(new FlowField());
+    } else {
+        i = size_t(std::min_element(entries.begin(), entries.end(),
+                                    [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; }) -
+                   entries.begin());
+    }
+    Entry& e = entries[i];
+    e.field->build(nav, goal);
+    e.sector = sector;
+    e.lastUse = useClock;
+    e.generation = ++generations;
+    ++builds;
+    return i;
+}
+
+FlowField& FlowFieldCache::get(const NavGrid& nav, uint32_t goal) {
+    return *entries[acquire(nav, goal)].field;
+}
+
+FlowRoute FlowFieldCache::route(const NavGrid& nav, uint32_t goal) {
+    FlowRoute r;
+    r.cache = this;
+    r.slot = acquire(nav, goal);
+    r.generation = entries[r.slot].generation;
+    r.buildApproach(nav, goal);
+    return r;
+}
+
+bool FlowRoute::valid() const {
+    return cache && cache->entries[slot].generation == generation;
+}
+
+FlowField& FlowRoute::field() const {
+    return *cache->entries[slot].field;
+}
+
+void FlowRoute::buildApproach(const NavGrid& grid, uint32_t goal) {
+    nav = &grid;
+    goalTile = goal;
+    const int k = FlowField::kSector;
+    int gx = int(goal % uint32_t(grid.width())), gy = int(goal / uint32_t(grid.width()));
+    x0 = std::max(gx / k * k - kApproach, 0);
+    y0 = std::max(gy / k * k - kApproach, 0);
+    w = std::min(gx / k * k + k + kApproach, grid.width()) - x0;
+    h = std::min(gy / k * k + k + kApproach, grid.height()) - y0;
+    approach.assign(size_t(w) * h, FlowField::kUnreachable);
+
+    // a few thousand tiles at most: a plain heap will do
+    using Item = std::pair<uint32_t, uint32_t>; // (value, local tile)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    uint32_t start = uint32_t(gy - y0) * uint32_t(w) + uint32_t(gx - x0);
+    approach[start] = 0;
+    open.push({0, start});
+    while (!open.empty()) {
+        auto [value, t] = open.top();
+        open.pop();
+        if (approach[t] != value) {
+            continue;
+        }
+        int x = int(t % uint32_t(w)), y = int(t / uint32_t(w));
+        for (int d = 0; d < 8; d += 2) {
+            int nx = x + kDx[d], ny = y + kDy[d];
+            if (nx < 0 || ny < 0 || nx >= w || ny >= h || !grid.walkable(x0 + nx, y0 + ny)) {
+                continue;
+            }
+            uint32_t nt = uint32_t(ny) * uint32_t(w) + uint32_t(nx);
+            uint32_t nv = value + grid.cost(x0 + nx, y0 + ny);
+            if (nv < approach[nt]) {
+                approach[nt] = nv;
+                open.push({nv, nt});
+            }
+        }
+    }
+}
+
+uint8_t FlowRoute::direction(uint32_t tile) {
+    if (!valid()) {
+        return FlowField::kNoDirection;
+    }
+    FlowField& shared = field();
+    int x = int(tile % uint32_t(nav->width())) - x0, y = int(tile / uint32_t(nav->width())) - y0;
+    if (x < 0 || y < 0 || x >= w || y >= h) {
+        return shared.direction(tile);
+    }
+    uint32_t best = approach[uint32_t(y) * uint32_t(w) + uint32_t(x)];
+    if (best == FlowField::kUnreachable) {
+        return shared.direction(tile);
+    }
+    // the field's rule, over the window's distances
+    uint8_t dir = FlowField::kNoDirection;
+    for (int d = 0; d < 8; ++d) {
+        int nx = x + kDx[d], ny = y + kDy[d];
+        if (nx < 0 || ny < 0 || nx >= w || ny >= h || !nav->walkable(x0 + nx, y0 + ny)) {
+            continue;
+        }
+        if ((d & 1) && (!nav->walkable(x0 + nx, y0 + y) || !nav->walkable(x0 + x, y0 + ny))) {
+            continue;
+        }
+        uint32_t v = approach[uint32_t(ny) * uint32_t(w) + uint32_t(nx)];
+        if (v < best) {
+            best = v;
+            dir = static_cast<uint8_t>(d);
+        }
+    }
+    return dir;
+}
+
+glm::vec2 FlowRoute::directionAt(float x, float z) {
+    return kDirVec[direction(nav->tileAt(x, z))];
+}
+
+void FlowFieldCache::sync(const NavGrid& nav) {
+    const uint32_t* tiles = nullptr;
+    size_t count = 0;
+    if (source == &nav && nav.changesSince(cursor, tiles, count)) {
+        if (count > 0) {
+            for (Entry& e : entries) {
+                e.field->repair(tiles, count);
+                ++repairs;
+            }
+        }
+    } else {
+        // different grid or the log was trimmed past us: start over, and
+        // let routes made for the old grid know
+        for (Entry& e : entries) {
+            e.field->build(nav, e.field->goal());
+            e.generation = ++generations;
+            ++builds;
+        }
+    }
+    source = &nav;
+    cursor = nav.changeCursor();
+}
@@ -0,0 +1,164 @@
+#ifndef FLOWFIELD_HPP
+#define FLOWFIELD_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <memory>
+# include <utility>
+# include <vector>
+# include <glm/glm.hpp>
+# include "NavGrid.hpp"
+
+// Flow field towards one goal tile: an integration field (summed tile cost
+// to the goal, 4-connected Dijkstra) and a direction field pointing each
+// tile at its cheapest of 8 neighbours. Any number of units then steer by
+// one O(1) lookup each instead of searching.
+//
+// Directions are filled lazily per kSector x kSector sector, so a field
+// only pays for the sectors units actually stand in. Because of that,
+// lookups write to the field; call prepareAll() before sampling it from
+// several threads.
+class FlowField {
+public:
+    static constexpr uint32_t kUnreachable = 0xFFFFFFFFu;
+    static constexpr int kSector = 16;
+    static constexpr uint8_t kNoDirection = 8;
+
+    void build(const NavGrid& nav, uint32_t goal);
+
+    // Brings the field up to date after `tiles` changed cost. Only tiles
+    // whose distance could depend on them are recomputed; the result is
+    // identical to a fresh build().
+    void repair(const uint32_t* tiles, size_t count);
+
+    uint32_t goal() const { return goalTile; }
+    uint32_t distance(uint32_t tile) const { return integration[tile]; }
+
+    // 0..7 = E, NE, N, NW, W, SW, S, SE (+y is +Z); kNoDirection at the goal
+    // and on tiles that cannot reach it.
+    uint8_t direction(uint32_t tile) {
+        uint32_t s = sectorOf(tile);
+        if (!sectorReady[s]) {
+            fillSector(s);
+        }
+        return directions[tile];
+    }
+
+    // Unit steering vector on the XZ plane (x, z) at a world position;
+    // zero at the goal or where the goal is unreachable.
+    glm::vec2 directionAt(float x, float z);
+
+    void prepareAll();
+
+    size_t tilesRepaired = 0; // by the last repair()
+    size_t fullRebuilds = 0;  // repairs that fell back to build()
+
+private:
+    uint32_t sectorOf(uint32_t tile) const {
+        uint32_t x = tile % uint32_t(width), y = tile / uint32_t(width);
+        return (y / kSector) * uint32_t(sectorsX) + x / kSector;
+    }
+    void fillSector(uint32_t sector);
+    void markSectors(uint32_t tile);
+    size_t propagate(bool markTouched);
+
+    const NavGrid* nav = nullptr;
+    int width = 0;
+    int height = 0;
+    int sectorsX = 0;
+    uint32_t goalTile = 0;
+    std::vector<uint32_t> integration;
+    std::vector<uint8_t> directions;
+    std::vector<uint8_t> sectorReady;
+
+    // scratch reused between builds and repairs
+    std::vector<std::vector<uint32_t>> buckets;
+    std::vector<std::pair<uint32_t, uint32_t>> stack; // (old value, tile) min-heap
+    std::vector<std::pair<uint32_t, uint32_t>> seeds; // (value, tile)
+    std::vector<uint32_t> invalid;
+};
+
+class FlowFieldCache;
+
+// Steering for units ordered to one exact goal tile. Far away they follow
+// a shared field of the goal's sector, which leads to whichever tile of
+// that sector it was built for; inside a window of kApproach tiles around
+// the goal's sector an exact Dijkstra over just that window, built with
+// the route, takes over for the last steps. Tiles of the window the goal
+// cannot be reached from without leaving it keep using the field.
+class FlowRoute {
+public:
+    static constexpr int kApproach = FlowField::kSector;
+
+    uint32_t goal() const { return goalTile; }
+    FlowField& field() const;
+
+    // False once the cache has handed the route's field to another sector
+    // or had to rebuild it from scratch (another grid, or edits it missed
+    // in a trimmed log); request the route again then.
+    bool valid() const;
+
+    // Same encoding as FlowField::direction(); kNoDirection at the goal
+    // and everywhere once the route is no longer valid().
+    uint8_t direction(uint32_t tile);
+    glm::vec2 directionAt(float x, float z);
+
+private:
+    friend class FlowFieldCache;
+    void buildApproach(const NavGrid& grid, uint32_t goal);
+
+    const FlowFieldCache* cache = nullptr;
+    size_t slot = 0;
+    uint64_t generation = 0; // of the slot when the route was made
+    const NavGrid* nav = nullptr;
+    uint32_t goalTile = 0;
+    int x0 = 0, y0 = 0, w = 0, h = 0;
+    std::vector<uint32_t> approach; // window-local distances to the goal
+};
+
+// Fields cached by goal sector, least recently used evicted: orders to
+// different tiles of one sector share a field and only differ in their
+// route's approach window. The cache follows the NavGrid edit log and
+// repairs every cached field in place.
+class FlowFieldCache {
+public:
+    explicit FlowFieldCache(size_t capacity = 16) : capacity(capacity) {}
+
+    // Field of the goal's sector, built towards `goal` on first use and
+    // reused for every later goal in that sector, so its goal() may be a
+    // different tile. The reference stays valid until it is evicted.
+    FlowField& get(const NavGrid& nav, uint32_t goal);
+
+    // Route to the exact tile `goal` over the sector's field, valid() until
+    // that field is evicted. Call again after grid edits, which repair the
+    // shared field but not the route's own approach window.
+    FlowRoute route(const NavGrid& nav, uint32_t goal);
+
+    // Applies grid edits made since the last sync to every cached field.
+    void sync(const NavGrid& nav);
+
+    size_t builds = 0;
+    size_t repairs = 0;
+    size_t hits = 0;
+
+private:
+    friend class FlowRoute;
+
+    struct Entry {
+        std::unique_ptr<FlowField> field;
+        uint32_t sector = 0;
+        uint64_t lastUse = 0;
+        uint64_t generation = 0; // new whenever the field changes sector
+    };
+
+    size_t acquire(const NavGrid& nav, uint32_t goal);
+
+    size_t capacity;
+    std::vector<Entry> entries;
+    const NavGrid* source = nullptr;
+    uint64_t cursor = 0;
+    uint64_t useClock = 0;
+    uint64_t generations = 0;
+};
+
+#endif
@@ -0,0 +1,202 @@
+#include "FogOfWar.hpp"
+#include <algorithm>
+#include <cmath>
+
+void FogOfWar::create(int width, int height, float tileSize, float x0, float z0, int playerCount) {
+    w = width;
+    h = height;
+    wordsPerRow = (size_t(w) + 63) / 64;
+    blocksX = (w + kBlock - 1) / kBlock;
+    blocksY = (h + kBlock - 1) / kBlock;
+    invSize = 1.0f / tileSize;
+    originX = x0;
+    originZ = z0;
+    players.assign(size_t(playerCount), Player());
+    for (Player& p : players) {
+        p.visible.assign(wordsPerRow * h, 0);
+        p.explored.assign(wordsPerRow * h, 0);
+        p.refs.assign(size_t(w) * h, 0);
+        // the first upload covers everything
+        p.dirtyBlocks.assign(size_t(blocksX) * blocksY, 1);
+    }
+    viewers.clear();
+    freeViewers.clear();
+}
+
+int FogOfWar::tileX(float x) const {
+    return std::clamp(int(std::floor((x - originX) * invSize)), 0, w - 1);
+}
+
+int FogOfWar::tileY(float z) const {
+    return std::clamp(int(std::floor((z - originZ) * invSize)), 0, h - 1);
+}
+
+uint16_t FogOfWar::stampFor(float sightRadius) {
+    int radius = std::max(0, int(sightRadius * invSize + 0.5f));
+    for (size_t i = 0; i < stamps.size(); ++i) {
+        if (stamps[i].radius == radius) {
+            return uint16_t(i);
+        }
+    }
+    // tiles whose centre lies within radius + 0.5 of the viewer's tile
+    // centre; the extra half tile rounds off the flat sides of the disc
+    Stamp s;
+    s.radius = radius;
+    float r = float(radius) + 0.5f;
+    for (int dy = -radius; dy <= radius; ++dy) {
+        s.halfWidth.push_back(int16_t(std::sqrt(r * r - float(dy * dy))));
+    }
+    stamps.push_back(std::move(s));
+    return uint16_t(stamps.size() - 1);
+}
+
+void FogOfWar::applySpan(Player& p, int y, int x0, int x1, bool add) {
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, w - 1);
+    if (y < 0 || y >= h || x0 > x1) {
+        return;
+    }
+    uint16_t* refs = p.refs.data() + size_t(y) * w;
+    uint64_t* vis = p.visible.data() + size_t(y) * wordsPerRow;
+    uint64_t* seen = p.explored.data() + size_t(y) * wordsPerRow;
+    uint8_t* dirty = p.dirtyBlocks.data() + size_t(y / kBlock) * blocksX;
+    for (int x = x0; x <= x1; ++x) {
+        // only 0 <-> 1 transitions change what the player sees
+        uint64_t bit = uint64_t(1) << (x & 63);
+        if (add) {
+            if (refs[x]++ == 0) {
+                vis[x >> 6] |= bit;
+                seen[x >> 6] |= bit;
+                dirty[x / kBlock] = 1;
+            }
+        } else if (--refs[x] == 0) {
+            vis[x >> 6] &= ~bit;
+            dirty[x / kBlock] = 1;
+        }
+    }
+    tilesStamped += size_t(x1 - x0 + 1);
+}
+
+void FogOfWar::apply(Player& p, const Stamp& s, int cx, int cy, bool add) {
+    for (int dy = -s.radius; dy <= s.radius; ++dy) {
+        int half = s.halfWidth[size_t(dy + s.radius)];
+        applySpan(p, cy + dy, cx - half, cx + half, add);
+    }
+}
+
+void FogOfWar::move(Player& p, const Stamp& s, int ox, int oy, int nx, int ny) {
+    // Row by row, add the part of the new span outside the old one and
+    // remove the part of the old span outside the new one. A one-tile step
+    // touches a couple of tiles per row instead of two whole discs.
+    for (int y = std::min(oy, ny) - s.radius; y <= std::max(oy, ny) + s.radius; ++y) {
+        int a0 = 0, a1 = -1, b0 = 0, b1 = -1;
+        if (std::abs(y - oy) <= s.radius) {
+            int half = s.halfWidth[size_t(y - oy + s.radius)];
+            a0 = ox - half;
+            a1 = ox + half;
+        }
+        if (std::abs(y - ny) <= s.radius) {
+            int half = s.halfWidth[size_t(y - ny + s.radius)];
+            b0 = nx - half;
+            b1 = nx + half;
+        }
+        if (a0 > a1 || b0 > b1 || a1 < b0 || b1 < a0) {
+            // disjoint (or one side empty)
+            applySpan(p, y, b0, b1, true);
+            applySpan(p, y, a0, a1, false);
+            continue;
+        }
+        applySpan(p, y, b0, a0 - 1, true);
+        applySpan(p, y, a1 + 1, b1, true);
+        applySpan(p, y, a0, b0 - 1, false);
+        applySpan(p, y, b1 + 1, a1, false);
+    }
+}
+
+uint32_t FogOfWar::addViewer(int player, float x, float z, float sightRadius) {
+    Viewer v;
+    v.player = int16_t(player);
+    v.stamp = stampFor(sightRadius);
+    v.tx = tileX(x);
+    v.ty = tileY(z);
+    apply(players[player], stamps[v.stamp], v.tx, v.ty, true);
+
+    uint32_t id;
+    if (!freeViewers.empty()) {
+        id = freeViewers.back();
+        freeViewers.pop_back();
+        viewers[id] = v;
+    } else {
+        id = uint32_t(viewers.size());
+        viewers.push_back(v);
+    }
+    return id;
+}
+
+void FogOfWar::moveViewer(uint32_t viewer, float x, float z) {
+    Viewer& v = viewers[viewer];
+    int tx = tileX(x), ty = tileY(z);
+    if (v.player < 0 || (tx == v.tx && ty == v.ty)) {
+        return;
+    }
+    move(players[v.player], stamps[v.stamp], v.tx, v.ty, tx, ty);
+    v.tx = tx;
+    v.ty = ty;
+    ++viewersRestamped;
+}
+
+void FogOfWar::removeViewer(uint32_t viewer) {
+    Viewer& v = viewers[viewer];
+    if (v.player < 0) {
+        return;
+    }
+    apply(players[v.player], stamps[v.stamp], v.tx, v.ty, false);
+    v.player = -1;
+    freeViewers.push_back(viewer);
+}
+
+void FogOfWar::takeDirtyRects(int player, std::vector<FogRect>& out) {
+    Player& p = players[player];
+    // Runs of dirty blocks per block row; a run spanning the same columns
+    // as a rect that ended on the row above extends that rect instead.
+    openRects.clear();
+    for (int by = 0; by < blocksY; ++by) {
+        nextRects.clear();
+        uint8_t* dirty = p.dirtyBlocks.data() + size_t(by) * blocksX;
+        for (int bx = 0; bx < blocksX;) {
+            if (!dirty[bx]) {
+                ++bx;
+                continue;
+            }
+            int run = bx;
+            while (run < blocksX && dirty[run]) {
+                dirty[run++] = 0;
+            }
+            FogRect r = {bx * kBlock, by * kBlock, std::min(run * kBlock, w), std::min((by + 1) * kBlock, h)};
+            size_t index = out.size();
+            for (size_t i : openRects) {
+                if (out[i].x0 == r.x0 && out[i].x1 == r.x1) {
+                    index = i;
+                    break;
+                }
+            }
+            if (index == out.size()) {
+                out.push_back(r);
+            } else {
+                out[index].y1 = r.y1;
+            }
+            nextRects.push_back(index);
+            bx = run;
+        }
+        openRects.swap(nextRects);
+    }
+}
+
+void FogOfWar::writeTexels(int player, const FogRect& r, uint8_t* out) const {
+    const Player& p = players[player];
+    for (int y = r.y0; y < r.y1; ++y) {
+        for (int x = r.x0; x < r.x1; ++x) {
+            *out++ = testBit(p.visible, x, y) ? kVisible : testBit(p.explored, x, y) ? kExplored : kHidden;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef FOGOFWAR_HPP
+#define FOGOFWAR_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// Half-open tile rectangle [x0, x1) x [y0, y1).
+struct FogRect {
+    int x0, y0, x1, y1;
+};
+
+// Per-player tile visibility over the XZ plane. Each player keeps packed
+// visible/explored bitsets plus a count of how many of its viewers see
+// each tile. A viewer that crosses into another tile only adds the tiles
+// its new sight stamp covers beyond the old one and releases the ones it
+// left; nothing is recomputed from scratch. Viewers that stay inside
+// their tile cost nothing.
+//
+// Sight shapes are precomputed as a half-width per row ("stamps") and
+// shared by every viewer with the same radius in tiles. Tiles whose state
+// flipped mark their kBlock x kBlock block dirty, and takeDirtyRects()
+// merges those into the few rectangles a texture upload has to cover.
+class FogOfWar {
+public:
+    static constexpr int kBlock = 16;
+    // Texel values written by writeTexels().
+    static constexpr uint8_t kHidden = 0;
+    static constexpr uint8_t kExplored = 128;
+    static constexpr uint8_t kVisible = 255;
+
+    void create(int width, int height, float tileSize, float originX, float originZ, int playerCount);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    uint32_t addViewer(int player, float x, float z, float sightRadius);
+    // Restamps only when the viewer crossed into another tile.
+    void moveViewer(uint32_t viewer, float x, float z);
+    void removeViewer(uint32_t viewer);
+
+    bool visible(int player, int x, int y) const { return testBit(players[player].visible, x, y); }
+    bool explored(int player, int x, int y) const { return testBit(players[player].explored, x, y); }
+
+    // Appends the rectangles changed since the last call for `player` and
+    // clears them. Rects never overlap.
+    void takeDirtyRects(int player, std::vector<FogRect>& out);
+    // kVisible / kExplored / kHidden per tile of `r`, rows tightly packed.
+    void writeTexels(int player, const FogRect& r, uint8_t* out) const;
+
+    size_t viewersRestamped = 0; // cumulative; reset by the caller
+    size_t tilesStamped = 0;
+
+private:
+    struct Stamp {
+        int radius = 0;
+        std::vector<int16_t> halfWidth; // per row dy + radius
+    };
+    struct Player {
+        std::vector<uint64_t> visible, explored;
+        std::vector<uint16_t> refs;
+        std::vector<uint8_t> dirtyBlocks;
+    };
+    struct Viewer {
+        int16_t player = -1; // -1 once removed
+        uint16_t stamp = 0;
+        int tx = 0, ty = 0;
+    };
+
+    bool testBit(const std::vector<uint64_t>& bits, int x, int y) const {
+        return (bits[size_t(y) * wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+    }
+    int tileX(float x) const;
+    int tileY(float z) const;
+    uint16_t stampFor(float sightRadius);
+    void applySpan(Player& p, int y, int x0, int x1, bool add);
+    void apply(Player& p, const Stamp& s, int cx, int cy, bool add);
+    void move(Player& p, const Stamp& s, int ox, int oy, int nx, int ny);
+
+    int w = 0;
+    int h = 0;
+    size_t wordsPerRow = 0;
+    int blocksX = 0;
+    int blocksY = 0;
+    float invSize = 1.0f;
+    float originX = 0.0f;
+    float originZ = 0.0f;
+
+    std::vector<Player> players;
+    std::vector<Stamp> stamps;
+    std::vector<Viewer> viewers;
+    std::vector<uint32_t> freeViewers;
+    std::vector<size_t> openRects, nextRects; // takeDirtyRects scratch
+};
+
+#endif
@@ -1,9 +1,13 @@
 #include "Game.hpp"
+#include "Systems.hpp"
 #include <iostream>
 #include "thirdparty/glad/include/glad/glad.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #define STB_IMAGE_IMPLEMENTATION
@@ -11,6 +15,28 @@
 #include <fstream>
 #include <sstream>
 
+// world layout shared by live sessions and their replays
+static const int kIdleUnits = 8;
+static const uint32_t kWorldSeed = 1;
+// world units a player's unit reveals around itself
+static const float kSightRadius = 2.5f;
+// texels per side of the shadow layer over the whole terrain
+static const int kShadowLayerSize = 256;
+// frames of particle instances the streaming ring holds before it wraps
+static const int kParticleRingFrames = 3;
+// chance per second that a walking unit kicks up a dust puff
+static const float kDustPerSecond = 12.0f;
+// screen pixels per light buffer pixel, and light buffer pixels per tile
+static const int kLightScale = 4;
+static const int kLightTile = 16;
+// torches scattered over the terrain at start
+static const int kTorches = 48;
+// minimap target pixels per side, and terrain image pixels per cell
+static const int kMinimapSize = 192;
+static const int kMinimapCellPixels = 4;
+// unit dot diameter as a fraction of the minimap
+static const float kMinimapDot = 0.035f;
+
 static std::string loadFile(const std::string& path) {
     std::ifstream file(path);
     std::stringstream buf;
@@ -18,9 +44,9 @@ static std::string loadFile(const std::string& path) {
     return buf.str();
 }
 
-void Game::loadShaders() {
-    std::string vertSrc = loadFile("src/shaders/floor.vert");
-    std::string fragSrc = loadFile("src/shaders/floor.frag");
+static GLuint compileProgram(const char* vertPath, const char* fragPath) {
+    std::string vertSrc = loadFile(vertPath);
+    std::string fragSrc = loadFile(fragPath);
 
     GLuint v = glCreateShader(GL_VERTEX_SHADER);
     const char* vsrc = vertSrc.c_str();
@@ -32,13 +58,24 @@ void Game::loadShaders() {
     glShaderSource(f, 1, &fsrc, nullptr);
     glCompileShader(f);
 
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, v);
-    glAttachShader(shaderProgram, f);
-    glLinkProgram(shaderProgram);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, v);
+    glAttachShader(program, f);
+    glLinkProgram(program);
 
     glDeleteShader(v);
     glDeleteShader(f);
+    return program;
+}
+
+void Game::loadShaders() {
+    shaderProgram = compileProgram("src/shaders/floor.vert", "src/shaders/floor.frag");
+    spriteProgram = compileProgram("src/shaders/sprite.vert", "src/shaders/sprite.frag");
+    shadowProgram = compileProgram("src/shaders/shadow.vert", "src/shaders/shadow.frag");
+    particleProgram = compileProgram("src/shaders/particle.vert", "src/shaders/particle.frag");
+    lightProgram = compileProgram("src/shaders/light.vert", "src/shaders/light.frag");
+    overlayProgram = compileProgram("src/shaders/overlay.vert", "src/shaders/overlay.frag");
+    minimapProgram = compileProgram("src/shaders/minimap.vert", "src/shaders/minimap.frag");
 }
 
 bool Game::init(const std::string& title, int width, int height) {
@@ -127,68 +164,107 @@ bool Game::init(const std::string& title, int width, int height) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // animation clips are data; without them the built-in ones are used
+    if (!sim.clips.load("assets/Characters/Sheet2.anim")) {
+        std::cerr << "Failed to load animation clips: " << sim.clips.error << "\n";
+    }
+
+    // one local player and a ring of idle units to bump into
+    sim.init(1, kIdleUnits, kWorldSeed);
+
     loadShaders();
     createFloorMesh();
     loadFloorTexture();
-
-    player.loadTexture("assets/Characters/Sheet2.png");
-    player.initMesh();
-    player.setFloorHeight(0.0f);  // Floor is at Y = 0
-    player.setAnimation(4, 7, 4, 0.1f); // 4 columns x 7 rows, 4 frames per row
-
-    // Load shadow PNG
-    {
-        int w, h, n;
-        unsigned char* data = stbi_load("assets/Characters/shadow.png", &w, &h, &n, 4);
-        if (!data) {
-            std::cerr << "Failed to load shadow texture: assets/Characters/shadow.png\n";
-            return false;
-        }
-
-        glGenTextures(1, &shadowTexture);
-        glBindTexture(GL_TEXTURE_2D, shadowTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        stbi_image_free(data);
-    }
+    createFog();
+
+    SpriteSheet playerSheet;
+    playerSheet.cols = 4;   // 4 columns x 7 rows
+    playerSheet.rows = 7;
+    picker.masks.emplace_back();
+    playerSheet.loadTexture("assets/Characters/Sheet2.png", &picker.masks.back());
+    playerSheet.initMesh();
+    sheets.push_back(playerSheet);
+    createSpriteBuffers();
+
+    createShadowPass();
+    createParticles();
+    createLights();
+    createOverlay();
+    createMinimap();
 
     running = true;
     return true;
 }
 
 void Game::createFloorMesh() {
-    float verts[] = {
-        // x,y,z    u,v
-        -5,0,-5,   0,0,
-         5,0,-5,   1,0,
-         5,0, 5,   1,1,
-        -5,0, 5,   0,1
-    };
-
-    unsigned int idx[] = { 0,1,2,  2,3,0 };
+    // One mesh per terrain tile; vertices displaced by a batched height query
+    const int n = Heightfield::kTile;
+    const int side = n + 1;
+    const float sizeX = sim.terrain.maxX() - sim.terrain.minX();
+    const float sizeZ = sim.terrain.maxZ() - sim.terrain.minZ();
+
+    std::vector<unsigned int> idx;
+    idx.reserve(n * n * 6);
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            unsigned int i0 = z * side + x;
+            unsigned int i1 = i0 + 1;
+            unsigned int i2 = i0 + side + 1;
+            unsigned int i3 = i0 + side;
+            idx.insert(idx.end(), { i0, i1, i2,  i2, i3, i0 });
+        }
+    }
+    floorIndexCount = static_cast<int>(idx.size());
 
-    GLuint vbo, ebo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
+    GLuint ebo;
     glGenBuffers(1, &ebo);
+    floorBuffers.push_back(ebo);
+
+    std::vector<float> xs(side * side), zs(side * side), ys(side * side);
+    std::vector<float> verts(side * side * 5);
+    for (int tz = 0; tz < sim.terrain.cellsZ() / n; ++tz) {
+        for (int tx = 0; tx < sim.terrain.cellsX() / n; ++tx) {
+            for (int z = 0; z < side; ++z) {
+                for (int x = 0; x < side; ++x) {
+                    xs[z * side + x] = sim.terrain.minX() + (tx * n + x) * sim.terrain.spacing();
+                    zs[z * side + x] = sim.terrain.minZ() + (tz * n + z) * sim.terrain.spacing();
+                }
+            }
+            sim.terrain.heightsAt(xs.data(), zs.data(), ys.data(), xs.size());
+            for (size_t i = 0; i < xs.size(); ++i) {
+                // x,y,z    u,v
+                verts[i * 5 + 0] = xs[i];
+                verts[i * 5 + 1] = ys[i];
+                verts[i * 5 + 2] = zs[i];
+                verts[i * 5 + 3] = (xs[i] - sim.terrain.minX()) / sizeX;
+                verts[i * 5 + 4] = (zs[i] - sim.terrain.minZ()) / sizeZ;
+            }
 
-    glBindVertexArray(vao);
+            GLuint chunkVao, vbo;
+            glGenVertexArrays(1, &chunkVao);
+            glGenBuffers(1, &vbo);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+            glBindVertexArray(chunkVao);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+            // all chunks share the same grid topology
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            if (floorVaos.empty()) {
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned int), idx.data(), GL_STATIC_DRAW);
+            }
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)(3*sizeof(float)));
-    glEnableVertexAttribArray(1);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)(3*sizeof(float)));
+            glEnableVertexAttribArray(1);
+
+            floorVaos.push_back(chunkVao);
+            floorBuffers.push_back(vbo);
+        }
+    }
 
     glBindVertexArray(0);
 }
@@ -214,6 +290,718 @@ void Game::loadFloorTexture() {
     stbi_image_free(data);
 }
 
+void Game::trackPlayers() {
+    fog.create(sim.terrain.cellsX(), sim.terrain.cellsZ(), sim.terrain.spacing(),
+               sim.terrain.minX(), sim.terrain.minZ(), static_cast<int>(sim.players.size()));
+    fogViewers.clear();
+    for (size_t p = 0; p < sim.players.size(); ++p) {
+        glm::vec3 pos = getPosition(sim.world, sim.players[p].entity);
+        fogViewers.push_back(fog.addViewer(static_cast<int>(p), pos.x, pos.z, kSightRadius));
+    }
+
+    ownUnits.clear();
+    for (const PlayerState& player : sim.players) {
+        ownUnits.push_back(player.entity.index);
+    }
+    std::sort(ownUnits.begin(), ownUnits.end());
+    commands.assign(sim.players.size(), PlayerCommand());
+
+    // entity indices of the previous world mean nothing in this one
+    selection.clear();
+    wasGrounded.clear();
+    minimapDue = true;
+}
+
+void Game::createFog() {
+    trackPlayers();
+
+    glGenTextures(1, &fogTexture);
+    glBindTexture(GL_TEXTURE_2D, fogTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, fog.width(), fog.height(), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    // linear filtering softens the tile edges of the fog
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // every block starts dirty, so the first update fills the whole texture
+    updateFog();
+}
+
+void Game::updateFog() {
+    // viewers that stayed inside their tile are skipped by the fog itself
+    for (size_t p = 0; p < sim.players.size(); ++p) {
+        Entity e = sim.players[p].entity;
+        if (sim.world.alive(e)) {
+            glm::vec3 pos = getPosition(sim.world, e);
+            fog.moveViewer(fogViewers[p], pos.x, pos.z);
+        }
+    }
+
+    fogRects.clear();
+    fog.takeDirtyRects(0, fogRects);
+    if (fogRects.empty()) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, fogTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const FogRect& r : fogRects) {
+        const int w = r.x1 - r.x0;
+        const int h = r.y1 - r.y0;
+        fogTexels.resize(static_cast<size_t>(w) * h);
+        fog.writeTexels(0, r, fogTexels.data());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, r.x0, r.y0, w, h, GL_RED, GL_UNSIGNED_BYTE, fogTexels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Game::createSpriteBuffers() {
+    // static tables: the UV rect of every clip frame and each clip's layout
+    glGenBuffers(1, &uvTableBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, uvTableBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sim.clips.uvCount() * sizeof(glm::vec4), &sim.clips.uv(0), GL_STATIC_DRAW);
+    glGenTextures(1, &uvTableTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, uvTableTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, uvTableBuffer);
+
+    std::vector<SpriteClipEntry> clipTable;
+    SpriteBatch::clipTable(sim.clips, clipTable);
+    glGenBuffers(1, &clipTableBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, clipTableBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, clipTable.size() * sizeof(SpriteClipEntry), clipTable.data(), GL_STATIC_DRAW);
+    glGenTextures(1, &clipTableTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, clipTableTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, clipTableBuffer);
+
+    // per animation row; storage is allocated by the first upload
+    glGenBuffers(1, &clipStateBuffer);
+    glGenTextures(1, &clipStateTexture);
+
+    // instance attributes come after the quad's; their offsets are set
+    // per draw, since GL 3.3 has no base instance
+    glGenBuffers(1, &instanceBuffer);
+    for (const SpriteSheet& sheet : sheets) {
+        glBindVertexArray(sheet.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (GLuint attr = 2; attr <= 4; ++attr) {
+            glEnableVertexAttribArray(attr);
+            glVertexAttribDivisor(attr, 1);
+        }
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Game::createShadowPass() {
+    // Load shadow PNG; without it, bake the soft radial falloff the
+    // fallback used to compute for every fragment
+    int w, h, n;
+    unsigned char* data = stbi_load("assets/Characters/shadow.png", &w, &h, &n, 4);
+    std::vector<unsigned char> baked;
+    if (!data) {
+        std::cerr << "Failed to load shadow texture: assets/Characters/shadow.png, using a radial blob\n";
+        w = h = 64;
+        baked.resize(size_t(w) * h * 4, 0);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                float dx = (float(x) + 0.5f) / float(w) - 0.5f;
+                float dy = (float(y) + 0.5f) / float(h) - 0.5f;
+                // alpha 1 inside 0.12, smoothstep down to 0 at 0.42
+                float t = std::min(std::max((std::sqrt(dx * dx + dy * dy) - 0.12f) / 0.30f, 0.0f), 1.0f);
+                float a = 1.0f - t * t * (3.0f - 2.0f * t);
+                baked[(size_t(y) * w + x) * 4 + 3] = static_cast<unsigned char>(a * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    glGenTextures(1, &shadowTexture);
+    glBindTexture(GL_TEXTURE_2D, shadowTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data ? data : baked.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (data) {
+        stbi_image_free(data);
+    }
+
+    // a unit quad on the XZ plane; instances place and scale it
+    float quad[] = {
+        // x, z         u, v
+        -0.5f, -0.5f,   0.0f, 0.0f,
+         0.5f, -0.5f,   1.0f, 0.0f,
+         0.5f,  0.5f,   1.0f, 1.0f,
+        -0.5f,  0.5f,   0.0f, 1.0f
+    };
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+    glGenVertexArrays(1, &shadowVao);
+    glGenBuffers(1, &shadowQuadBuffer);
+    glGenBuffers(1, &shadowIndexBuffer);
+    glGenBuffers(1, &shadowInstanceBuffer);
+
+    glBindVertexArray(shadowVao);
+    glBindBuffer(GL_ARRAY_BUFFER, shadowQuadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shadowIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, shadowInstanceBuffer);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ShadowInstance), (void*)offsetof(ShadowInstance, x));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(ShadowInstance), (void*)offsetof(ShadowInstance, sx));
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(ShadowInstance), (void*)offsetof(ShadowInstance, alpha));
+    for (GLuint attr = 2; attr <= 4; ++attr) {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindVertexArray(0);
+
+    if (!useShadowLayer) {
+        return;
+    }
+    // low resolution darkness over the whole terrain, sampled by the floor
+    glGenTextures(1, &shadowLayerTexture);
+    glBindTexture(GL_TEXTURE_2D, shadowLayerTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kShadowLayerSize, kShadowLayerSize, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &shadowLayerFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowLayerFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, shadowLayerTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Shadow layer framebuffer incomplete, drawing shadow quads instead\n";
+        useShadowLayer = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Game::drawShadows(const glm::mat4& viewProj) {
+    shadowBatch.build(sim.world, renderQueue.order);
+    const std::vector<ShadowInstance>& instances = shadowBatch.instances;
+
+    glBindBuffer(GL_ARRAY_BUFFER, shadowInstanceBuffer);
+    if (instances.size() > shadowInstanceCapacity) {
+        shadowInstanceCapacity = instances.size() + instances.size() / 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, shadowInstanceCapacity * sizeof(ShadowInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(ShadowInstance), instances.data());
+
+    glUseProgram(shadowProgram);
+    glUniform1i(glGetUniformLocation(shadowProgram, "uTexture"), 0);
+    glUniform1i(glGetUniformLocation(shadowProgram, "uLayer"), useShadowLayer);
+    glBindTexture(GL_TEXTURE_2D, shadowTexture);
+    glBindVertexArray(shadowVao);
+
+    if (!useShadowLayer) {
+        // every blob in one draw, on top of the terrain
+        glUniformMatrix4fv(glGetUniformLocation(shadowProgram, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(instances.size()));
+        glBindVertexArray(0);
+        return;
+    }
+
+    // world XZ straight onto the layer, so texel (u, v) matches the
+    // terrain's own 0..1 UVs
+    const float sizeX = sim.terrain.maxX() - sim.terrain.minX();
+    const float sizeZ = sim.terrain.maxZ() - sim.terrain.minZ();
+    glm::mat4 toLayer(0.0f);
+    toLayer[0][0] = 2.0f / sizeX;
+    toLayer[2][1] = 2.0f / sizeZ;
+    toLayer[3][0] = -2.0f * sim.terrain.minX() / sizeX - 1.0f;
+    toLayer[3][1] = -2.0f * sim.terrain.minZ() / sizeZ - 1.0f;
+    toLayer[3][3] = 1.0f;
+    glUniformMatrix4fv(glGetUniformLocation(shadowProgram, "uViewProj"), 1, GL_FALSE, glm::value_ptr(toLayer));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowLayerFbo);
+    glViewport(0, 0, kShadowLayerSize, kShadowLayerSize);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    // overlapping blobs compose like layered translucent black
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(instances.size()));
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, winWidth, winHeight);
+    glBindVertexArray(0);
+}
+
+void Game::createParticles() {
+    ParticleType dust;
+    dust.capacity = 8192;
+    dust.gravity = -3.0f;
+    dust.drag = 2.0f;
+    dust.sizeStart = 0.12f;
+    dust.sizeEnd = 0.35f;
+    dust.colorStart = glm::vec4(0.55f, 0.48f, 0.38f, 0.6f);
+    dust.colorEnd = glm::vec4(0.55f, 0.48f, 0.38f, 0.0f);
+    dustType = particles.addType(dust);
+    walkClip = sim.clips.find("walk");
+
+    float quad[] = {
+        // x, y         u, v
+        -0.5f, -0.5f,   0.0f, 0.0f,
+         0.5f, -0.5f,   1.0f, 0.0f,
+         0.5f,  0.5f,   1.0f, 1.0f,
+        -0.5f,  0.5f,   0.0f, 1.0f
+    };
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+    glGenVertexArrays(1, &particleVao);
+    glGenBuffers(1, &particleQuadBuffer);
+    glGenBuffers(1, &particleIndexBuffer);
+    glGenBuffers(1, &particleRing);
+
+    glBindVertexArray(particleVao);
+    glBindBuffer(GL_ARRAY_BUFFER, particleQuadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, particleIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // room for every pool at full capacity, kParticleRingFrames times
+    size_t capacity = 0;
+    for (const ParticlePool& pool : particles.pools) {
+        capacity += pool.type.capacity;
+    }
+    particleRingSize = kParticleRingFrames * capacity * sizeof(ParticleInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, particleRing);
+    glBufferData(GL_ARRAY_BUFFER, particleRingSize, nullptr, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+
+    if (useGpuParticles && !gpuDust.init(dust, particleQuadBuffer, particleIndexBuffer)) {
+        std::cerr << "GPU particles unavailable, using the CPU backend: " << gpuDust.error << "\n";
+        useGpuParticles = false;
+    }
+}
+
+void Game::emitDust(float dt) {
+    const GroundedPool& gp = sim.world.grounded;
+    const TransformPool& tp = sim.world.transforms;
+    const AnimationPool& ap = sim.world.animations;
+    for (size_t g = 0; g < gp.size(); ++g) {
+        uint32_t e = gp.entities[g];
+        if (e >= wasGrounded.size()) {
+            wasGrounded.resize(e + 1, 1);
+        }
+        bool grounded = gp.grounded[g] != 0;
+        if (grounded && tp.has(e)) {
+            uint32_t t = tp.row(e);
+            glm::vec3 feet(tp.x[t], gp.floorY[g], tp.z[t]);
+            if (!wasGrounded[e]) {
+                // the ground contact that ends a jump
+                particles.burst(dustType, feet, 16, 1.2f, 0.4f, 0.8f);
+            } else if (ap.has(e) && ap.clip[ap.row(e)] == walkClip && particles.random() < dt * kDustPerSecond) {
+                particles.burst(dustType, feet, 1, 0.5f, 0.3f, 0.6f);
+            }
+        }
+        wasGrounded[e] = grounded;
+    }
+    if (useGpuParticles) {
+        gpuDust.emit(particles.pools[dustType]);
+        gpuDust.update(dt);
+        return;
+    }
+    particles.update(dt);
+}
+
+void Game::drawParticles(const glm::mat4& view, const glm::mat4& viewProj) {
+    size_t live = particles.liveCount();
+    size_t gpuSlots = useGpuParticles ? gpuDust.activeSlots() : 0;
+    if (live == 0 && gpuSlots == 0) {
+        return;
+    }
+    const size_t bytes = live * sizeof(ParticleInstance);
+    if (live > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, particleRing);
+        if (particleRingOffset + bytes > particleRingSize) {
+            // wrap: orphan, so frames still being drawn keep the old storage
+            glBufferData(GL_ARRAY_BUFFER, particleRingSize, nullptr, GL_STREAM_DRAW);
+            particleRingOffset = 0;
+        }
+        // never overlaps what the last frames read, so no need to sync
+        void* dst = glMapBufferRange(GL_ARRAY_BUFFER, particleRingOffset, bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!dst) {
+            return;
+        }
+        particles.writeInstances(static_cast<ParticleInstance*>(dst), particleFirst);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    glUseProgram(particleProgram);
+    glUniformMatrix4fv(glGetUniformLocation(particleProgram, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniform3f(glGetUniformLocation(particleProgram, "uRight"), view[0][0], view[1][0], view[2][0]);
+    glUniform3f(glGetUniformLocation(particleProgram, "uUp"), view[0][1], view[1][1], view[2][1]);
+    glUniform1i(glGetUniformLocation(particleProgram, "uTexture"), 0);
+    GLint locSize = glGetUniformLocation(particleProgram, "uSize");
+    GLint locColorStart = glGetUniformLocation(particleProgram, "uColorStart");
+    GLint locColorEnd = glGetUniformLocation(particleProgram, "uColorEnd");
+    glBindTexture(GL_TEXTURE_2D, shadowTexture);
+    glDepthMask(GL_FALSE);
+    if (live > 0) {
+        glBindVertexArray(particleVao);
+        for (size_t p = 0; p < particles.pools.size(); ++p) {
+            const ParticlePool& pool = particles.pools[p];
+            if (pool.count == 0) {
+                continue;
+            }
+            glUniform2f(locSize, pool.type.sizeStart, pool.type.sizeEnd);
+            glUniform4fv(locColorStart, 1, glm::value_ptr(pool.type.colorStart));
+            glUniform4fv(locColorEnd, 1, glm::value_ptr(pool.type.colorEnd));
+            size_t offset = particleRingOffset + particleFirst[p] * sizeof(ParticleInstance);
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), reinterpret_cast<const void*>(offset));
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(pool.count));
+        }
+        particleRingOffset += bytes;
+    }
+    if (gpuSlots > 0) {
+        // straight from the transform feedback output; dead slots cull themselves
+        glUniform2f(locSize, gpuDust.type.sizeStart, gpuDust.type.sizeEnd);
+        glUniform4fv(locColorStart, 1, glm::value_ptr(gpuDust.type.colorStart));
+        glUniform4fv(locColorEnd, 1, glm::value_ptr(gpuDust.type.colorEnd));
+        glBindVertexArray(gpuDust.renderVao());
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(gpuSlots));
+    }
+    glDepthMask(GL_TRUE);
+    glBindVertexArray(0);
+}
+
+void Game::createLights() {
+    // warm torches at fixed, seeded spots a little above the ground
+    uint32_t seed = 0x2545F491u;
+    auto random = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) * (1.0f / 16777216.0f);
+    };
+    for (int i = 0; i < kTorches; ++i) {
+        PointLight torch;
+        float x = sim.terrain.minX() + random() * (sim.terrain.maxX() - sim.terrain.minX());
+        float z = sim.terrain.minZ() + random() * (sim.terrain.maxZ() - sim.terrain.minZ());
+        torch.position = glm::vec3(x, sim.terrain.heightAt(x, z) + 0.3f, z);
+        torch.radius = 1.0f + random();
+        torch.color = glm::vec3(1.0f, 0.6f, 0.25f) * (0.6f + 0.4f * random());
+        lights.push_back(torch);
+    }
+
+    lightGrid.resize((winWidth + kLightScale - 1) / kLightScale, (winHeight + kLightScale - 1) / kLightScale, kLightTile);
+    glGenTextures(1, &lightTexture);
+    glBindTexture(GL_TEXTURE_2D, lightTexture);
+    // half floats, so lights can brighten past the unlit colour
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, lightGrid.width, lightGrid.height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenFramebuffers(1, &lightFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Light buffer framebuffer incomplete, terrain stays unlit\n";
+        useLights = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // per-frame lists, storage is allocated by each upload
+    glGenVertexArrays(1, &lightVao);
+    glGenBuffers(1, &lightDataBuffer);
+    glGenBuffers(1, &lightIndexBuffer);
+    glGenBuffers(1, &lightTileBuffer);
+    glGenTextures(1, &lightDataTexture);
+    glGenTextures(1, &lightIndexTexture);
+    glGenTextures(1, &lightTileTexture);
+}
+
+void Game::drawLights(const glm::mat4& viewProj) {
+    lightGrid.build(lights.data(), lights.size(), viewProj);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFbo);
+    glViewport(0, 0, lightGrid.width, lightGrid.height);
+    glClearColor(lightAmbient.r, lightAmbient.g, lightAmbient.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!lightGrid.tiles.empty()) {
+        // small lists rebuilt every frame: orphan and refill
+        struct Upload { GLuint buffer; GLuint texture; GLenum format; size_t bytes; const void* data; };
+        const Upload uploads[] = {
+            {lightDataBuffer, lightDataTexture, GL_RGBA32F, lightGrid.lightData.size() * sizeof(float),
+             lightGrid.lightData.data()},
+            {lightIndexBuffer, lightIndexTexture, GL_R32UI, lightGrid.indices.size() * sizeof(uint32_t),
+             lightGrid.indices.data()},
+            {lightTileBuffer, lightTileTexture, GL_RGBA32UI, lightGrid.tiles.size() * sizeof(LightTile),
+             lightGrid.tiles.data()},
+        };
+        for (int i = 0; i < 3; ++i) {
+            glBindBuffer(GL_TEXTURE_BUFFER, uploads[i].buffer);
+            glBufferData(GL_TEXTURE_BUFFER, uploads[i].bytes, uploads[i].data, GL_STREAM_DRAW);
+            glActiveTexture(GL_TEXTURE2 + i);
+            glBindTexture(GL_TEXTURE_BUFFER, uploads[i].texture);
+            glTexBuffer(GL_TEXTURE_BUFFER, uploads[i].format, uploads[i].buffer);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+
+        glUseProgram(lightProgram);
+        glUniform1i(glGetUniformLocation(lightProgram, "uLights"), 2);
+        glUniform1i(glGetUniformLocation(lightProgram, "uTileLights"), 3);
+        glUniform1i(glGetUniformLocation(lightProgram, "uTiles"), 4);
+        glUniform2f(glGetUniformLocation(lightProgram, "uBufferSize"), float(lightGrid.width), float(lightGrid.height));
+        glUniform1f(glGetUniformLocation(lightProgram, "uTileSize"), float(lightGrid.tileSize));
+        glUniform3fv(glGetUniformLocation(lightProgram, "uAmbient"), 1, glm::value_ptr(lightAmbient));
+        // every pixel belongs to one tile: plain writes over the clear
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glBindVertexArray(lightVao);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(lightGrid.tiles.size()));
+        glBindVertexArray(0);
+        glEnable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, winWidth, winHeight);
+}
+
+void Game::createOverlay() {
+    std::vector<uint8_t> atlas;
+    OverlayBatch::atlasPixels(atlas, fontWidth, fontHeight);
+    glGenTextures(1, &fontTexture);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, fontWidth, fontHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // glyphs are drawn 1:1 on whole pixels
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenVertexArrays(1, &overlayVao);
+    glGenBuffers(1, &overlayVertexBuffer);
+    glGenBuffers(1, &overlayIndexBuffer);
+    glBindVertexArray(overlayVao);
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVertexBuffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, x));
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, u));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, color));
+    for (GLuint attr = 0; attr <= 2; ++attr) {
+        glEnableVertexAttribArray(attr);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, overlayIndexBuffer);
+    glBindVertexArray(0);
+}
+
+void Game::drawOverlay() {
+    const size_t lastQuads = overlay.quads();
+    overlay.clear();
+    if (showHud) {
+        hud.counter("update ms", updateMs);
+        hud.counter("units", double(sim.world.count()));
+        hud.counter("sprites drawn", double(renderQueue.order.size()));
+        hud.counter("depth repairs", double(renderQueue.depth.repairs));
+        hud.counter("depth sorts", double(renderQueue.depth.fullSorts));
+        hud.counter("particles", double(useGpuParticles ? gpuDust.activeSlots() : particles.liveCount()));
+        hud.counter("lights shown", double(lightGrid.visible));
+        hud.counter("overlay quads", double(lastQuads));
+        hud.counter("minimap refreshes", double(minimap.refreshes));
+        hud.build(overlay, 8.0f, 8.0f);
+    }
+    if (overlay.vertices.empty()) {
+        return;
+    }
+
+    // a static quad index pattern, grown to fit; vertices orphaned and refilled
+    glBindVertexArray(overlayVao);
+    if (overlay.quads() > overlayQuadCapacity) {
+        overlayQuadCapacity = overlay.quads() + overlay.quads() / 2;
+        std::vector<uint32_t> indices;
+        OverlayBatch::quadIndices(overlayQuadCapacity, indices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, overlayQuadCapacity * 4 * sizeof(OverlayVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, overlay.vertices.size() * sizeof(OverlayVertex), overlay.vertices.data());
+
+    glUseProgram(overlayProgram);
+    glUniform2f(glGetUniformLocation(overlayProgram, "uScreen"), float(winWidth), float(winHeight));
+    glUniform2f(glGetUniformLocation(overlayProgram, "uAtlasSize"), float(fontWidth), float(fontHeight));
+    glUniform1i(glGetUniformLocation(overlayProgram, "uFont"), 0);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glDisable(GL_DEPTH_TEST);
+    glDrawElements(GL_TRIANGLES, GLsizei(overlay.quads() * 6), GL_UNSIGNED_INT, 0);
+    glEnable(GL_DEPTH_TEST);
+    glBindVertexArray(0);
+}
+
+void Game::createMinimap() {
+    minimap.create(sim.terrain, kMinimapCellPixels);
+    glGenTextures(1, &minimapTerrain);
+    glBindTexture(GL_TEXTURE_2D, minimapTerrain);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, minimap.width(), minimap.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenTextures(1, &minimapTexture);
+    glBindTexture(GL_TEXTURE_2D, minimapTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kMinimapSize, kMinimapSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &minimapFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, minimapFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, minimapTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Minimap framebuffer incomplete\n";
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // instance 0 is the map quad; its attributes are ignored
+    glGenVertexArrays(1, &minimapVao);
+    glGenBuffers(1, &minimapDotBuffer);
+    glBindVertexArray(minimapVao);
+    glBindBuffer(GL_ARRAY_BUFFER, minimapDotBuffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(MinimapDot), (void*)offsetof(MinimapDot, u));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MinimapDot), (void*)offsetof(MinimapDot, color));
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(MinimapDot), (void*)offsetof(MinimapDot, flags));
+    for (GLuint attr = 0; attr <= 2; ++attr) {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindVertexArray(0);
+
+    // every tile starts dirty, so the first update shades the whole map
+    updateMinimap();
+}
+
+void Game::updateMinimap() {
+    minimapRects.clear();
+    minimap.takeDirtyRects(minimapRects);
+    if (!minimapRects.empty()) {
+        glBindTexture(GL_TEXTURE_2D, minimapTerrain);
+        for (const MinimapRect& r : minimapRects) {
+            const int w = r.x1 - r.x0;
+            const int h = r.y1 - r.y0;
+            minimapPixels.resize(static_cast<size_t>(w) * h * 4);
+            minimap.shade(sim.terrain, r, minimapPixels.data());
+            glTexSubImage2D(GL_TEXTURE_2D, 0, r.x0, r.y0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, minimapPixels.data());
+        }
+        // the composite shows the new ground right away
+        minimapDue = true;
+    }
+    if (!minimapDue) {
+        return;
+    }
+    minimapDue = false;
+
+    minimap.buildDots(sim.world, sim.terrain, ownUnits, selection, minimapDots);
+    glBindBuffer(GL_ARRAY_BUFFER, minimapDotBuffer);
+    if (minimapDots.size() > minimapDotCapacity) {
+        minimapDotCapacity = minimapDots.size() + minimapDots.size() / 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, minimapDotCapacity * sizeof(MinimapDot), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, minimapDots.size() * sizeof(MinimapDot), minimapDots.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, minimapFbo);
+    glViewport(0, 0, kMinimapSize, kMinimapSize);
+    glUseProgram(minimapProgram);
+    glUniform1i(glGetUniformLocation(minimapProgram, "uTerrain"), 0);
+    glUniform1i(glGetUniformLocation(minimapProgram, "uFog"), 1);
+    glUniform1f(glGetUniformLocation(minimapProgram, "uDotSize"), kMinimapDot);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, fogTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, minimapTerrain);
+    // the map quad covers every pixel, so no clear; dots in buildDots order
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(minimapVao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(minimapDots.size()));
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, winWidth, winHeight);
+}
+
+void Game::drawMinimap() {
+    // top right corner, map z growing down the screen
+    const int margin = 8;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, minimapFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, kMinimapSize, kMinimapSize, winWidth - margin - kMinimapSize, winHeight - margin,
+                      winWidth - margin, winHeight - margin - kMinimapSize, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Game::uploadSprites() {
+    // the simulation's clock, so the shader's frames follow the ticks
+    float clock = float(sim.tick) * Simulation::kTickDt + tickAccumulator;
+    spriteBatch.build(sim.world, sim.clips, renderQueue.order, selection, clock, spriteMode);
+
+    if (spriteMode == SpriteBatch::Mode::Clips) {
+        const std::vector<SpriteClipState>& states = spriteBatch.clipStates;
+        glBindBuffer(GL_TEXTURE_BUFFER, clipStateBuffer);
+        if (states.size() > clipStateCapacity) {
+            // grow with headroom and send every row once
+            clipStateCapacity = states.size() + states.size() / 2;
+            glBufferData(GL_TEXTURE_BUFFER, clipStateCapacity * sizeof(SpriteClipState), nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, states.size() * sizeof(SpriteClipState), states.data());
+            glBindTexture(GL_TEXTURE_BUFFER, clipStateTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, clipStateBuffer);
+        } else {
+            for (const SpriteRowRange& r : spriteBatch.dirtyRows) {
+                glBufferSubData(GL_TEXTURE_BUFFER, r.begin * sizeof(SpriteClipState),
+                                (r.end - r.begin) * sizeof(SpriteClipState), &states[r.begin]);
+            }
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // positions move and the order is re-sorted every frame: orphan and refill
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    if (spriteBatch.instances.size() > instanceCapacity) {
+        instanceCapacity = spriteBatch.instances.size() + spriteBatch.instances.size() / 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, spriteBatch.instanceBytes, spriteBatch.instances.data());
+}
+
+bool Game::recordTo(const std::string& path) {
+    // the recording would start from the state before the replay
+    if (playingReplay) {
+        std::cerr << "Cannot record while playing a replay\n";
+        return false;
+    }
+    recordPath = path;
+    recorder.begin(sim, kIdleUnits, kWorldSeed);
+    return true;
+}
+
+bool Game::playReplay(const std::string& path) {
+    if (!recordPath.empty()) {
+        std::cerr << "Cannot play a replay while recording\n";
+        return false;
+    }
+    if (!replay.load(path, sim.clips)) {
+        std::cerr << "Failed to load replay: " << path << "\n";
+        return false;
+    }
+    replayPlayer.start(replay, sim);
+    // the replay may have another player count than this session
+    trackPlayers();
+    playingReplay = true;
+    return true;
+}
+
 void Game::run() {
     Uint64 last = SDL_GetPerformanceCounter();
     const double freq = static_cast<double>(SDL_GetPerformanceFrequency());
@@ -225,6 +1013,8 @@ void Game::run() {
 
         processEvents();
         update(dt);
+        updateMs = static_cast<float>((SDL_GetPerformanceCounter() - now) / freq * 1000.0);
+        hud.frame(dt * 1000.0f);
         render();
     }
 }
@@ -234,102 +1024,83 @@ void Game::processEvents() {
     while (SDL_PollEvent(&e)) {
         if (e.type == SDL_EVENT_QUIT) {
             running = false;
+        } else if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN && e.button.button == SDL_BUTTON_LEFT) {
+            dragging = true;
+            dragX = e.button.x;
+            dragY = e.button.y;
+        } else if (e.type == SDL_EVENT_MOUSE_BUTTON_UP && e.button.button == SDL_BUTTON_LEFT && dragging) {
+            dragging = false;
+            select(dragX, dragY, e.button.x, e.button.y);
+        } else if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3 && !e.key.repeat) {
+            showHud = !showHud;
         }
     }
 }
 
-void Game::update(float dt) {
-    const bool* keys = SDL_GetKeyboardState(NULL);
-    const float speed = 3.0f;
-
-    // Forward and right projected onto ground plane
-    glm::vec3 cameraPos = glm::vec3(5,5,5);
-    glm::vec3 cameraTarget = glm::vec3(0,0,0);
-
-    glm::vec3 forward = glm::normalize(glm::vec3(cameraTarget - cameraPos));
-    forward.y = 0.0f;
-    forward = glm::normalize(forward);
-
-    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0,1,0)));
-
-    int movementDirection = 0;  // 1 for right, -1 for left, 0 for no movement
-    bool moving = false;
-
-    glm::vec2 dir2(0.0f, 0.0f);
-    if (keys[SDL_SCANCODE_W]) {
-        player.position += forward * speed * dt;
-        moving = true;
-        movementDirection = 1;
-        dir2.y += 1.0f;
-    }
-    if (keys[SDL_SCANCODE_S]) {
-        player.position -= forward * speed * dt;
-        moving = true;
-        movementDirection = 1;
-        dir2.y -= 1.0f;
-    }
-    if (keys[SDL_SCANCODE_A]) {
-        player.position -= right * speed * dt;
-        moving = true;
-        movementDirection = -1;
-        dir2.x -= 1.0f;
-    }
-    if (keys[SDL_SCANCODE_D]) {
-        player.position += right * speed * dt;
-        moving = true;
-        movementDirection = 1;
-        dir2.x += 1.0f;
-    }
-    
-    // Handle jump
-    if (keys[SDL_SCANCODE_SPACE]) {
-        player.jump();
-    }
-    
-    // track last non-zero move direction for idle facing selection
-    if (glm::length(dir2) > 0.001f) {
-        lastMoveDir = glm::normalize(dir2);
-    }
-
-    // compute facing index from lastMoveDir
-    glm::vec2 lv = glm::normalize(lastMoveDir);
-    float angleDeg = glm::degrees(atan2(lv.x, lv.y));
-    float aa = fabs(angleDeg);
-    int facingIdx = 0;
-    if (aa < 22.5f) facingIdx = 0;
-    else if (aa < 67.5f) facingIdx = 1;
-    else if (aa < 112.5f) facingIdx = 2;
-    else if (aa < 157.5f) facingIdx = 3;
-    else facingIdx = 4;
-    player.facingIndex = facingIdx;
-
-    // set activeRow depending on movement vs idle
-    if (moving) {
-        int walkingRow = 6;
-        if (facingIdx == 2 || facingIdx == 3 || facingIdx == 4) walkingRow = 5;
-        if (player.activeRow != walkingRow) {
-            player.activeRow = walkingRow;
-            player.frameIndex = 0;
+void Game::select(float x0, float y0, float x1, float y1) {
+    // the tree is only brought up to date when someone actually clicks
+    picker.update(sim.world);
+    selection.clear();
+    if (std::fabs(x1 - x0) < 4.0f && std::fabs(y1 - y0) < 4.0f) {
+        uint32_t hit = picker.pick(sim.world, viewMatrix, projMatrix, float(winWidth), float(winHeight), x1, y1,
+                                  &sim.clips);
+        if (hit != SpritePicker::kNone) {
+            selection.push_back(hit);
         }
     } else {
-        int idleRow = glm::clamp(player.facingIndex, 0, 4);
-        if (player.activeRow != idleRow) {
-            player.activeRow = idleRow;
-            player.frameIndex = 0;
+        picker.selectRect(sim.world, projMatrix * viewMatrix, float(winWidth), float(winHeight),
+                          x0, y0, x1, y1, selection);
+        std::sort(selection.begin(), selection.end());
+    }
+}
+
+void Game::update(float dt) {
+    const bool* keys = SDL_GetKeyboardState(NULL);
+
+    // the keyboard drives player 0; any others stand still
+    PlayerCommand& cmd = commands[0];
+    cmd.buttons = 0;
+    if (keys[SDL_SCANCODE_W]) cmd.buttons |= PlayerCommand::Forward;
+    if (keys[SDL_SCANCODE_S]) cmd.buttons |= PlayerCommand::Back;
+    if (keys[SDL_SCANCODE_A]) cmd.buttons |= PlayerCommand::Left;
+    if (keys[SDL_SCANCODE_D]) cmd.buttons |= PlayerCommand::Right;
+    if (keys[SDL_SCANCODE_SPACE]) cmd.buttons |= PlayerCommand::Jump;
+
+    // Fixed-length ticks keep the simulation reproducible; after a long
+    // hitch drop the backlog instead of spiralling.
+    tickAccumulator += dt;
+    int steps = 0;
+    while (tickAccumulator >= Simulation::kTickDt && steps < 8) {
+        if (playingReplay) {
+            if (!replayPlayer.step(sim, &jobs)) {
+                // end of the recording: hand control back to the keyboard
+                playingReplay = false;
+                if (replayPlayer.desyncTick != ~0u) {
+                    std::cerr << "Replay desynced at tick " << replayPlayer.desyncTick << "\n";
+                }
+            }
+        } else {
+            if (!recordPath.empty()) {
+                recorder.record(sim, commands.data());
+            }
+            sim.step(commands.data(), &jobs);
         }
+        tickAccumulator -= Simulation::kTickDt;
+        ++steps;
+    }
+    if (steps == 8) {
+        tickAccumulator = 0.0f;
     }
 
-    player.updateAnimation(dt, moving, movementDirection);
-    // player class handles gravity
-    player.update(dt);
+    emitDust(dt);
+    if (minimap.tick(dt)) {
+        minimapDue = true;
+    }
 }
 
 void Game::render() {
-    glViewport(0, 0, winWidth, winHeight);
-    glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glUseProgram(shaderProgram);
+    updateFog();
+    updateMinimap();
 
     // Camera
     glm::vec3 cameraPos    = glm::vec3(5.0f, 5.0f, 5.0f);
@@ -341,16 +1112,35 @@ void Game::render() {
                                       float(winWidth) / float(winHeight),
                                       0.1f,
                                       100.0f);
+    viewMatrix = view;
+    projMatrix = proj;
+
+    // Cull and sort sprites back to front across the job threads
+    renderQueue.build(sim.world, proj * view, cameraPos, jobs);
+
+    // The shadow layer is drawn first so the terrain can sample it
+    if (useShadowLayer) {
+        drawShadows(proj * view);
+    }
+    if (useLights) {
+        drawLights(proj * view);
+    }
+
+    glViewport(0, 0, winWidth, winHeight);
+    glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(shaderProgram);
 
     GLint loc = glGetUniformLocation(shaderProgram, "uMVP");
-    GLint locCols = glGetUniformLocation(shaderProgram, "uCols");
-    GLint locRows = glGetUniformLocation(shaderProgram, "uRows");
-    GLint locFrame = glGetUniformLocation(shaderProgram, "uFrame");
-    GLint locMirror = glGetUniformLocation(shaderProgram, "uMirror");
-    GLint locUseColor = glGetUniformLocation(shaderProgram, "uUseColor");
+    GLint locUVRect = glGetUniformLocation(shaderProgram, "uUVRect");
     GLint locColor = glGetUniformLocation(shaderProgram, "uColor");
-    GLint locShadowInner = glGetUniformLocation(shaderProgram, "uShadowInner");
-    GLint locShadowOuter = glGetUniformLocation(shaderProgram, "uShadowOuter");
+    GLint locFog = glGetUniformLocation(shaderProgram, "uFog");
+    GLint locUseFog = glGetUniformLocation(shaderProgram, "uUseFog");
+    GLint locShadowLayer = glGetUniformLocation(shaderProgram, "uShadowLayer");
+    GLint locUseShadowLayer = glGetUniformLocation(shaderProgram, "uUseShadowLayer");
+    GLint locLightBuffer = glGetUniformLocation(shaderProgram, "uLightBuffer");
+    GLint locUseLights = glGetUniformLocation(shaderProgram, "uUseLights");
 
     // Render floor
     {
@@ -358,107 +1148,150 @@ void Game::render() {
         glm::mat4 mvp   = proj * view * model;
 
         glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mvp));
-        glUniform1i(locCols, 1);
-        glUniform1i(locRows, 1);
-        glUniform1i(locFrame, 0);
-        glUniform1i(locMirror, 1);
+        glUniform4f(locUVRect, 0.0f, 0.0f, 1.0f, 1.0f);
         // ensure no tinting from previous draws
         glUniform4f(locColor, 1.0f, 1.0f, 1.0f, 1.0f);
 
-        glBindTexture(GL_TEXTURE_2D, textureID);    // floor texture
-        glBindVertexArray(vao);                     // floor mesh
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    }
-
-    // Render player sprite
-    {
-        // Render soft shadow under player
-        {
-            glm::mat4 shadowModel = glm::mat4(1.0f);
-            // position at player's x/z, just above the floor to avoid z-fighting
-            glm::vec3 shadowPos = player.position;
-            shadowPos.y = player.floorY + 0.01f;
-            shadowModel = glm::translate(shadowModel, shadowPos);
-            // rotate quad to lie flat on XZ plane
-            shadowModel = glm::rotate(shadowModel, glm::radians(-90.0f), glm::vec3(1,0,0));
-
-            // shrink and soften shadow while airborne
-            float sx = player.isGrounded ? 0.8f : 0.5f;
-            float sz = player.isGrounded ? 0.5f : 0.3f;
-            float shadowAlpha = player.isGrounded ? 1.0f : 0.55f;
-            shadowModel = glm::scale(shadowModel, glm::vec3(sx, 1.0f, sz));
-
-            glm::mat4 shadowMVP = proj * view * shadowModel;
-            glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(shadowMVP));
-
-            if (shadowTexture != 0) {
-                // textured shadow: bind generated soft texture and modulate alpha via uColor
-                glUniform1i(locUseColor, 0);
-                glBindTexture(GL_TEXTURE_2D, shadowTexture);
-                glUniform4f(locColor, 1.0f, 1.0f, 1.0f, shadowAlpha);
-                glUniform1i(locCols, 1);
-                glUniform1i(locRows, 1);
-                glUniform1i(locFrame, 0);
-                glUniform1i(locMirror, 1);
-            } else {
-                // fallback: procedural radial shadow
-                glUniform1i(locUseColor, 2);
-                glUniform4f(locColor, 0.0f, 0.0f, 0.0f, shadowAlpha);
-                glUniform1f(locShadowInner, 0.12f);
-                glUniform1f(locShadowOuter, 0.42f);
-                glUniform1i(locCols, 1);
-                glUniform1i(locRows, 1);
-                glUniform1i(locFrame, 0);
-                glUniform1i(locMirror, 1);
-            }
-
-            // draw using the player quad VAO (rotated to lie flat)
-            glBindVertexArray(player.vao);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        // fog texture on unit 1, sampled with the same 0..1 terrain UVs
+        glUniform1i(locFog, 1);
+        glUniform1i(locUseFog, 1);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, fogTexture);
+        // and the shadow layer on unit 5, with the same UVs
+        glUniform1i(locShadowLayer, 5);
+        glUniform1i(locUseShadowLayer, useShadowLayer);
+        glActiveTexture(GL_TEXTURE5);
+        glBindTexture(GL_TEXTURE_2D, shadowLayerTexture);
+        // and the light buffer on unit 6, by screen position
+        glUniform1i(locLightBuffer, 6);
+        glUniform1i(locUseLights, useLights);
+        glUniform2f(glGetUniformLocation(shaderProgram, "uViewportSize"), float(winWidth), float(winHeight));
+        glActiveTexture(GL_TEXTURE6);
+        glBindTexture(GL_TEXTURE_2D, lightTexture);
+        glActiveTexture(GL_TEXTURE0);
 
-            // restore to texture mode and reset tint to white so subsequent draws are unaffected
-            glUniform1i(locUseColor, 0);
-            glUniform4f(locColor, 1.0f, 1.0f, 1.0f, 1.0f);
+        glBindTexture(GL_TEXTURE_2D, textureID);    // floor texture
+        for (unsigned int chunk : floorVaos) {      // terrain chunk meshes
+            glBindVertexArray(chunk);
+            glDrawElements(GL_TRIANGLES, floorIndexCount, GL_UNSIGNED_INT, 0);
         }
+        glUniform1i(locUseFog, 0);
+        glUniform1i(locUseShadowLayer, 0);
+        glUniform1i(locUseLights, 0);
+    }
 
-        // compute view/proj
-        glm::mat4 model = glm::mat4(1.0f);
-
-        // place player into world
-        model = glm::translate(model, player.position);
-
-        // create billboard rotation so quad faces camera
-        glm::mat4 billboard = glm::mat4(glm::transpose(glm::mat3(view)));
-        // rotate upside down (appeared wrong before)
-        billboard = glm::rotate(billboard, glm::radians(180.0f), glm::vec3(1,0,0));
-        model = model * billboard;
-
-        glm::mat4 mvp = proj * view * model;
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mvp));
-
-        // Set animation uniforms
-        glUniform1i(locCols, player.animCols);
-        glUniform1i(locRows, player.animRows);
-        // compose global frame number = row*cols + frameIndex
-        int frameNumber = player.activeRow * player.animCols + player.frameIndex;
-        glUniform1i(locFrame, frameNumber);
-        glUniform1i(locMirror, player.facingDirection);
-
-        glDepthMask(GL_FALSE);  // Disable depth writing for transparent sprite
-        glBindTexture(GL_TEXTURE_2D, player.textureID);
-        glBindVertexArray(player.vao);
+    // Without the layer, blob shadows go on top of the terrain as quads
+    if (!useShadowLayer) {
+        drawShadows(proj * view);
+    }
 
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glDepthMask(GL_TRUE);   // Re-enable depth writing
+    // Render unit sprites: one instanced draw per run of the same sheet
+    uploadSprites();
+    glUseProgram(spriteProgram);
+
+    // create billboard rotation so quad faces camera
+    glm::mat4 billboard = glm::mat4(glm::transpose(glm::mat3(view)));
+    // rotate upside down (appeared wrong before)
+    billboard = glm::rotate(billboard, glm::radians(180.0f), glm::vec3(1,0,0));
+    glm::mat3 billboard3(billboard);
+    glm::mat4 viewProj = proj * view;
+    glUniformMatrix4fv(glGetUniformLocation(spriteProgram, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniformMatrix3fv(glGetUniformLocation(spriteProgram, "uBillboard"), 1, GL_FALSE, glm::value_ptr(billboard3));
+    glUniform1i(glGetUniformLocation(spriteProgram, "uClipMode"), spriteMode == SpriteBatch::Mode::Clips);
+    glUniform1f(glGetUniformLocation(spriteProgram, "uClock"),
+                float(sim.tick) * Simulation::kTickDt + tickAccumulator);
+    glUniform1i(glGetUniformLocation(spriteProgram, "uTexture"), 0);
+    glUniform1i(glGetUniformLocation(spriteProgram, "uUVs"), 2);
+    glUniform1i(glGetUniformLocation(spriteProgram, "uClips"), 3);
+    glUniform1i(glGetUniformLocation(spriteProgram, "uClipStates"), 4);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, uvTableTexture);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_BUFFER, clipTableTexture);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_BUFFER, clipStateTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glDepthMask(GL_FALSE);  // Disable depth writing for transparent sprites
+    for (const SpriteRun& run : spriteBatch.runs) {
+        const SpriteSheet& sheet = sheets[run.sheet];
+        glBindTexture(GL_TEXTURE_2D, sheet.textureID);
+        glBindVertexArray(sheet.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        const char* base = reinterpret_cast<const char*>(run.first * sizeof(SpriteInstance));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+                              base + offsetof(SpriteInstance, x));
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(SpriteInstance),
+                               base + offsetof(SpriteInstance, anim));
+        glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(SpriteInstance),
+                               base + offsetof(SpriteInstance, flags));
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, GLsizei(run.count));
     }
+    glDepthMask(GL_TRUE);   // Re-enable depth writing
+    glBindVertexArray(0);
+
+    drawParticles(view, viewProj);
+    drawMinimap();
+    drawOverlay();
 
     SDL_GL_SwapWindow(window);
 }
 
 void Game::clean() {
+    if (!recordPath.empty() && !recorder.finish().save(recordPath)) {
+        std::cerr << "Failed to write replay: " << recordPath << "\n";
+    }
+    for (SpriteSheet& sheet : sheets) {
+        sheet.destroy();
+    }
     glDeleteTextures(1, &textureID);
-    glDeleteVertexArrays(1, &vao);
+    glDeleteTextures(1, &fogTexture);
+    glDeleteTextures(1, &uvTableTexture);
+    glDeleteTextures(1, &clipTableTexture);
+    glDeleteTextures(1, &clipStateTexture);
+    glDeleteBuffers(1, &uvTableBuffer);
+    glDeleteBuffers(1, &clipTableBuffer);
+    glDeleteBuffers(1, &clipStateBuffer);
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteTextures(1, &shadowTexture);
+    glDeleteTextures(1, &shadowLayerTexture);
+    glDeleteFramebuffers(1, &shadowLayerFbo);
+    glDeleteVertexArrays(1, &shadowVao);
+    glDeleteBuffers(1, &shadowQuadBuffer);
+    glDeleteBuffers(1, &shadowIndexBuffer);
+    glDeleteBuffers(1, &shadowInstanceBuffer);
+    glDeleteVertexArrays(1, &particleVao);
+    glDeleteBuffers(1, &particleQuadBuffer);
+    glDeleteBuffers(1, &particleIndexBuffer);
+    glDeleteBuffers(1, &particleRing);
+    gpuDust.destroy();
+    glDeleteVertexArrays(1, &lightVao);
+    glDeleteBuffers(1, &lightDataBuffer);
+    glDeleteBuffers(1, &lightIndexBuffer);
+    glDeleteBuffers(1, &lightTileBuffer);
+    glDeleteTextures(1, &lightDataTexture);
+    glDeleteTextures(1, &lightIndexTexture);
+    glDeleteTextures(1, &lightTileTexture);
+    glDeleteTextures(1, &lightTexture);
+    glDeleteFramebuffers(1, &lightFbo);
+    glDeleteVertexArrays(1, &overlayVao);
+    glDeleteBuffers(1, &overlayVertexBuffer);
+    glDeleteBuffers(1, &overlayIndexBuffer);
+    glDeleteTextures(1, &fontTexture);
+    glDeleteVertexArrays(1, &minimapVao);
+    glDeleteBuffers(1, &minimapDotBuffer);
+    glDeleteTextures(1, &minimapTerrain);
+    glDeleteTextures(1, &minimapTexture);
+    glDeleteFramebuffers(1, &minimapFbo);
+    glDeleteVertexArrays(static_cast<GLsizei>(floorVaos.size()), floorVaos.data());
+    glDeleteBuffers(static_cast<GLsizei>(floorBuffers.size()), floorBuffers.data());
     glDeleteProgram(shaderProgram);
+    glDeleteProgram(spriteProgram);
+    glDeleteProgram(shadowProgram);
+    glDeleteProgram(particleProgram);
+    glDeleteProgram(lightProgram);
+    glDeleteProgram(overlayProgram);
+    glDeleteProgram(minimapProgram);
 
     SDL_GL_DestroyContext(glContext);
     SDL_DestroyWindow(window);
@@ -3,11 +3,31 @@
 
 #include <SDL3/SDL.h>
 # include <string>
-# include "Player.hpp"
+# include <vector>
+# include <glm/glm.hpp>
+# include "FogOfWar.hpp"
+# include "JobSystem.hpp"
+# include "LightGrid.hpp"
+# include "Minimap.hpp"
+# include "Overlay.hpp"
+# include "Particles.hpp"
+# include "GpuParticles.hpp"
+# include "RenderQueue.hpp"
+# include "Replay.hpp"
+# include "ShadowBatch.hpp"
+# include "Simulation.hpp"
+# include "SpriteBatch.hpp"
+# include "SpritePicker.hpp"
+# include "SpriteSheet.hpp"
 
 class Game {
 	public:
 		bool init(const std::string& title, int width, int height);
+		// After init: record this session's input to a replay file, or
+		// drive the game from a recorded one instead of the keyboard.
+		// Only one of the two per session; the second call fails.
+		bool recordTo(const std::string& path);
+		bool playReplay(const std::string& path);
 		void run();
 		void clean();
 
@@ -16,27 +36,181 @@ class Game {
 		void loadShaders();
 		void createFloorMesh();
 		void loadFloorTexture();
+		// Fog viewers, the local player's own units and the commands
+		// stepped with, sized to sim.players; redone when a replay
+		// re-initialises the simulation.
+		void trackPlayers();
+		void createFog();
+		void updateFog();
+		void createSpriteBuffers();
+		void createShadowPass();
+		// Blob shadows of the queued sprites in one instanced draw, into the
+		// shadow layer or straight onto the screen.
+		void drawShadows(const glm::mat4& viewProj);
+		void createParticles();
+		// Dust where units land or walk; advances every particle.
+		void emitDust(float dt);
+		void drawParticles(const glm::mat4& view, const glm::mat4& viewProj);
+		void createLights();
+		// Bins the lights into screen tiles and renders the light buffer
+		// the terrain is modulated by.
+		void drawLights(const glm::mat4& viewProj);
+		void createOverlay();
+		// Performance HUD and anything else queued in `overlay`, in one draw.
+		void drawOverlay();
+		void createMinimap();
+		// Patches changed terrain tiles and, when a refresh is due,
+		// composites map, fog and unit dots in one instanced draw.
+		void updateMinimap();
+		void drawMinimap();
+		void uploadSprites();
 		void processEvents();
+		// Click (short drag) picks one unit, a longer drag box-selects.
+		void select(float x0, float y0, float x1, float y1);
 		void update(float dt);
 		void render();
 
-		Player player;
+		// deterministic world state, advanced in fixed ticks
+		Simulation sim;
+		float tickAccumulator = 0.0f;
+		std::vector<PlayerCommand> commands; // one per player, 0 is the keyboard
+		ReplayRecorder recorder;
+		std::string recordPath;
+		Replay replay;
+		ReplayPlayer replayPlayer;
+		bool playingReplay = false;
+		std::vector<SpriteSheet> sheets;
+		JobSystem jobs;
+		RenderQueue renderQueue;
 		SDL_Window* window {nullptr};
 		SDL_GLContext glContext {nullptr};
 		bool running {false};
 
 		unsigned int shaderProgram = 0;
-		unsigned int vao = 0;
+		// terrain chunk meshes, one per heightfield tile
+		std::vector<unsigned int> floorVaos;
+		std::vector<unsigned int> floorBuffers;
+		int floorIndexCount = 0;
 		unsigned int textureID = 0;
 
-		// shadow texture (generated at runtime)
+		// fog of war: a sight stamp per player unit, one fog tile per terrain
+		// cell; the local player's view lives in an R8 texture that only
+		// gets its dirty rectangles re-uploaded
+		FogOfWar fog;
+		std::vector<uint32_t> fogViewers;
+		std::vector<FogRect> fogRects;
+		std::vector<uint8_t> fogTexels;
+		unsigned int fogTexture = 0;
+
+		// mouse selection; matrices are the ones the last frame was drawn with
+		SpritePicker picker;
+		std::vector<uint32_t> selection; // entity indices, sorted
+		glm::mat4 viewMatrix {1.0f};
+		glm::mat4 projMatrix {1.0f};
+		bool dragging = false;
+		float dragX = 0.0f;
+		float dragY = 0.0f;
+
+		// instanced unit sprites; in Clips mode the shader plays the clips
+		// and only clip/facing changes are uploaded
+		unsigned int spriteProgram = 0;
+		SpriteBatch spriteBatch;
+		SpriteBatch::Mode spriteMode = SpriteBatch::Mode::Clips;
+		unsigned int instanceBuffer = 0;
+		size_t instanceCapacity = 0;
+		unsigned int uvTableBuffer = 0;
+		unsigned int uvTableTexture = 0;
+		unsigned int clipTableBuffer = 0;
+		unsigned int clipTableTexture = 0;
+		unsigned int clipStateBuffer = 0;
+		unsigned int clipStateTexture = 0;
+		size_t clipStateCapacity = 0;
+
+		// blob shadows; with the layer they are accumulated at low
+		// resolution over the terrain, which darkens itself from it
+		unsigned int shadowProgram = 0;
+		ShadowBatch shadowBatch;
+		bool useShadowLayer = true;
 		unsigned int shadowTexture = 0;
+		unsigned int shadowVao = 0;
+		unsigned int shadowQuadBuffer = 0;
+		unsigned int shadowIndexBuffer = 0;
+		unsigned int shadowInstanceBuffer = 0;
+		size_t shadowInstanceCapacity = 0;
+		unsigned int shadowLayerFbo = 0;
+		unsigned int shadowLayerTexture = 0;
+
+		// cosmetic dust, kept out of the simulation; each frame's live
+		// particles are written straight into the next slice of a ring
+		// buffer and drawn with one instanced draw per pool
+		ParticleSystem particles;
+		uint16_t dustType = 0;
+		uint16_t walkClip = 0;
+		std::vector<uint8_t> wasGrounded; // by entity index, to spot landings
+		std::vector<size_t> particleFirst;
+		unsigned int particleProgram = 0;
+		unsigned int particleVao = 0;
+		unsigned int particleQuadBuffer = 0;
+		unsigned int particleIndexBuffer = 0;
+		unsigned int particleRing = 0;
+		size_t particleRingSize = 0; // bytes
+		size_t particleRingOffset = 0;
+		// with the GPU backend the dust pool only collects each frame's
+		// spawns; gpuDust simulates and feeds the draw by itself
+		bool useGpuParticles = false;
+		GpuParticles gpuDust;
+
+		// point lights, accumulated in one pass over the lit tiles of a
+		// low resolution screen-space buffer; unlit tiles stay ambient
+		std::vector<PointLight> lights;
+		LightGrid lightGrid;
+		bool useLights = true;
+		glm::vec3 lightAmbient {0.7f};
+		unsigned int lightProgram = 0;
+		unsigned int lightVao = 0; // no attributes, the shader uses ids
+		unsigned int lightDataBuffer = 0;
+		unsigned int lightDataTexture = 0;
+		unsigned int lightIndexBuffer = 0;
+		unsigned int lightIndexTexture = 0;
+		unsigned int lightTileBuffer = 0;
+		unsigned int lightTileTexture = 0;
+		unsigned int lightFbo = 0;
+		unsigned int lightTexture = 0;
+
+		// screen-space text and debug graphics, streamed once per frame;
+		// F3 toggles the performance HUD
+		OverlayBatch overlay;
+		PerfHud hud;
+		bool showHud = true;
+		float updateMs = 0.0f;
+		unsigned int overlayProgram = 0;
+		unsigned int overlayVao = 0;
+		unsigned int overlayVertexBuffer = 0;
+		unsigned int overlayIndexBuffer = 0;
+		size_t overlayQuadCapacity = 0;
+		unsigned int fontTexture = 0;
+		int fontWidth = 0;
+		int fontHeight = 0;
+
+		// minimap: the terrain is shaded into a texture once at load and
+		// only dirty tiles are patched; map, fog and unit dots go into a
+		// small target at minimap.refreshInterval, blitted every frame
+		Minimap minimap;
+		bool minimapDue = true;
+		std::vector<MinimapRect> minimapRects;
+		std::vector<uint8_t> minimapPixels;
+		std::vector<MinimapDot> minimapDots;
+		std::vector<uint32_t> ownUnits;
+		unsigned int minimapProgram = 0;
+		unsigned int minimapTerrain = 0;
+		unsigned int minimapTexture = 0;
+		unsigned int minimapFbo = 0;
+		unsigned int minimapVao = 0;
+		unsigned int minimapDotBuffer = 0;
+		size_t minimapDotCapacity = 0;
 
 		int winWidth = 1200;
 		int winHeight = 1000;
-
-		// last move direction used to determine facing row when idle
-		glm::vec2 lastMoveDir {0.0f, 1.0f};
 };
 
 #endif
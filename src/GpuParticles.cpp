@@ -0,0 +1,174 @@
+#include "GpuParticles.hpp"
+#include "thirdparty/glad/include/glad/glad.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+static const char* kUpdateShader = "src/shaders/particle_update.vert";
+
+static std::string loadFile(const char* path) {
+    std::ifstream file(path);
+    std::stringstream buf;
+    buf << file.rdbuf();
+    return buf.str();
+}
+
+bool GpuParticles::init(const ParticleType& t, unsigned int quadBuffer, unsigned int indexBuffer) {
+    type = t;
+    error.clear();
+    std::string src = loadFile(kUpdateShader);
+    if (src.empty()) {
+        error = std::string("cannot read ") + kUpdateShader;
+        return false;
+    }
+    GLuint v = glCreateShader(GL_VERTEX_SHADER);
+    const char* vsrc = src.c_str();
+    glShaderSource(v, 1, &vsrc, nullptr);
+    glCompileShader(v);
+
+    // vertex shader only: the varyings have to be named before linking
+    program = glCreateProgram();
+    glAttachShader(program, v);
+    const char* varyings[] = {"vState", "vMotion"};
+    glTransformFeedbackVaryings(program, 2, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glDeleteShader(v);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[512] = {};
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        error = std::string("particle update shader: ") + log;
+        destroy();
+        return false;
+    }
+    locDt = glGetUniformLocation(program, "uDt");
+    locGravityDt = glGetUniformLocation(program, "uGravityDt");
+    locDamp = glGetUniformLocation(program, "uDamp");
+
+    // every slot starts out dead
+    std::vector<GpuParticle> dead(type.capacity, GpuParticle{0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f});
+    glGenBuffers(2, buffers);
+    glGenVertexArrays(2, updateVaos);
+    glGenVertexArrays(2, renderVaos);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, dead.size() * sizeof(GpuParticle), dead.data(), GL_DYNAMIC_COPY);
+
+        glBindVertexArray(updateVaos[i]);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)(4*sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        glBindVertexArray(renderVaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)0);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+    }
+    glBindVertexArray(0);
+    glGenBuffers(1, &spawnBuffer);
+    current = 0;
+    used = 0;
+    cursor = 0;
+    return true;
+}
+
+void GpuParticles::destroy() {
+    if (program) {
+        glDeleteProgram(program);
+    }
+    if (buffers[0]) {
+        glDeleteBuffers(2, buffers);
+        glDeleteVertexArrays(2, updateVaos);
+        glDeleteVertexArrays(2, renderVaos);
+    }
+    if (spawnBuffer) {
+        glDeleteBuffers(1, &spawnBuffer);
+    }
+    program = spawnBuffer = 0;
+    buffers[0] = buffers[1] = 0;
+    spawnCapacity = 0;
+    used = cursor = 0;
+    pending.clear();
+}
+
+void GpuParticles::emit(ParticlePool& spawns) {
+    for (size_t i = 0; i < spawns.count; ++i) {
+        pending.push_back(GpuParticle{spawns.x[i], spawns.y[i], spawns.z[i], spawns.age[i] * spawns.invLife[i],
+                                      spawns.vx[i], spawns.vy[i], spawns.vz[i], spawns.invLife[i]});
+    }
+    spawns.clear();
+}
+
+void GpuParticles::update(float dt) {
+    spawned = 0;
+    if (!program) {
+        return;
+    }
+    const size_t capacity = type.capacity;
+    if (!pending.empty() && capacity > 0) {
+        // more than a full ring at once: only the newest survive anyway
+        size_t n = std::min(pending.size(), capacity);
+        const GpuParticle* src = pending.data() + (pending.size() - n);
+        glBindBuffer(GL_COPY_READ_BUFFER, spawnBuffer);
+        if (n > spawnCapacity) {
+            spawnCapacity = std::max(n, std::min(capacity, spawnCapacity * 2));
+        }
+        // orphaned each time, so the copy never waits on the last one
+        glBufferData(GL_COPY_READ_BUFFER, spawnCapacity * sizeof(GpuParticle), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_COPY_READ_BUFFER, 0, n * sizeof(GpuParticle), src);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[current]);
+        size_t head = std::min(n, capacity - cursor);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                            cursor * sizeof(GpuParticle), head * sizeof(GpuParticle));
+        if (n > head) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, head * sizeof(GpuParticle),
+                                0, (n - head) * sizeof(GpuParticle));
+            used = capacity;
+        } else {
+            used = std::max(used, cursor + n);
+        }
+        cursor = (cursor + n) % capacity;
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        spawned = n;
+        pending.clear();
+    }
+    if (used == 0) {
+        return;
+    }
+
+    glUseProgram(program);
+    glUniform1f(locDt, dt);
+    glUniform1f(locGravityDt, type.gravity * dt);
+    glUniform1f(locDamp, std::max(0.0f, 1.0f - type.drag * dt));
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(updateVaos[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[1 - current]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, GLsizei(used));
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    current = 1 - current;
+}
+
+void GpuParticles::read(std::vector<GpuParticle>& out) const {
+    out.resize(used);
+    if (used == 0) {
+        return;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, buffers[current]);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, used * sizeof(GpuParticle), out.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
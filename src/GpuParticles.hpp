@@ -0,0 +1,65 @@
+#ifndef GPUPARTICLES_HPP
+#define GPUPARTICLES_HPP
+
+# include <cstddef>
+# include <string>
+# include <vector>
+# include "Particles.hpp"
+
+// One particle as the GPU backend stores it. The first vec4 has the
+// layout of a ParticleInstance, so the particle shader reads it as is.
+struct GpuParticle {
+    float x, y, z, t;             // t: fraction of life used, >= 1 when dead
+    float vx, vy, vz, invLife;
+};
+
+// Particles of one type simulated entirely on the GPU. The state lives in
+// two buffers of type.capacity slots; each update() runs the update vertex
+// shader over one with rasterisation off and captures the result into the
+// other through transform feedback, then swaps them. The CPU only sends
+// new particles: emit() queues them, update() copies them from a spawn
+// buffer over the oldest slots, which also retires whatever lived there.
+// Dead slots are kept in place and skipped by the shaders, so there is no
+// compaction and nothing is ever read back.
+class GpuParticles {
+public:
+    ParticleType type;
+    std::string error; // set when init() fails
+
+    // quadBuffer/indexBuffer: the particle quad ({x, y, u, v} per corner,
+    // six indices) shared with the CPU backend's vertex array.
+    bool init(const ParticleType& t, unsigned int quadBuffer, unsigned int indexBuffer);
+    void destroy();
+
+    // Queues every particle of `spawns`, then empties it; the pool is used
+    // as the spawn list only and is never updated itself.
+    void emit(ParticlePool& spawns);
+    void update(float dt);
+
+    // Vertex array for the particle shader: the quad plus the current
+    // state as instance attribute 2. Draw activeSlots() instances.
+    unsigned int renderVao() const { return renderVaos[current]; }
+    size_t activeSlots() const { return used; }
+
+    // Copies the current state back; for tests and benchmarks only.
+    void read(std::vector<GpuParticle>& out) const;
+
+    size_t spawned = 0; // by the last update
+
+private:
+    unsigned int program = 0;
+    int locDt = -1;
+    int locGravityDt = -1;
+    int locDamp = -1;
+    unsigned int buffers[2] = {0, 0};
+    unsigned int updateVaos[2] = {0, 0};
+    unsigned int renderVaos[2] = {0, 0};
+    unsigned int spawnBuffer = 0;
+    size_t spawnCapacity = 0; // particles
+    int current = 0;          // buffer holding the latest state
+    size_t used = 0;          // slots ever written: the update's range
+    size_t cursor = 0;        // next slot a spawn overwrites
+    std::vector<GpuParticle> pending;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "GridAStar.hpp"
+#include <algorithm>
+
+static const int kDx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int kDy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+static bool heapGreater(const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+    return a.first > b.first;
+}
+
+void GridAStar::prepare(const NavGrid& nav) {
+    size_t n = size_t(nav.width()) * nav.height();
+    if (g.size() != n) {
+        g.assign(n, 0);
+        parent.assign(n, 0);
+        stamp.assign(n, 0);
+        closed.assign(n, 0);
+        search_ = 0;
+    }
+    if (++search_ == 0) {
+        // stamp wrapped: forget every old search
+        std::fill(stamp.begin(), stamp.end(), 0);
+        search_ = 1;
+    }
+    open.clear();
+    expanded = 0;
+}
+
+template <typename Heuristic>
+void GridAStar::run(const NavGrid& nav, uint32_t start, uint32_t goal, const GridRect& bounds, Heuristic h) {
+    const uint32_t w = uint32_t(nav.width());
+    g[start] = 0;
+    parent[start] = start;
+    stamp[start] = search_;
+    closed[start] = 0;
+    open.push_back({h(start), start});
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), heapGreater);
+        uint32_t t = open.back().second;
+        open.pop_back();
+        if (closed[t]) {
+            continue;
+        }
+        closed[t] = 1;
+        ++expanded;
+        if (t == goal) {
+            return;
+        }
+        int x = int(t % w), y = int(t / w);
+        uint8_t c = nav.cost(t);
+        for (int d = 0; d < 8; ++d) {
+            int nx = x + kDx[d], ny = y + kDy[d];
+            if (!bounds.contains(nx, ny) || !nav.walkable(nx, ny)) {
+                continue;
+            }
+            bool diagonal = d & 1;
+            if (diagonal && (!nav.walkable(nx, y) || !nav.walkable(x, ny))) {
+                continue;
+            }
+            uint32_t nt = nav.index(nx, ny);
+            uint32_t ng = g[t] + gridStepCost(c, nav.cost(nt), diagonal);
+            if (stamp[nt] != search_) {
+                stamp[nt] = search_;
+                closed[nt] = 0;
+            } else if (closed[nt] || ng >= g[nt]) {
+                continue;
+            }
+            g[nt] = ng;
+            parent[nt] = t;
+            open.push_back({ng + h(nt), nt});
+            std::push_heap(open.begin(), open.end(), heapGreater);
+        }
+    }
+}
+
+uint32_t GridAStar::search(const NavGrid& nav, uint32_t start, uint32_t goal, std::vector<uint32_t>& path,
+                           const GridRect* bounds) {
+    path.clear();
+    prepare(nav);
+    const uint32_t w = uint32_t(nav.width());
+    if (nav.cost(start) == NavGrid::kBlocked || nav.cost(goal) == NavGrid::kBlocked) {
+        return kNoPath;
+    }
+    GridRect all = {0, 0, nav.width() - 1, nav.height() - 1};
+    const int gx = int(goal % w), gy = int(goal / w);
+    run(nav, start, goal, bounds ? *bounds : all, [&](uint32_t t) {
+        return gridOctile(int(t % w) - gx, int(t / w) - gy);
+    });
+    if (stamp[goal] != search_ || !closed[goal]) {
+        return kNoPath;
+    }
+    for (uint32_t t = goal; t != start; t = parent[t]) {
+        path.push_back(t);
+    }
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return g[goal];
+}
+
+void GridAStar::distances(const NavGrid& nav, uint32_t start, const GridRect& bounds,
+                          const uint32_t* targets, size_t count, uint32_t* out) {
+    prepare(nav);
+    if (nav.cost(start) != NavGrid::kBlocked) {
+        // no goal and no heuristic: a bounded Dijkstra flood
+        run(nav, start, kNoPath, bounds, [](uint32_t) { return 0u; });
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t t = targets[i];
+        out[i] = (stamp[t] == search_ && closed[t]) ? g[t] : kNoPath;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef GRIDASTAR_HPP
+#define GRIDASTAR_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <utility>
+# include <vector>
+# include "NavGrid.hpp"
+
+// Inclusive tile rectangle that bounds a search.
+struct GridRect {
+    int x0, y0, x1, y1;
+    bool contains(int x, int y) const { return x >= x0 && y >= y0 && x <= x1 && y <= y1; }
+};
+
+// Movement cost between neighbouring tiles, shared by every grid search so
+// their path costs are comparable: the mean of both tile costs times 10
+// for a straight step or 14 for a diagonal. It is symmetric, so a path
+// costs the same in both directions. Diagonals may not cut a blocked
+// corner.
+inline uint32_t gridStepCost(uint8_t from, uint8_t to, bool diagonal) {
+    return (diagonal ? 7u : 5u) * (uint32_t(from) + uint32_t(to));
+}
+
+// Admissible for gridStepCost (tile cost >= 1): the octile distance.
+inline uint32_t gridOctile(int dx, int dy) {
+    dx = dx < 0 ? -dx : dx;
+    dy = dy < 0 ? -dy : dy;
+    int lo = dx < dy ? dx : dy;
+    return uint32_t(10 * (dx + dy) - 6 * lo);
+}
+
+// Plain 8-connected A* over a NavGrid. Per-tile bookkeeping lives in
+// arrays stamped with a search id, so nothing is cleared between queries.
+class GridAStar {
+public:
+    static constexpr uint32_t kNoPath = 0xFFFFFFFFu;
+
+    // Cheapest path from start to goal; `path` receives the tiles from
+    // start to goal inclusive. With `bounds` the search never leaves that
+    // rectangle. Returns the path cost or kNoPath.
+    uint32_t search(const NavGrid& nav, uint32_t start, uint32_t goal, std::vector<uint32_t>& path,
+                    const GridRect* bounds = nullptr);
+
+    // Dijkstra from start inside bounds; out[i] is the cost to targets[i]
+    // or kNoPath.
+    void distances(const NavGrid& nav, uint32_t start, const GridRect& bounds,
+                   const uint32_t* targets, size_t count, uint32_t* out);
+
+    size_t expanded = 0; // nodes closed by the last call
+
+private:
+    void prepare(const NavGrid& nav);
+    template <typename Heuristic>
+    void run(const NavGrid& nav, uint32_t start, uint32_t goal, const GridRect& bounds, Heuristic h);
+
+    std::vector<uint32_t> g;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp; // == search when g/parent are valid for it
+    std::vector<uint8_t> closed;
+    std::vector<std::pair<uint32_t, uint32_t>> open; // (f, tile) min-heap
+    uint32_t search_ = 0;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "Heightfield.hpp"
+#include <algorithm>
+#include <cmath>
+
+void Heightfield::create(int cellsX, int cellsZ, float spacing, float ox, float oz) {
+    tilesX = std::max(1, (cellsX + kTile - 1) / kTile);
+    tilesZ = std::max(1, (cellsZ + kTile - 1) / kTile);
+    cellSize = spacing;
+    invCell = 1.0f / spacing;
+    originX = ox;
+    originZ = oz;
+    tiles.assign(size_t(tilesX) * tilesZ * kTileSamples * kTileSamples, 0.0f);
+}
+
+void Heightfield::setHeight(int sx, int sz, float h) {
+    // A sample on a tile edge lives in up to four tiles
+    int tx0 = sx / kTile, tz0 = sz / kTile;
+    for (int tz = tz0 - 1; tz <= tz0; ++tz) {
+        for (int tx = tx0 - 1; tx <= tx0; ++tx) {
+            if (tx < 0 || tz < 0 || tx >= tilesX || tz >= tilesZ) {
+                continue;
+            }
+            int lx = sx - tx * kTile;
+            int lz = sz - tz * kTile;
+            if (lx < 0 || lz < 0 || lx > kTile || lz > kTile) {
+                continue;
+            }
+            tile(tx, tz)[lz * kTileSamples + lx] = h;
+        }
+    }
+}
+
+float Heightfield::sample(int sx, int sz) const {
+    sx = std::clamp(sx, 0, cellsX());
+    sz = std::clamp(sz, 0, cellsZ());
+    int tx = std::min(sx / kTile, tilesX - 1);
+    int tz = std::min(sz / kTile, tilesZ - 1);
+    return tile(tx, tz)[(sz - tz * kTile) * kTileSamples + (sx - tx * kTile)];
+}
+
+void Heightfield::generate(uint32_t seed, float amplitude) {
+    float phase = float(seed % 1000) * 0.01f;
+    for (int sz = 0; sz <= cellsZ(); ++sz) {
+        for (int sx = 0; sx <= cellsX(); ++sx) {
+            float x = originX + sx * cellSize;
+            float z = originZ + sz * cellSize;
+            float h = 0.5f * std::sin(x * 0.45f + phase) * std::cos(z * 0.35f - phase)
+                    + 0.3f * std::sin((x + z) * 0.9f + phase * 2.0f)
+                    + 0.2f * std::cos(x * 1.7f - z * 1.3f);
+            setHeight(sx, sz, h * amplitude);
+        }
+    }
+}
+
+float Heightfield::heightAt(float x, float z) const {
+    float out;
+    heightsAt(&x, &z, &out, 1);
+    return out;
+}
+
+void Heightfield::heightsAt(const float* x, const float* z, float* out, size_t count) const {
+    const float maxU = float(cellsX());
+    const float maxV = float(cellsZ());
+    const float* base = tiles.data();
+    const size_t tileStride = size_t(kTileSamples) * kTileSamples;
+    for (size_t i = 0; i < count; ++i) {
+        float u = std::clamp((x[i] - originX) * invCell, 0.0f, maxU);
+        float v = std::clamp((z[i] - originZ) * invCell, 0.0f, maxV);
+        int cu = std::min(int(u), cellsX() - 1);
+        int cv = std::min(int(v), cellsZ() - 1);
+        float fu = u - float(cu);
+        float fv = v - float(cv);
+
+        int tx = cu / kTile;
+        int tz = cv / kTile;
+        const float* t = base + (size_t(tz) * tilesX + tx) * tileStride;
+        const float* row = t + (cv - tz * kTile) * kTileSamples + (cu - tx * kTile);
+        float h00 = row[0];
+        float h10 = row[1];
+        float h01 = row[kTileSamples];
+        float h11 = row[kTileSamples + 1];
+
+        float h0 = h00 + (h10 - h00) * fu;
+        float h1 = h01 + (h11 - h01) * fu;
+        out[i] = h0 + (h1 - h0) * fv;
+    }
+}
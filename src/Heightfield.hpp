@@ -0,0 +1,57 @@
+#ifndef HEIGHTFIELD_HPP
+#define HEIGHTFIELD_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// Regular grid of height samples over the XZ plane, stored in square tiles
+// of kTile x kTile cells. Each tile keeps its own (kTile+1)^2 samples (the
+// shared edge is duplicated), so a bilinear lookup only ever touches one
+// ~1 KB tile.
+class Heightfield {
+public:
+    static constexpr int kTile = 16;
+    static constexpr int kTileSamples = kTile + 1;
+
+    // cellsX/cellsZ are rounded up to whole tiles. The grid covers
+    // [originX, originX + cellsX * spacing] and likewise on Z.
+    void create(int cellsX, int cellsZ, float spacing, float originX, float originZ);
+
+    // Rolling hills from a few octaves of sines; amplitude 0 gives a flat floor.
+    void generate(uint32_t seed, float amplitude);
+
+    void setHeight(int sx, int sz, float h);
+    float sample(int sx, int sz) const;
+
+    // Bilinear height at a world position, clamped to the grid bounds.
+    float heightAt(float x, float z) const;
+    // Batched heightAt: out[i] = heightAt(x[i], z[i]).
+    void heightsAt(const float* x, const float* z, float* out, size_t count) const;
+
+    int cellsX() const { return tilesX * kTile; }
+    int cellsZ() const { return tilesZ * kTile; }
+    float spacing() const { return cellSize; }
+    float minX() const { return originX; }
+    float minZ() const { return originZ; }
+    float maxX() const { return originX + cellsX() * cellSize; }
+    float maxZ() const { return originZ + cellsZ() * cellSize; }
+
+private:
+    const float* tile(int tx, int tz) const {
+        return tiles.data() + (size_t(tz) * tilesX + tx) * kTileSamples * kTileSamples;
+    }
+    float* tile(int tx, int tz) {
+        return tiles.data() + (size_t(tz) * tilesX + tx) * kTileSamples * kTileSamples;
+    }
+
+    int tilesX = 0;
+    int tilesZ = 0;
+    float cellSize = 1.0f;
+    float invCell = 1.0f;
+    float originX = 0.0f;
+    float originZ = 0.0f;
+    std::vector<float> tiles;
+};
+
+#endif
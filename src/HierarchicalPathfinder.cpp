@@ -0,0 +1,400 @@
+#include "HierarchicalPathfinder.hpp"
+#include <algorithm>
+
+// Entrances at least this long get a transition at each end instead of
+// one in the middle.
+static constexpr int kLongEntrance = 6;
+
+// bits in `mark` while syncing
+static constexpr uint8_t kAffected = 1;
+static constexpr uint8_t kEastDirty = 2;
+static constexpr uint8_t kNorthDirty = 4;
+
+static bool heapGreater(const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+    return a.first > b.first;
+}
+
+void HierarchicalPathfinder::build(const NavGrid& grid) {
+    nav = &grid;
+    cursor = grid.changeCursor();
+    width = grid.width();
+    height = grid.height();
+    clustersX = (width + kClusterSize - 1) / kClusterSize;
+    clustersY = (height + kClusterSize - 1) / kClusterSize;
+    const size_t n = size_t(clustersX) * clustersY;
+
+    nodes.clear();
+    freeNodes.clear();
+    clusters.assign(n, Cluster());
+    eastLinks.assign(n, Links());
+    northLinks.assign(n, Links());
+    for (int cy = 0; cy < clustersY; ++cy) {
+        for (int cx = 0; cx < clustersX; ++cx) {
+            GridRect& r = clusters[size_t(cy) * clustersX + cx].rect;
+            r.x0 = cx * kClusterSize;
+            r.y0 = cy * kClusterSize;
+            r.x1 = std::min(r.x0 + kClusterSize, width) - 1;
+            r.y1 = std::min(r.y0 + kClusterSize, height) - 1;
+        }
+    }
+    for (uint32_t c = 0; c < n; ++c) {
+        buildEastBorder(c);
+        buildNorthBorder(c);
+    }
+    for (uint32_t c = 0; c < n; ++c) {
+        buildIntraEdges(c);
+    }
+    clustersRebuilt = n;
+}
+
+void HierarchicalPathfinder::sync() {
+    if (!nav) {
+        return;
+    }
+    const uint32_t* tiles = nullptr;
+    size_t count = 0;
+    if (!nav->changesSince(cursor, tiles, count) || nav->width() != width || nav->height() != height) {
+        build(*nav);
+        return;
+    }
+    cursor = nav->changeCursor();
+    clustersRebuilt = 0;
+    if (count == 0) {
+        return;
+    }
+
+    // A changed tile invalidates its cluster's internal costs, and the
+    // entrances of any border it lies on.
+    mark.assign(clusters.size(), 0);
+    affected.clear();
+    auto touch = [&](uint32_t c) {
+        if (!(mark[c] & kAffected)) {
+            mark[c] |= kAffected;
+            affected.push_back(c);
+        }
+    };
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t c = clusterOf(tiles[i]);
+        int x = int(tiles[i] % uint32_t(width)), y = int(tiles[i] / uint32_t(width));
+        const GridRect& r = clusters[c].rect;
+        touch(c);
+        if (x == r.x1 && r.x1 + 1 < width) {
+            mark[c] |= kEastDirty;
+            touch(c + 1);
+        }
+        if (x == r.x0 && x > 0) {
+            mark[c - 1] |= kEastDirty;
+            touch(c - 1);
+        }
+        if (y == r.y1 && r.y1 + 1 < height) {
+            mark[c] |= kNorthDirty;
+            touch(c + clustersX);
+        }
+        if (y == r.y0 && y > 0) {
+            mark[c - clustersX] |= kNorthDirty;
+            touch(c - clustersX);
+        }
+    }
+
+    // Intra edges go first so no edge outlives a node freed below.
+    for (uint32_t c : affected) {
+        stripIntraEdges(c);
+    }
+    for (uint32_t c : affected) {
+        if (mark[c] & kEastDirty) {
+            clearBorder(eastLinks[c]);
+            buildEastBorder(c);
+        }
+        if (mark[c] & kNorthDirty) {
+            clearBorder(northLinks[c]);
+            buildNorthBorder(c);
+        }
+    }
+    for (uint32_t c : affected) {
+        buildIntraEdges(c);
+    }
+    clustersRebuilt = affected.size();
+}
+
+size_t HierarchicalPathfinder::edgeCount() const {
+    size_t total = 0;
+    for (const Node& n : nodes) {
+        total += n.edges.size();
+    }
+    return total;
+}
+
+uint32_t HierarchicalPathfinder::acquireNode(uint32_t tile, uint32_t cluster) {
+    for (uint32_t id : clusters[cluster].nodes) {
+        if (nodes[id].tile == tile) {
+            ++nodes[id].refs;
+            return id;
+        }
+    }
+    uint32_t id;
+    if (!freeNodes.empty()) {
+        id = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        id = uint32_t(nodes.size());
+        nodes.emplace_back();
+    }
+    Node& n = nodes[id];
+    n.tile = tile;
+    n.cluster = cluster;
+    n.refs = 1;
+    n.edges.clear();
+    clusters[cluster].nodes.push_back(id);
+    return id;
+}
+
+void HierarchicalPathfinder::releaseNode(uint32_t id) {
+    Node& n = nodes[id];
+    if (--n.refs > 0) {
+        return;
+    }
+    std::vector<uint32_t>& list = clusters[n.cluster].nodes;
+    list.erase(std::find(list.begin(), list.end(), id));
+    n.edges.clear();
+    freeNodes.push_back(id);
+}
+
+void HierarchicalPathfinder::link(Links& links, uint32_t tileA, uint32_t tileB) {
+    uint32_t a = acquireNode(tileA, clusterOf(tileA));
+    uint32_t b = acquireNode(tileB, clusterOf(tileB));
+    uint32_t cost = gridStepCost(nav->cost(tileA), nav->cost(tileB), false);
+    nodes[a].edges.push_back({b, cost});
+    nodes[b].edges.push_back({a, cost});
+    links.push_back({a, b});
+}
+
+void HierarchicalPathfinder::clearBorder(Links& links) {
+    for (const auto& l : links) {
+        for (int side = 0; side < 2; ++side) {
+            uint32_t from = side ? l.second : l.first;
+            uint32_t to = side ? l.first : l.second;
+            std::vector<Edge>& edges = nodes[from].edges;
+            edges.erase(std::find_if(edges.begin(), edges.end(), [&](const Edge& e) { return e.to == to; }));
+        }
+        releaseNode(l.first);
+        releaseNode(l.second);
+    }
+    links.clear();
+}
+
+void HierarchicalPathfinder::buildEastBorder(uint32_t c) {
+    const GridRect& r = clusters[c].rect;
+    const int x = r.x1;
+    if (x + 1 >= width) {
+        return;
+    }
+    // walk the border collecting maximal runs open on both sides
+    int runStart = -1;
+    for (int y = r.y0; y <= r.y1 + 1; ++y) {
+        bool open = y <= r.y1 && nav->walkable(x, y) && nav->walkable(x + 1, y);
+        if (open && runStart < 0) {
+            runStart = y;
+        } else if (!open && runStart >= 0) {
+            int runEnd = y - 1;
+            if (runEnd - runStart + 1 < kLongEntrance) {
+                int m = (runStart + runEnd) / 2;
+                link(eastLinks[c], nav->index(x, m), nav->index(x + 1, m));
+            } else {
+                link(eastLinks[c], nav->index(x, runStart), nav->index(x + 1, runStart));
+                link(eastLinks[c], nav->index(x, runEnd), nav->index(x + 1, runEnd));
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void HierarchicalPathfinder::buildNorthBorder(uint32_t c) {
+    const GridRect& r = clusters[c].rect;
+    const int y = r.y1;
+    if (y + 1 >= height) {
+        return;
+    }
+    int runStart = -1;
+    for (int x = r.x0; x <= r.x1 + 1; ++x) {
+        bool open = x <= r.x1 && nav->walkable(x, y) && nav->walkable(x, y + 1);
+        if (open && runStart < 0) {
+            runStart = x;
+        } else if (!open && runStart >= 0) {
+            int runEnd = x - 1;
+            if (runEnd - runStart + 1 < kLongEntrance) {
+                int m = (runStart + runEnd) / 2;
+                link(northLinks[c], nav->index(m, y), nav->index(m, y + 1));
+            } else {
+                link(northLinks[c], nav->index(runStart, y), nav->index(runStart, y + 1));
+                link(northLinks[c], nav->index(runEnd, y), nav->index(runEnd, y + 1));
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void HierarchicalPathfinder::stripIntraEdges(uint32_t c) {
+    for (uint32_t id : clusters[c].nodes) {
+        std::vector<Edge>& edges = nodes[id].edges;
+        edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                   [&](const Edge& e) { return nodes[e.to].cluster == c; }),
+                    edges.end());
+    }
+}
+
+void HierarchicalPathfinder::buildIntraEdges(uint32_t c) {
+    const Cluster& cl = clusters[c];
+    const size_t k = cl.nodes.size();
+    targets.resize(k);
+    costs.resize(k);
+    for (size_t i = 0; i < k; ++i) {
+        targets[i] = nodes[cl.nodes[i]].tile;
+    }
+    // costs are symmetric, so one flood per node covers both directions
+    for (size_t i = 0; i + 1 < k; ++i) {
+        local.distances(*nav, targets[i], cl.rect, targets.data() + i + 1, k - i - 1, costs.data());
+        for (size_t j = i + 1; j < k; ++j) {
+            uint32_t cost = costs[j - i - 1];
+            if (cost != kNoPath) {
+                nodes[cl.nodes[i]].edges.push_back({cl.nodes[j], cost});
+                nodes[cl.nodes[j]].edges.push_back({cl.nodes[i], cost});
+            }
+        }
+    }
+}
+
+void HierarchicalPathfinder::refine(uint32_t from, uint32_t to, std::vector<uint32_t>& path, Query& q) const {
+    if (from == to) {
+        return;
+    }
+    uint32_t c = clusterOf(from);
+    if (c != clusterOf(to)) {
+        // an entrance: the two tiles are neighbours
+        path.push_back(to);
+        return;
+    }
+    q.local.search(*nav, from, to, q.segment, &clusters[c].rect);
+    q.expanded += q.local.expanded;
+    path.insert(path.end(), q.segment.begin() + 1, q.segment.end());
+}
+
+uint32_t HierarchicalPathfinder::findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path,
+                                          Query& q) const {
+    path.clear();
+    q.abstractExpanded = 0;
+    q.expanded = 0;
+    if (!nav || nav->cost(start) == NavGrid::kBlocked || nav->cost(goal) == NavGrid::kBlocked) {
+        return kNoPath;
+    }
+    const uint32_t cs = clusterOf(start), cg = clusterOf(goal);
+    if (cs == cg) {
+        uint32_t cost = q.local.search(*nav, start, goal, path, &clusters[cs].rect);
+        q.expanded += q.local.expanded;
+        if (cost != kNoPath) {
+            return cost;
+        }
+    }
+
+    // Start and goal join the graph through their costs to the nodes of
+    // their own cluster, as two virtual nodes past the end of `nodes`.
+    const Cluster& startCluster = clusters[cs];
+    const Cluster& goalCluster = clusters[cg];
+    q.targets.resize(startCluster.nodes.size());
+    q.startCost.resize(q.targets.size());
+    for (size_t i = 0; i < q.targets.size(); ++i) {
+        q.targets[i] = nodes[startCluster.nodes[i]].tile;
+    }
+    q.local.distances(*nav, start, startCluster.rect, q.targets.data(), q.targets.size(), q.startCost.data());
+    q.expanded += q.local.expanded;
+    q.targets.resize(goalCluster.nodes.size());
+    q.goalCost.resize(q.targets.size());
+    for (size_t i = 0; i < q.targets.size(); ++i) {
+        q.targets[i] = nodes[goalCluster.nodes[i]].tile;
+    }
+    q.local.distances(*nav, goal, goalCluster.rect, q.targets.data(), q.targets.size(), q.goalCost.data());
+    q.expanded += q.local.expanded;
+
+    const uint32_t vs = uint32_t(nodes.size()), vg = vs + 1;
+    if (q.stamp.size() < nodes.size() + 2) {
+        q.g.resize(nodes.size() + 2);
+        q.parent.resize(nodes.size() + 2);
+        q.stamp.resize(nodes.size() + 2, 0);
+        q.closed.resize(nodes.size() + 2);
+    }
+    if (++q.search == 0) {
+        std::fill(q.stamp.begin(), q.stamp.end(), 0);
+        q.search = 1;
+    }
+    const int gx = int(goal % uint32_t(width)), gy = int(goal / uint32_t(width));
+    auto tileOf = [&](uint32_t n) { return n == vs ? start : n == vg ? goal : nodes[n].tile; };
+    auto h = [&](uint32_t n) {
+        uint32_t t = tileOf(n);
+        return gridOctile(int(t % uint32_t(width)) - gx, int(t / uint32_t(width)) - gy);
+    };
+    auto relax = [&](uint32_t from, uint32_t to, uint32_t cost) {
+        uint32_t ng = q.g[from] + cost;
+        if (q.stamp[to] != q.search) {
+            q.stamp[to] = q.search;
+            q.closed[to] = 0;
+        } else if (q.closed[to] || ng >= q.g[to]) {
+            return;
+        }
+        q.g[to] = ng;
+        q.parent[to] = from;
+        q.open.push_back({ng + h(to), to});
+        std::push_heap(q.open.begin(), q.open.end(), heapGreater);
+    };
+
+    q.open.clear();
+    q.stamp[vs] = q.search;
+    q.closed[vs] = 0;
+    q.g[vs] = 0;
+    q.parent[vs] = vs;
+    q.open.push_back({h(vs), vs});
+    while (!q.open.empty()) {
+        std::pop_heap(q.open.begin(), q.open.end(), heapGreater);
+        uint32_t n = q.open.back().second;
+        q.open.pop_back();
+        if (q.closed[n]) {
+            continue;
+        }
+        q.closed[n] = 1;
+        ++q.abstractExpanded;
+        if (n == vg) {
+            break;
+        }
+        if (n == vs) {
+            for (size_t i = 0; i < startCluster.nodes.size(); ++i) {
+                if (q.startCost[i] != kNoPath) {
+                    relax(n, startCluster.nodes[i], q.startCost[i]);
+                }
+            }
+            continue;
+        }
+        for (const Edge& e : nodes[n].edges) {
+            relax(n, e.to, e.cost);
+        }
+        if (nodes[n].cluster == cg) {
+            size_t i = std::find(goalCluster.nodes.begin(), goalCluster.nodes.end(), n) - goalCluster.nodes.begin();
+            if (q.goalCost[i] != kNoPath) {
+                relax(n, vg, q.goalCost[i]);
+            }
+        }
+    }
+    q.expanded += q.abstractExpanded;
+    if (q.stamp[vg] != q.search || !q.closed[vg]) {
+        return kNoPath;
+    }
+
+    q.chain.clear();
+    for (uint32_t n = vg; n != vs; n = q.parent[n]) {
+        q.chain.push_back(n);
+    }
+    q.chain.push_back(vs);
+    std::reverse(q.chain.begin(), q.chain.end());
+    path.push_back(start);
+    for (size_t i = 0; i + 1 < q.chain.size(); ++i) {
+        refine(tileOf(q.chain[i]), tileOf(q.chain[i + 1]), path, q);
+    }
+    return q.g[vg];
+}
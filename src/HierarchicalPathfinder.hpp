@@ -0,0 +1,121 @@
+#ifndef HIERARCHICALPATHFINDER_HPP
+#define HIERARCHICALPATHFINDER_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <utility>
+# include <vector>
+# include "GridAStar.hpp"
+# include "NavGrid.hpp"
+
+// HPA*: the grid is cut into kClusterSize square clusters. Where two
+// clusters share an open stretch of border an entrance joins them with a
+// pair of abstract nodes, and the nodes inside each cluster are linked by
+// their in-cluster path cost. A query searches this small graph and then
+// refines each hop with an A* confined to one cluster.
+//
+// Paths are near-optimal (they cross borders only at entrances). Grid
+// edits only rebuild the clusters they touch plus their neighbours, whose
+// shared borders may have gained or lost entrances.
+class HierarchicalPathfinder {
+public:
+    static constexpr int kClusterSize = 16;
+    static constexpr uint32_t kNoPath = GridAStar::kNoPath;
+
+    void build(const NavGrid& nav);
+
+    // Applies grid edits made since the last build or sync.
+    void sync();
+
+    // Per-caller search state. Queries only read the graph, so threads may
+    // search concurrently with a Query each, as long as nobody builds or
+    // syncs meanwhile.
+    struct Query {
+        GridAStar local;
+        std::vector<uint32_t> g;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> stamp;
+        std::vector<uint8_t> closed;
+        std::vector<std::pair<uint32_t, uint32_t>> open;
+        uint32_t search = 0;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> startCost;
+        std::vector<uint32_t> goalCost;
+        std::vector<uint32_t> chain;
+        std::vector<uint32_t> segment;
+
+        size_t abstractExpanded = 0; // graph nodes closed by the last query
+        size_t expanded = 0;         // plus tiles closed while refining it
+    };
+
+    // Tiles from start to goal inclusive; returns the path cost (in
+    // gridStepCost units) or kNoPath.
+    uint32_t findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path, Query& q) const;
+    uint32_t findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) {
+        uint32_t cost = findPath(start, goal, path, query);
+        abstractExpanded = query.abstractExpanded;
+        expanded = query.expanded;
+        return cost;
+    }
+
+    size_t nodeCount() const { return nodes.size() - freeNodes.size(); }
+    size_t edgeCount() const;
+
+    size_t abstractExpanded = 0; // by the last findPath() without a Query
+    size_t expanded = 0;
+    size_t clustersRebuilt = 0;  // by the last sync
+
+private:
+    struct Edge {
+        uint32_t to;
+        uint32_t cost;
+    };
+    struct Node {
+        uint32_t tile = 0;
+        uint32_t cluster = 0;
+        uint32_t refs = 0; // entrances using this tile; 0 = free slot
+        std::vector<Edge> edges;
+    };
+    struct Cluster {
+        GridRect rect;
+        std::vector<uint32_t> nodes;
+    };
+    using Links = std::vector<std::pair<uint32_t, uint32_t>>; // node pairs across a border
+
+    uint32_t clusterOf(uint32_t tile) const {
+        uint32_t x = tile % uint32_t(width), y = tile / uint32_t(width);
+        return (y / kClusterSize) * uint32_t(clustersX) + x / kClusterSize;
+    }
+    uint32_t acquireNode(uint32_t tile, uint32_t cluster);
+    void releaseNode(uint32_t node);
+    void link(Links& links, uint32_t tileA, uint32_t tileB);
+    void clearBorder(Links& links);
+    void buildEastBorder(uint32_t cluster);
+    void buildNorthBorder(uint32_t cluster);
+    void stripIntraEdges(uint32_t cluster);
+    void buildIntraEdges(uint32_t cluster);
+    void refine(uint32_t from, uint32_t to, std::vector<uint32_t>& path, Query& q) const;
+
+    const NavGrid* nav = nullptr;
+    uint64_t cursor = 0;
+    int width = 0;
+    int height = 0;
+    int clustersX = 0;
+    int clustersY = 0;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::vector<Cluster> clusters;
+    std::vector<Links> eastLinks;  // border between cluster c and c + 1
+    std::vector<Links> northLinks; // border between cluster c and c + clustersX
+
+    // build and sync scratch
+    GridAStar local;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> costs;
+    std::vector<uint8_t> mark;
+    std::vector<uint32_t> affected;
+
+    Query query; // for findPath() without a Query
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "JobSystem.hpp"
+
+namespace {
+thread_local const JobSystem* tlsOwner = nullptr;
+thread_local unsigned tlsIndex = 0;
+}
+
+void WorkDeque::store(Slot& s, const Job& job) {
+    s.fn.store(job.fn, std::memory_order_relaxed);
+    s.context.store(job.context, std::memory_order_relaxed);
+    s.begin.store(job.begin, std::memory_order_relaxed);
+    s.end.store(job.end, std::memory_order_relaxed);
+    s.counter.store(job.counter, std::memory_order_relaxed);
+}
+
+Job WorkDeque::load(const Slot& s) {
+    Job job;
+    job.fn = s.fn.load(std::memory_order_relaxed);
+    job.context = s.context.load(std::memory_order_relaxed);
+    job.begin = s.begin.load(std::memory_order_relaxed);
+    job.end = s.end.load(std::memory_order_relaxed);
+    job.counter = s.counter.load(std::memory_order_relaxed);
+    return job;
+}
+
+bool WorkDeque::push(const Job& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= kCapacity) {
+        return false;
+    }
+    store(buffer[b & (kCapacity - 1)], job);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkDeque::pop(Job& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        // empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    job = load(buffer[b & (kCapacity - 1)]);
+    if (t == b) {
+        // last element: race against thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+bool WorkDeque::steal(Job& job) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    // copied before the claim: once it succeeds the owner may reuse the slot
+    Job copy = load(buffer[t & (kCapacity - 1)]);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+        return false;
+    }
+    job = copy;
+    return true;
+}
+
+JobSystem::JobSystem(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        auto q = std::make_unique<ThreadQueue>();
+        q->rng = 0x9E3779B9u * (i + 1);
+        queues.push_back(std::move(q));
+    }
+
+    tlsOwner = this;
+    tlsIndex = 0;
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        quit.store(true);
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    if (tlsOwner == this) {
+        tlsOwner = nullptr;
+    }
+}
+
+unsigned JobSystem::currentIndex() const {
+    // Threads outside the pool share the main thread's queue; only the
+    // thread that created the JobSystem should schedule from outside jobs.
+    return tlsOwner == this ? tlsIndex : 0;
+}
+
+void JobSystem::schedule(void (*fn)(const Job&), const void* context, JobCounter* counter,
+                         JobCounter* after) {
+    Job job;
+    job.fn = fn;
+    job.context = context;
+    job.counter = counter;
+    submit(job, after);
+}
+
+void JobSystem::submit(const Job& job, JobCounter* after) {
+    if (job.counter) {
+        job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (after) {
+        std::lock_guard<std::mutex> lock(after->mutex);
+        if (after->pending.load(std::memory_order_acquire) > 0) {
+            after->continuations.push_back(job);
+            return;
+        }
+    }
+    push(job);
+}
+
+void JobSystem::push(const Job& job) {
+    ThreadQueue& q = *queues[currentIndex()];
+    if (!q.deque.push(job)) {
+        // deque full: run it right here instead of dropping it
+        execute(job);
+        return;
+    }
+    // Pairs with the sleepers increment in workerLoop: either the worker
+    // sees this job before it sleeps, or we see it asleep and wake it.
+    // Taking the mutex means it is inside wait() before we notify.
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::findJob(unsigned self, Job& job) {
+    ThreadQueue& q = *queues[self];
+    bool found = q.deque.pop(job);
+    if (!found) {
+        unsigned n = static_cast<unsigned>(queues.size());
+        // xorshift to pick a random victim, then scan the rest
+        q.rng ^= q.rng << 13;
+        q.rng ^= q.rng >> 17;
+        q.rng ^= q.rng << 5;
+        unsigned start = q.rng % n;
+        for (unsigned k = 0; k < n && !found; ++k) {
+            unsigned victim = (start + k) % n;
+            if (victim != self) {
+                found = queues[victim]->deque.steal(job);
+            }
+        }
+    }
+    if (found) {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+void JobSystem::execute(const Job& job) {
+    job.fn(job);
+
+    JobCounter* counter = job.counter;
+    if (!counter) {
+        return;
+    }
+    // Decrements that cannot reach zero skip the lock.
+    int n = counter->pending.load(std::memory_order_relaxed);
+    while (n > 1) {
+        if (counter->pending.compare_exchange_weak(n, n - 1, std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    // The last one publishes zero and takes the continuations under the
+    // mutex; wait() takes it too before returning, so the counter is not
+    // touched again once it is unlocked.
+    std::vector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+    for (const Job& next : ready) {
+        push(next);
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    unsigned self = currentIndex();
+    Job job;
+    while (!counter.done()) {
+        if (findJob(self, job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    // the thread that reached zero may still hold the counter's mutex
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    tlsOwner = this;
+    tlsIndex = index;
+    int idle = 0;
+    Job job;
+    while (!quit.load(std::memory_order_acquire)) {
+        if (findJob(index, job)) {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [this] {
+            return quit.load(std::memory_order_acquire) ||
+                   queued.load(std::memory_order_seq_cst) > 0;
+        });
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
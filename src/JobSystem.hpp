@@ -0,0 +1,141 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+# include <atomic>
+# include <condition_variable>
+# include <cstddef>
+# include <cstdint>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+struct JobCounter;
+
+// A unit of work. fn receives the job itself so ranged jobs can read
+// begin/end and the type-erased context.
+struct Job {
+    void (*fn)(const Job&) = nullptr;
+    const void* context = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+    JobCounter* counter = nullptr;
+};
+
+// Counts outstanding jobs. Jobs scheduled with this counter as their
+// dependency are held back and pushed by whichever thread finishes the
+// last outstanding job. The last decrement happens under the mutex, so
+// JobSystem::wait() can tell when the counter is safe to destroy.
+struct JobCounter {
+    std::atomic<int> pending {0};
+    std::mutex mutex;
+    std::vector<Job> continuations;
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Chase-Lev work-stealing deque of fixed capacity. The owning thread pushes
+// and pops at the bottom; other threads steal from the top. Jobs are held
+// by value, one relaxed atomic per field: a thief copies its slot before
+// claiming it, and the slot can only be reused once top has moved past
+// it, which makes that claim fail.
+class WorkDeque {
+public:
+    static constexpr int64_t kCapacity = 4096;
+
+    bool push(const Job& job);
+    bool pop(Job& job);
+    bool steal(Job& job);
+
+private:
+    struct Slot {
+        std::atomic<void (*)(const Job&)> fn {nullptr};
+        std::atomic<const void*> context {nullptr};
+        std::atomic<size_t> begin {0};
+        std::atomic<size_t> end {0};
+        std::atomic<JobCounter*> counter {nullptr};
+    };
+    static void store(Slot& s, const Job& job);
+    static Job load(const Slot& s);
+
+    alignas(64) std::atomic<int64_t> top {0};
+    alignas(64) std::atomic<int64_t> bottom {0};
+    std::unique_ptr<Slot[]> buffer {new Slot[kCapacity]};
+};
+
+class JobSystem {
+public:
+    // threadCount includes the calling thread, which becomes worker 0 and
+    // helps execute jobs inside wait(). 0 picks hardware_concurrency.
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    // Queues a job that signals `counter` when done. If `after` is given the
+    // job only becomes runnable once `after` reaches zero.
+    void schedule(void (*fn)(const Job&), const void* context, JobCounter* counter,
+                  JobCounter* after = nullptr);
+
+    // Splits [begin, end) into chunks of at least `grain` items and runs
+    // fn(chunkBegin, chunkEnd) on them across all threads. Chunk sizes stay
+    // a multiple of grain, so chunks never straddle a grain boundary. fn
+    // must stay alive until wait(counter) returns.
+    template <typename F>
+    void parallelFor(JobCounter& counter, size_t begin, size_t end, size_t grain, const F& fn,
+                     JobCounter* after = nullptr) {
+        if (end <= begin) {
+            return;
+        }
+        size_t n = end - begin;
+        if (grain == 0) {
+            grain = 1;
+        }
+        if ((n + grain - 1) / grain > kMaxChunks) {
+            size_t minChunk = (n + kMaxChunks - 1) / kMaxChunks;
+            grain *= (minChunk + grain - 1) / grain;
+        }
+        for (size_t b = begin; b < end; b += grain) {
+            size_t e = (end - b > grain) ? b + grain : end;
+            Job job;
+            job.fn = [](const Job& j) { (*static_cast<const F*>(j.context))(j.begin, j.end); };
+            job.context = &fn;
+            job.begin = b;
+            job.end = e;
+            job.counter = &counter;
+            submit(job, after);
+        }
+    }
+
+    // Runs queued jobs on the calling thread until `counter` reaches zero.
+    void wait(JobCounter& counter);
+
+private:
+    static constexpr size_t kMaxChunks = 1024;
+
+    struct alignas(64) ThreadQueue {
+        WorkDeque deque;
+        uint32_t rng = 0;
+    };
+
+    void submit(const Job& job, JobCounter* after);
+    void push(const Job& job);
+    bool findJob(unsigned self, Job& job);
+    void execute(const Job& job);
+    void workerLoop(unsigned index);
+    unsigned currentIndex() const;
+
+    std::vector<std::unique_ptr<ThreadQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued {0};
+    std::atomic<int> sleepers {0}; // workers inside wake.wait()
+    std::atomic<bool> quit {false};
+};
+
+#endif
@@ -0,0 +1,319 @@
+#include "JumpPointSearch.hpp"
+#include "GridAStar.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+static const int kDx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int kDy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+static constexpr int kMaxJump = 127;
+// wall further than kMaxJump: hop kMaxJump tiles and look again
+static constexpr int8_t kFar = -128;
+
+static bool heapGreater(const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+    return a.first > b.first;
+}
+
+// One step further from whatever `next` measured, capped.
+static int8_t extend(int8_t next) {
+    if (next > 0) {
+        return next == kMaxJump ? next : int8_t(next + 1);
+    }
+    return next == kFar ? next : int8_t(next - 1);
+}
+
+// Entered travelling straight in direction d, the tile has a neighbour
+// that can only be reached optimally through it. Diagonals may not cut
+// corners, so that is a side tile open here but blocked one step back.
+bool JumpPointSearch::forced(int x, int y, int d) const {
+    int px = x - kDx[d], py = y - kDy[d];
+    if (!open(px, py)) {
+        return false;
+    }
+    int sx = -kDy[d], sy = kDx[d];
+    return (open(x + sx, y + sy) && !open(px + sx, py + sy)) ||
+           (open(x - sx, y - sy) && !open(px - sx, py - sy));
+}
+
+int8_t JumpPointSearch::straightValue(int x, int y, int d) {
+    int nx = x + kDx[d], ny = y + kDy[d];
+    if (!open(x, y) || !open(nx, ny)) {
+        return 0;
+    }
+    if (forced(nx, ny, d)) {
+        return 1;
+    }
+    return extend(at(nx, ny, d));
+}
+
+int8_t JumpPointSearch::diagonalValue(int x, int y, int d) {
+    int nx = x + kDx[d], ny = y + kDy[d];
+    if (!open(x, y) || !open(nx, ny) || !open(nx, y) || !open(x, ny)) {
+        return 0;
+    }
+    // stop wherever either straight component leads to a jump point
+    if (at(nx, ny, d - 1) > 0 || at(nx, ny, (d + 1) & 7) > 0) {
+        return 1;
+    }
+    return extend(at(nx, ny, d));
+}
+
+void JumpPointSearch::buildRow(int y) {
+    for (int x = width - 1; x >= 0; --x) {
+        at(x, y, 0) = straightValue(x, y, 0);
+    }
+    for (int x = 0; x < width; ++x) {
+        at(x, y, 4) = straightValue(x, y, 4);
+    }
+}
+
+void JumpPointSearch::buildColumn(int x) {
+    for (int y = height - 1; y >= 0; --y) {
+        at(x, y, 2) = straightValue(x, y, 2);
+    }
+    for (int y = 0; y < height; ++y) {
+        at(x, y, 6) = straightValue(x, y, 6);
+    }
+}
+
+void JumpPointSearch::buildDiagonal(int d) {
+    // sweep against the direction so the next tile is always done first
+    int ys = kDy[d] > 0 ? height - 1 : 0, ye = kDy[d] > 0 ? -1 : height;
+    int xs = kDx[d] > 0 ? width - 1 : 0, xe = kDx[d] > 0 ? -1 : width;
+    for (int y = ys; y != ye; y -= kDy[d]) {
+        for (int x = xs; x != xe; x -= kDx[d]) {
+            at(x, y, d) = diagonalValue(x, y, d);
+        }
+    }
+}
+
+void JumpPointSearch::build(const NavGrid& grid) {
+    nav = &grid;
+    cursor = grid.changeCursor();
+    width = grid.width();
+    height = grid.height();
+    jump.assign(size_t(width) * height * 8, 0);
+    for (int y = 0; y < height; ++y) {
+        buildRow(y);
+    }
+    for (int x = 0; x < width; ++x) {
+        buildColumn(x);
+    }
+    for (int d = 1; d < 8; d += 2) {
+        buildDiagonal(d);
+    }
+    tilesUpdated = jump.size() / 2;
+}
+
+void JumpPointSearch::sync() {
+    if (!nav) {
+        return;
+    }
+    const uint32_t* tiles = nullptr;
+    size_t count = 0;
+    if (!nav->changesSince(cursor, tiles, count) || nav->width() != width || nav->height() != height) {
+        build(*nav);
+        return;
+    }
+    cursor = nav->changeCursor();
+    tilesUpdated = 0;
+    if (count == 0) {
+        return;
+    }
+
+    // A tile's walkability decides jump points on the rows and columns
+    // either side of it.
+    rowMark.assign(size_t(height), 0);
+    columnMark.assign(size_t(width), 0);
+    seeds.clear();
+    for (size_t i = 0; i < count; ++i) {
+        int x = int(tiles[i] % uint32_t(width)), y = int(tiles[i] / uint32_t(width));
+        for (int k = -1; k <= 1; ++k) {
+            if (y + k >= 0 && y + k < height) {
+                rowMark[size_t(y + k)] = 1;
+            }
+            if (x + k >= 0 && x + k < width) {
+                columnMark[size_t(x + k)] = 1;
+            }
+        }
+        seeds.push_back(tiles[i]);
+    }
+
+    // Diagonals only read whether a straight entry is positive, so tiles
+    // where that flipped seed the diagonal update below.
+    auto rebuild = [&](int fixed, bool row) {
+        const int n = row ? width : height;
+        const int d0 = row ? 0 : 2;
+        before.resize(size_t(n) * 2);
+        for (int i = 0; i < n; ++i) {
+            int x = row ? i : fixed, y = row ? fixed : i;
+            before[size_t(i) * 2] = at(x, y, d0);
+            before[size_t(i) * 2 + 1] = at(x, y, d0 + 4);
+        }
+        row ? buildRow(fixed) : buildColumn(fixed);
+        for (int i = 0; i < n; ++i) {
+            int x = row ? i : fixed, y = row ? fixed : i;
+            if ((before[size_t(i) * 2] > 0) != (at(x, y, d0) > 0) ||
+                (before[size_t(i) * 2 + 1] > 0) != (at(x, y, d0 + 4) > 0)) {
+                seeds.push_back(nav->index(x, y));
+            }
+        }
+    };
+    for (int y = 0; y < height; ++y) {
+        if (rowMark[size_t(y)]) {
+            rebuild(y, true);
+        }
+    }
+    for (int x = 0; x < width; ++x) {
+        if (columnMark[size_t(x)]) {
+            rebuild(x, false);
+        }
+    }
+
+    // A diagonal entry depends on the 2x2 block ahead of it and on the
+    // entry one step ahead, so walk back from every seed's neighbourhood
+    // until the recomputed value stops changing.
+    for (uint32_t s : seeds) {
+        int sx = int(s % uint32_t(width)), sy = int(s / uint32_t(width));
+        for (int d = 1; d < 8; d += 2) {
+            for (int oy = -1; oy <= 1; ++oy) {
+                for (int ox = -1; ox <= 1; ++ox) {
+                    int x = sx + ox, y = sy + oy;
+                    while (nav->inside(x, y)) {
+                        int8_t v = diagonalValue(x, y, d);
+                        if (v == at(x, y, d)) {
+                            break;
+                        }
+                        at(x, y, d) = v;
+                        ++tilesUpdated;
+                        x -= kDx[d];
+                        y -= kDy[d];
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint32_t JumpPointSearch::findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) {
+    path.clear();
+    expanded = 0;
+    pushes = 0;
+    if (!nav || nav->cost(start) == NavGrid::kBlocked || nav->cost(goal) == NavGrid::kBlocked) {
+        return kNoPath;
+    }
+    const size_t n = size_t(width) * height;
+    if (g.size() != n) {
+        g.assign(n, 0);
+        parent.assign(n, 0);
+        stamp.assign(n, 0);
+        closed.assign(n, 0);
+        arrival.assign(n, 0);
+        search = 0;
+    }
+    if (++search == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        search = 1;
+    }
+
+    const uint32_t w = uint32_t(width);
+    const int gx = int(goal % w), gy = int(goal / w);
+    auto relax = [&](uint32_t from, uint32_t to, uint32_t cost, uint8_t dir) {
+        uint32_t ng = g[from] + cost;
+        if (stamp[to] != search) {
+            stamp[to] = search;
+            closed[to] = 0;
+        } else if (closed[to] || ng >= g[to]) {
+            return;
+        }
+        g[to] = ng;
+        parent[to] = from;
+        arrival[to] = dir;
+        heap.push_back({ng + gridOctile(int(to % w) - gx, int(to / w) - gy), to});
+        std::push_heap(heap.begin(), heap.end(), heapGreater);
+        ++pushes;
+    };
+
+    heap.clear();
+    stamp[start] = search;
+    closed[start] = 0;
+    g[start] = 0;
+    parent[start] = start;
+    arrival[start] = 8;
+    heap.push_back({0, start});
+    ++pushes;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), heapGreater);
+        uint32_t t = heap.back().second;
+        heap.pop_back();
+        if (closed[t]) {
+            continue;
+        }
+        closed[t] = 1;
+        ++expanded;
+        if (t == goal) {
+            break;
+        }
+        const int x = int(t % w), y = int(t / w);
+        const int ddx = gx - x, ddy = gy - y;
+        // straight arrivals may turn up to 90 degrees at a jump point,
+        // diagonal ones keep to their own quadrant
+        int first = 0, last = 7;
+        if (arrival[t] != 8) {
+            int spread = (arrival[t] & 1) ? 1 : 2;
+            first = arrival[t] - spread;
+            last = arrival[t] + spread;
+        }
+        const int8_t* entry = &jump[size_t(t) * 8];
+        for (int k = first; k <= last; ++k) {
+            const int d = k & 7;
+            const int8_t v = entry[d];
+            const int reach = v > 0 ? v : (v == kFar ? kMaxJump : -v);
+            if (reach == 0) {
+                continue;
+            }
+            const bool hops = v > 0 || v == kFar;
+            int steps;
+            if (!(d & 1)) {
+                // goal straight ahead and before the jump point or wall
+                bool ahead = kDx[d] ? (ddy == 0 && ddx * kDx[d] > 0) : (ddx == 0 && ddy * kDy[d] > 0);
+                int dist = std::abs(ddx) + std::abs(ddy);
+                if (ahead && dist <= reach) {
+                    steps = dist;
+                } else if (hops) {
+                    steps = reach;
+                } else {
+                    continue;
+                }
+                relax(t, nav->index(x + kDx[d] * steps, y + kDy[d] * steps), 10u * uint32_t(steps), uint8_t(d));
+            } else {
+                // goal in this quadrant: stop where it lines up with a row or column
+                int lineUp = std::min(std::abs(ddx), std::abs(ddy));
+                if (ddx * kDx[d] > 0 && ddy * kDy[d] > 0 && lineUp <= reach) {
+                    steps = lineUp;
+                } else if (hops) {
+                    steps = reach;
+                } else {
+                    continue;
+                }
+                relax(t, nav->index(x + kDx[d] * steps, y + kDy[d] * steps), 14u * uint32_t(steps), uint8_t(d));
+            }
+        }
+    }
+    if (stamp[goal] != search || !closed[goal]) {
+        return kNoPath;
+    }
+
+    // jump points are joined by straight or diagonal runs
+    for (uint32_t t = goal; t != start; t = parent[t]) {
+        int x = int(t % w), y = int(t / w);
+        int px = int(parent[t] % w), py = int(parent[t] / w);
+        int sx = (px > x) - (px < x), sy = (py > y) - (py < y);
+        for (; x != px || y != py; x += sx, y += sy) {
+            path.push_back(nav->index(x, y));
+        }
+    }
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return g[goal];
+}
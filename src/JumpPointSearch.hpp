@@ -0,0 +1,73 @@
+#ifndef JUMPPOINTSEARCH_HPP
+#define JUMPPOINTSEARCH_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <utility>
+# include <vector>
+# include "NavGrid.hpp"
+
+// JPS+ for uniform-cost terrain: every walkable tile counts as cost 1 and
+// only walkability is read from the NavGrid, so this shares the grid with
+// the other pathfinders without a copy. Returned costs use the
+// gridStepCost units (10 straight, 14 diagonal).
+//
+// For each tile and each of the 8 directions (E, NE, N, NW, W, SW, S, SE)
+// a signed byte is precomputed: > 0 is the distance to the next jump
+// point, <= 0 minus the number of open steps before a wall. Runs longer
+// than 127 are capped and the search simply stops partway, so 8 bytes per
+// tile cover any map size. A query then hops between jump points and only
+// jump points touch the heap.
+class JumpPointSearch {
+public:
+    static constexpr uint32_t kNoPath = 0xFFFFFFFFu;
+
+    void build(const NavGrid& nav);
+
+    // Applies grid edits since the last build or sync: straight distances
+    // are recomputed on the rows and columns next to each edit, diagonal
+    // ones only as far as they actually change.
+    void sync();
+
+    uint32_t findPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+
+    // Precomputed distances, 8 per tile.
+    const std::vector<int8_t>& table() const { return jump; }
+
+    size_t expanded = 0;     // jump points closed by the last query
+    size_t pushes = 0;       // heap pushes by the last query
+    size_t tilesUpdated = 0; // diagonal entries changed by the last sync
+
+private:
+    bool open(int x, int y) const { return nav->walkable(x, y); }
+    int8_t& at(int x, int y, int d) { return jump[(size_t(y) * width + x) * 8 + d]; }
+    bool forced(int x, int y, int d) const;
+    int8_t straightValue(int x, int y, int d);
+    int8_t diagonalValue(int x, int y, int d);
+    void buildRow(int y);
+    void buildColumn(int x);
+    void buildDiagonal(int d);
+
+    const NavGrid* nav = nullptr;
+    uint64_t cursor = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<int8_t> jump;
+
+    // sync scratch
+    std::vector<uint8_t> rowMark;
+    std::vector<uint8_t> columnMark;
+    std::vector<uint32_t> seeds;
+    std::vector<int8_t> before;
+
+    // query scratch
+    std::vector<uint32_t> g;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> closed;
+    std::vector<uint8_t> arrival; // direction the tile was reached in; 8 = start
+    std::vector<std::pair<uint32_t, uint32_t>> heap; // (f, tile) min-heap
+    uint32_t search = 0;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "Kinematics.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+# define KINEMATICS_X86 1
+# include <immintrin.h>
+#endif
+
+static void integrateScalar(const KinematicsBatch& b, float dt, size_t begin) {
+    for (size_t i = begin; i < b.count; ++i) {
+        kinematicsRow(b.px[i], b.py[i], b.pz[i], b.height[i], b.vx[i], b.vy[i], b.vz[i],
+                      b.gravity[i], b.floorY[i], b.grounded[i], dt);
+    }
+}
+
+#ifdef KINEMATICS_X86
+
+// 4-bit lane mask -> four 0/1 bytes (little endian)
+static const uint32_t kMaskBytes[16] = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101,
+    0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101,
+    0x01010000, 0x01010001, 0x01010100, 0x01010101,
+};
+
+static size_t integrateSSE2(const KinematicsBatch& b, float dt) {
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        __m128 vy = _mm_loadu_ps(b.vy + i);
+        vy = _mm_add_ps(vy, _mm_mul_ps(_mm_loadu_ps(b.gravity + i), vdt));
+        __m128 px = _mm_add_ps(_mm_loadu_ps(b.px + i), _mm_mul_ps(_mm_loadu_ps(b.vx + i), vdt));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(b.py + i), _mm_mul_ps(vy, vdt));
+        __m128 pz = _mm_add_ps(_mm_loadu_ps(b.pz + i), _mm_mul_ps(_mm_loadu_ps(b.vz + i), vdt));
+
+        __m128 halfH = _mm_mul_ps(_mm_loadu_ps(b.height + i), half);
+        __m128 floorY = _mm_loadu_ps(b.floorY + i);
+        __m128 hit = _mm_cmple_ps(_mm_sub_ps(py, halfH), floorY);
+        // blend: hit ? clamped : integrated
+        __m128 clampedY = _mm_add_ps(floorY, halfH);
+        py = _mm_or_ps(_mm_and_ps(hit, clampedY), _mm_andnot_ps(hit, py));
+        vy = _mm_andnot_ps(hit, vy);
+
+        _mm_storeu_ps(b.px + i, px);
+        _mm_storeu_ps(b.py + i, py);
+        _mm_storeu_ps(b.pz + i, pz);
+        _mm_storeu_ps(b.vy + i, vy);
+        uint32_t g = kMaskBytes[_mm_movemask_ps(hit)];
+        std::memcpy(b.grounded + i, &g, sizeof(g));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t integrateAVX2(const KinematicsBatch& b, float dt) {
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        __m256 vy = _mm256_loadu_ps(b.vy + i);
+        vy = _mm256_add_ps(vy, _mm256_mul_ps(_mm256_loadu_ps(b.gravity + i), vdt));
+        __m256 px = _mm256_add_ps(_mm256_loadu_ps(b.px + i), _mm256_mul_ps(_mm256_loadu_ps(b.vx + i), vdt));
+        __m256 py = _mm256_add_ps(_mm256_loadu_ps(b.py + i), _mm256_mul_ps(vy, vdt));
+        __m256 pz = _mm256_add_ps(_mm256_loadu_ps(b.pz + i), _mm256_mul_ps(_mm256_loadu_ps(b.vz + i), vdt));
+
+        __m256 halfH = _mm256_mul_ps(_mm256_loadu_ps(b.height + i), half);
+        __m256 floorY = _mm256_loadu_ps(b.floorY + i);
+        __m256 hit = _mm256_cmp_ps(_mm256_sub_ps(py, halfH), floorY, _CMP_LE_OQ);
+        py = _mm256_blendv_ps(py, _mm256_add_ps(floorY, halfH), hit);
+        vy = _mm256_blendv_ps(vy, zero, hit);
+
+        _mm256_storeu_ps(b.px + i, px);
+        _mm256_storeu_ps(b.py + i, py);
+        _mm256_storeu_ps(b.pz + i, pz);
+        _mm256_storeu_ps(b.vy + i, vy);
+        int mask = _mm256_movemask_ps(hit);
+        uint32_t lo = kMaskBytes[mask & 0xF];
+        uint32_t hi = kMaskBytes[mask >> 4];
+        std::memcpy(b.grounded + i, &lo, sizeof(lo));
+        std::memcpy(b.grounded + i + 4, &hi, sizeof(hi));
+    }
+    return i;
+}
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#ifdef KINEMATICS_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::SSE2;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void integrateKinematics(const KinematicsBatch& batch, float dt, SimdLevel level) {
+    size_t done = 0;
+#ifdef KINEMATICS_X86
+    if (level == SimdLevel::AVX2) {
+        done = integrateAVX2(batch, dt);
+    } else if (level == SimdLevel::SSE2) {
+        done = integrateSSE2(batch, dt);
+    }
+#else
+    (void)level;
+#endif
+    // remainder (and the whole batch on the scalar path)
+    integrateScalar(batch, dt, done);
+}
+
+void integrateKinematics(const KinematicsBatch& batch, float dt) {
+    integrateKinematics(batch, dt, detectSimdLevel());
+}
@@ -0,0 +1,56 @@
+#ifndef KINEMATICS_HPP
+#define KINEMATICS_HPP
+
+# include <cstddef>
+# include <cstdint>
+
+// Column pointers for a contiguous run of entities. The kernel integrates
+// gravity and velocity and clamps to floorY, exactly like the per-entity
+// path in kinematicsRow().
+struct KinematicsBatch {
+    float* px;
+    float* py;
+    float* pz;
+    const float* height;
+    float* vx;
+    float* vy;
+    const float* vz;
+    const float* gravity;
+    const float* floorY;
+    uint8_t* grounded;
+    size_t count;
+};
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Best level supported by the running CPU (detected once).
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// Every level produces bit-identical results: lanes perform the same IEEE
+// operations in the same order and the ground test becomes a masked blend.
+void integrateKinematics(const KinematicsBatch& batch, float dt, SimdLevel level);
+void integrateKinematics(const KinematicsBatch& batch, float dt);
+
+inline void kinematicsRow(float& px, float& py, float& pz, float height,
+                          float& vx, float& vy, float vz, float gravity,
+                          float floorY, uint8_t& grounded, float dt) {
+    // Apply gravity
+    vy += gravity * dt;
+    // Apply velocity
+    px += vx * dt;
+    py += vy * dt;
+    pz += vz * dt;
+
+    // Collision with ground - bottom is at py - height * 0.5f
+    float bottomY = py - height * 0.5f;
+    if (bottomY <= floorY) {
+        py = floorY + height * 0.5f;
+        vy = 0.0f;
+        grounded = 1;
+    } else {
+        grounded = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "LightGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+void LightGrid::resize(int w, int h, int tile) {
+    width = w;
+    height = h;
+    tileSize = tile;
+    tilesX = (w + tile - 1) / tile;
+    tilesY = (h + tile - 1) / tile;
+    tileCounts.assign(size_t(tilesX) * tilesY, 0);
+}
+
+void LightGrid::build(const PointLight* lights, size_t count, const glm::mat4& viewProj) {
+    lightData.clear();
+    rects.clear();
+    indices.clear();
+    tiles.clear();
+    visible = 0;
+    std::fill(tileCounts.begin(), tileCounts.end(), 0);
+
+    // project, cull and count each light's tiles
+    const float halfW = 0.5f * float(width);
+    const float halfH = 0.5f * float(height);
+    for (size_t i = 0; i < count; ++i) {
+        const PointLight& l = lights[i];
+        glm::vec4 c = viewProj * glm::vec4(l.position, 1.0f);
+        if (c.w <= 0.0f) {
+            continue; // behind the camera
+        }
+        float sx = (c.x / c.w + 1.0f) * halfW;
+        float sy = (c.y / c.w + 1.0f) * halfH;
+        // screen radius: the longest projected world axis of the radius
+        float r = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            glm::vec4 e = c + viewProj[axis] * l.radius;
+            if (e.w > 0.0f) {
+                r = std::max(r, std::hypot((e.x / e.w + 1.0f) * halfW - sx, (e.y / e.w + 1.0f) * halfH - sy));
+            }
+        }
+        if (sx + r < 0.0f || sy + r < 0.0f || sx - r >= float(width) || sy - r >= float(height) || r < 0.5f) {
+            continue;
+        }
+        int32_t x0 = std::max(0, int32_t(std::floor((sx - r) / float(tileSize))));
+        int32_t y0 = std::max(0, int32_t(std::floor((sy - r) / float(tileSize))));
+        int32_t x1 = std::min(tilesX - 1, int32_t(std::floor((sx + r) / float(tileSize))));
+        int32_t y1 = std::min(tilesY - 1, int32_t(std::floor((sy + r) / float(tileSize))));
+        for (int32_t ty = y0; ty <= y1; ++ty) {
+            for (int32_t tx = x0; tx <= x1; ++tx) {
+                ++tileCounts[size_t(ty) * tilesX + tx];
+            }
+        }
+        rects.insert(rects.end(), {x0, y0, x1, y1});
+        lightData.insert(lightData.end(), {sx, sy, r, 0.0f, l.color.r, l.color.g, l.color.b, 0.0f});
+        ++visible;
+    }
+
+    // counts -> offsets, listing the lit tiles in row order
+    uint32_t total = 0;
+    for (int32_t ty = 0; ty < tilesY; ++ty) {
+        for (int32_t tx = 0; tx < tilesX; ++tx) {
+            uint32_t& n = tileCounts[size_t(ty) * tilesX + tx];
+            if (n > 0) {
+                tiles.push_back(LightTile{uint32_t(tx), uint32_t(ty), total, n});
+            }
+            uint32_t first = total;
+            total += n;
+            n = first;
+        }
+    }
+
+    // scatter the light indices; each tile's offset walks to its end
+    indices.resize(total);
+    for (size_t v = 0; v < visible; ++v) {
+        const int32_t* rc = &rects[v * 4];
+        for (int32_t ty = rc[1]; ty <= rc[3]; ++ty) {
+            for (int32_t tx = rc[0]; tx <= rc[2]; ++tx) {
+                indices[tileCounts[size_t(ty) * tilesX + tx]++] = uint32_t(v);
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef LIGHTGRID_HPP
+#define LIGHTGRID_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include <glm/glm.hpp>
+
+// A point light in the world; it lights the screen within `radius` world
+// units of its projected centre, fading out quadratically.
+struct PointLight {
+    glm::vec3 position;
+    float radius = 1.0f;
+    glm::vec3 color {1.0f};
+};
+
+// A screen tile with at least one light: its lights are
+// indices[first .. first + count).
+struct LightTile {
+    uint32_t x, y;
+    uint32_t first, count;
+};
+
+// Bins lights into square tiles of a low resolution light buffer. Each
+// visible light is projected to a disc in buffer pixels and added to
+// the list of every tile its bounding square covers; the lists are built
+// with a counting sort into one index array. Only tiles that some light
+// touches are listed, so the light pass shades the lit area and reads
+// just the lights of each pixel's tile.
+class LightGrid {
+public:
+    int width = 0;  // light buffer size in pixels
+    int height = 0;
+    int tileSize = 16;
+    int tilesX = 0;
+    int tilesY = 0;
+
+    // Two RGBA texels per visible light, in buffer pixels:
+    // (x, y, radius, 0) and (r, g, b, 0).
+    std::vector<float> lightData;
+    std::vector<uint32_t> indices;
+    std::vector<LightTile> tiles;
+
+    size_t visible = 0; // lights on screen after the last build
+
+    void resize(int w, int h, int tile);
+    void build(const PointLight* lights, size_t count, const glm::mat4& viewProj);
+
+private:
+    std::vector<uint32_t> tileCounts; // per tile, then its list offset
+    std::vector<int32_t> rects;       // per visible light: x0, y0, x1, y1 in tiles
+};
+
+#endif
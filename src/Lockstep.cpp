@@ -0,0 +1,190 @@
+#include "Lockstep.hpp"
+#include <algorithm>
+
+std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>>
+LoopbackTransport::createPair() {
+    auto a = std::make_shared<Channel>();
+    auto b = std::make_shared<Channel>();
+    std::unique_ptr<LoopbackTransport> left(new LoopbackTransport());
+    std::unique_ptr<LoopbackTransport> right(new LoopbackTransport());
+    left->outbox = a;
+    left->inbox = b;
+    right->outbox = b;
+    right->inbox = a;
+    return {std::move(left), std::move(right)};
+}
+
+void LoopbackTransport::send(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(outbox->mutex);
+    outbox->packets.emplace_back(data, data + size);
+}
+
+bool LoopbackTransport::receive(std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> lock(inbox->mutex);
+    if (inbox->packets.empty()) {
+        return false;
+    }
+    out.swap(inbox->packets.front());
+    inbox->packets.pop_front();
+    return true;
+}
+
+// Packet layout (little endian):
+//   u32 first tick, u32 ack, u8 player, u8 count,
+//   count x u8 buttons for first, first + 1, ...
+// ack is the first tick of the receiver's commands the sender still lacks.
+static constexpr size_t kHeaderSize = 10;
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+void LockstepSession::start(int localPlayer, int playerCount, uint32_t inputDelay) {
+    local = localPlayer;
+    players = playerCount;
+    allMask = (1u << playerCount) - 1u;
+    tick = 0;
+    nextLocal = inputDelay;
+    bytesSent = packetsSent = stalls = 0;
+    for (Slot& s : ring) {
+        s = Slot();
+    }
+    for (uint32_t t = 0; t < inputDelay && t < kWindow; ++t) {
+        for (int p = 0; p < playerCount; ++p) {
+            store(t, p, PlayerCommand());
+        }
+    }
+    // the empty commands before inputDelay are implied on every peer
+    for (uint32_t& r : received) {
+        r = inputDelay;
+    }
+    for (Peer& peer : peers) {
+        peer = Peer{peer.transport, -1, inputDelay, inputDelay, false};
+    }
+}
+
+void LockstepSession::addPeer(Transport* transport) {
+    peers.push_back(Peer{transport, -1, nextLocal, nextLocal, false});
+}
+
+void LockstepSession::store(uint32_t t, int player, PlayerCommand cmd) {
+    // stale (already simulated) or too far ahead to buffer
+    if (t < tick || t >= tick + kWindow || player < 0 || player >= players) {
+        return;
+    }
+    Slot& s = ring[t % kWindow];
+    if (s.tick != t) {
+        s.tick = t;
+        s.present = 0;
+    }
+    s.commands[player] = cmd;
+    s.present |= 1u << player;
+}
+
+void LockstepSession::updateReceived(int player) {
+    // every tick before the current one ran, so all of its commands arrived
+    uint32_t r = std::max(received[player], tick);
+    while (r < tick + kWindow) {
+        const Slot& s = ring[r % kWindow];
+        if (s.tick != r || !(s.present >> player & 1u)) {
+            break;
+        }
+        ++r;
+    }
+    received[player] = r;
+}
+
+void LockstepSession::sendTo(Peer& peer) {
+    // everything it has not acked, oldest first
+    uint32_t first = peer.acked;
+    uint32_t count = nextLocal - first;
+    uint32_t ack = peer.player >= 0 ? received[peer.player] : 0;
+    packet.resize(kHeaderSize + count);
+    putU32(&packet[0], first);
+    putU32(&packet[4], ack);
+    packet[8] = static_cast<uint8_t>(local);
+    packet[9] = static_cast<uint8_t>(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        packet[kHeaderSize + i] = history[(first + i) % kWindow].buttons;
+    }
+    peer.transport->send(packet.data(), packet.size());
+    peer.ackSent = ack;
+    peer.sentSincePoll = true;
+    bytesSent += packet.size();
+    ++packetsSent;
+}
+
+bool LockstepSession::submitLocal(PlayerCommand cmd) {
+    if (nextLocal >= tick + kWindow) {
+        return false;
+    }
+    // the history slot must not still hold a command someone lacks
+    for (const Peer& peer : peers) {
+        if (nextLocal >= peer.acked + kWindow) {
+            return false;
+        }
+    }
+    store(nextLocal, local, cmd);
+    history[nextLocal % kWindow] = cmd;
+    ++nextLocal;
+    for (Peer& peer : peers) {
+        sendTo(peer);
+    }
+    return true;
+}
+
+void LockstepSession::receivePacket(Peer& peer, const std::vector<uint8_t>& data) {
+    if (data.size() < kHeaderSize) {
+        return;
+    }
+    uint32_t first = getU32(&data[0]);
+    uint32_t ack = getU32(&data[4]);
+    int player = data[8];
+    uint32_t count = data[9];
+    if (player == local || player >= players || data.size() < kHeaderSize + count) {
+        return;
+    }
+    peer.player = player;
+    // acks only move forward, and never past what was sent
+    peer.acked = std::max(peer.acked, std::min(ack, nextLocal));
+    for (uint32_t i = 0; i < count; ++i) {
+        PlayerCommand cmd;
+        cmd.buttons = data[kHeaderSize + i];
+        store(first + i, player, cmd);
+    }
+    updateReceived(player);
+}
+
+void LockstepSession::poll() {
+    for (Peer& peer : peers) {
+        while (peer.transport->receive(packet)) {
+            receivePacket(peer, packet);
+        }
+    }
+    for (Peer& peer : peers) {
+        bool owed = peer.acked < nextLocal || (peer.player >= 0 && received[peer.player] != peer.ackSent);
+        if (!peer.sentSincePoll && owed) {
+            sendTo(peer);
+        }
+        peer.sentSincePoll = false;
+    }
+}
+
+bool LockstepSession::advance(Simulation& sim, JobSystem* jobs) {
+    Slot& s = ring[tick % kWindow];
+    if (s.tick != tick || (s.present & allMask) != allMask) {
+        ++stalls;
+        return false;
+    }
+    sim.step(s.commands, jobs);
+    s.present = 0;
+    ++tick;
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef LOCKSTEP_HPP
+#define LOCKSTEP_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <deque>
+# include <memory>
+# include <mutex>
+# include <utility>
+# include <vector>
+# include "Simulation.hpp"
+
+// Unreliable, unordered datagram link to one remote peer. The lockstep
+// session only needs send/receive of small packets, so a UDP socket can
+// implement this the same way the in-process loopback does.
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual void send(const uint8_t* data, size_t size) = 0;
+    // Pops one pending datagram into out; false when nothing is waiting.
+    virtual bool receive(std::vector<uint8_t>& out) = 0;
+};
+
+// In-process link: two queues shared by a connected pair. Thread-safe, so
+// the two ends may live on different threads.
+class LoopbackTransport : public Transport {
+public:
+    static std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> createPair();
+
+    void send(const uint8_t* data, size_t size) override;
+    bool receive(std::vector<uint8_t>& out) override;
+
+private:
+    struct Channel {
+        std::mutex mutex;
+        std::deque<std::vector<uint8_t>> packets;
+    };
+    std::shared_ptr<Channel> inbox, outbox;
+};
+
+// Command exchange for deterministic lockstep. Every peer runs the full
+// Simulation; only PlayerCommands cross the wire, so bandwidth is a few
+// bytes per player per tick no matter how many units exist.
+//
+// A command entered on tick T is scheduled for T + inputDelay, which hides
+// that much latency. A tick only executes once every player's command for
+// it has arrived; until then advance() stalls and the simulation waits.
+//
+// Every packet acks the first tick still missing from its receiver and
+// carries all of the sender's commands that receiver has not acked, so a
+// lost datagram is covered by whichever packet gets through next, however
+// many were lost in a row. When no command was submitted since the last
+// poll() (a full window, or a stall), poll() resends on its own.
+class LockstepSession {
+public:
+    static constexpr int kMaxPlayers = 8;
+    static constexpr uint32_t kWindow = 64; // ticks buffered or unacked ahead
+
+    // Resets the command ring. Ticks before inputDelay run with empty
+    // commands for everyone.
+    void start(int localPlayer, int playerCount, uint32_t inputDelay);
+    void addPeer(Transport* peer);
+
+    // Schedules the local command for the next free tick and sends it.
+    // Returns false when the local player is kWindow ticks ahead of the
+    // slowest peer, or of the oldest unacked command, and must wait.
+    bool submitLocal(PlayerCommand cmd);
+
+    // Drains every transport into the command ring, then resends to the
+    // peers nothing went to since the last poll and that are owed
+    // commands or a newer ack.
+    void poll();
+
+    // Runs the current tick if all its commands are in; false on a stall.
+    bool advance(Simulation& sim, JobSystem* jobs = nullptr);
+
+    uint32_t currentTick() const { return tick; }
+    uint32_t scheduledTick() const { return nextLocal; }
+    int localPlayer() const { return local; }
+
+    uint64_t bytesSent = 0;
+    uint64_t packetsSent = 0;
+    uint64_t stalls = 0;
+
+private:
+    struct Slot {
+        uint32_t tick = ~0u;
+        uint32_t present = 0; // bit per player
+        PlayerCommand commands[kMaxPlayers];
+    };
+    struct Peer {
+        Transport* transport = nullptr;
+        int player = -1;         // learnt from its first packet
+        uint32_t acked = 0;      // first local tick it has not confirmed
+        uint32_t ackSent = 0;    // last ack we sent it
+        bool sentSincePoll = false;
+    };
+
+    void store(uint32_t t, int player, PlayerCommand cmd);
+    void updateReceived(int player);
+    void sendTo(Peer& peer);
+    void receivePacket(Peer& peer, const std::vector<uint8_t>& packet);
+
+    Slot ring[kWindow];
+    PlayerCommand history[kWindow]; // local commands by tick, kept until acked
+    uint32_t received[kMaxPlayers] = {}; // first tick missing from each player
+    std::vector<Peer> peers;
+    std::vector<uint8_t> packet;
+    int local = 0;
+    int players = 1;
+    uint32_t tick = 0;
+    uint32_t nextLocal = 0;
+    uint32_t allMask = 1;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "Minimap.hpp"
+#include "Heightfield.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint32_t dotColor(uint8_t r, uint8_t g, uint8_t b) {
+    return uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 | 0xFF000000u;
+}
+
+// low ground to high ground
+const float kRamp[][3] = {
+    {0.20f, 0.38f, 0.16f},
+    {0.36f, 0.55f, 0.24f},
+    {0.58f, 0.52f, 0.34f},
+    {0.80f, 0.78f, 0.72f},
+};
+const int kRampSteps = 3;
+
+}
+
+void Minimap::create(const Heightfield& terrain, int cellPixels) {
+    pixelsPerCell = std::max(1, cellPixels);
+    w = terrain.cellsX() * pixelsPerCell;
+    h = terrain.cellsZ() * pixelsPerCell;
+    tilesX = terrain.cellsX() / Heightfield::kTile;
+    tilesZ = terrain.cellsZ() / Heightfield::kTile;
+    dirtyTiles.assign(size_t(tilesX) * tilesZ, 1);
+    clock = refreshInterval; // the first tick composites straight away
+
+    // the colour ramp spans the heights the map was made with
+    heightLo = heightHi = terrain.sample(0, 0);
+    for (int sz = 0; sz <= terrain.cellsZ(); ++sz) {
+        for (int sx = 0; sx <= terrain.cellsX(); ++sx) {
+            float s = terrain.sample(sx, sz);
+            heightLo = std::min(heightLo, s);
+            heightHi = std::max(heightHi, s);
+        }
+    }
+}
+
+void Minimap::invalidate(int sx0, int sz0, int sx1, int sz1) {
+    const int n = Heightfield::kTile;
+    int tx0 = std::max(0, (sx0 - 2) / n);
+    int tz0 = std::max(0, (sz0 - 2) / n);
+    int tx1 = std::min(tilesX - 1, (sx1 + 1) / n);
+    int tz1 = std::min(tilesZ - 1, (sz1 + 1) / n);
+    for (int tz = tz0; tz <= tz1; ++tz) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            dirtyTiles[size_t(tz) * tilesX + tx] = 1;
+        }
+    }
+}
+
+void Minimap::takeDirtyRects(std::vector<MinimapRect>& out) {
+    const int tilePixels = Heightfield::kTile * pixelsPerCell;
+    for (int tz = 0; tz < tilesZ; ++tz) {
+        uint8_t* row = dirtyTiles.data() + size_t(tz) * tilesX;
+        for (int tx = 0; tx < tilesX;) {
+            if (!row[tx]) {
+                ++tx;
+                continue;
+            }
+            int end = tx;
+            while (end < tilesX && row[end]) {
+                row[end++] = 0;
+            }
+            out.push_back({tx * tilePixels, tz * tilePixels, end * tilePixels, (tz + 1) * tilePixels});
+            tx = end;
+        }
+    }
+}
+
+void Minimap::shade(const Heightfield& terrain, const MinimapRect& r, uint8_t* out) {
+    const int rw = r.x1 - r.x0;
+    const float step = terrain.spacing() / float(pixelsPerCell);
+    const float invRange = heightHi > heightLo ? 1.0f / (heightHi - heightLo) : 0.0f;
+    // sun from the north west, high up
+    const float lx = -0.40f, ly = 0.82f, lz = -0.40f;
+
+    // three batched lookups per row: the pixel and one step along x and z
+    xs.resize(rw);
+    xsNext.resize(rw);
+    zs.resize(rw);
+    zsNext.resize(rw);
+    heights.resize(size_t(rw) * 3);
+    for (int px = 0; px < rw; ++px) {
+        xs[px] = terrain.minX() + (float(r.x0 + px) + 0.5f) * step;
+        xsNext[px] = xs[px] + step;
+    }
+    for (int py = r.y0; py < r.y1; ++py) {
+        const float z = terrain.minZ() + (float(py) + 0.5f) * step;
+        std::fill(zs.begin(), zs.end(), z);
+        std::fill(zsNext.begin(), zsNext.end(), z + step);
+        float* hc = heights.data();
+        float* hx = hc + rw;
+        float* hz = hx + rw;
+        terrain.heightsAt(xs.data(), zs.data(), hc, rw);
+        terrain.heightsAt(xsNext.data(), zs.data(), hx, rw);
+        terrain.heightsAt(xs.data(), zsNext.data(), hz, rw);
+        for (int px = 0; px < rw; ++px) {
+            // normal (-dh/dx, 1, -dh/dz), normalised
+            float nx = (hc[px] - hx[px]) / step;
+            float nz = (hc[px] - hz[px]) / step;
+            float light = (nx * lx + ly + nz * lz) / std::sqrt(nx * nx + 1.0f + nz * nz);
+            light = std::clamp(0.35f + 0.75f * light, 0.0f, 1.0f);
+
+            float t = std::clamp((hc[px] - heightLo) * invRange, 0.0f, 1.0f) * float(kRampSteps);
+            int k = std::min(int(t), kRampSteps - 1);
+            float f = t - float(k);
+            for (int c = 0; c < 3; ++c) {
+                float v = (kRamp[k][c] + (kRamp[k + 1][c] - kRamp[k][c]) * f) * light;
+                out[c] = uint8_t(v * 255.0f + 0.5f);
+            }
+            out[3] = 255;
+            out += 4;
+        }
+    }
+    pixelsShaded += size_t(rw) * (r.y1 - r.y0);
+}
+
+bool Minimap::tick(float dt) {
+    clock += dt;
+    if (clock < refreshInterval) {
+        return false;
+    }
+    // keep the phase, but never try to catch up on missed refreshes
+    clock = std::fmod(clock, refreshInterval);
+    ++refreshes;
+    return true;
+}
+
+void Minimap::buildDots(const Registry& reg, const Heightfield& terrain, const std::vector<uint32_t>& own,
+                        const std::vector<uint32_t>& selection, std::vector<MinimapDot>& out) const {
+    const float invX = 1.0f / (terrain.maxX() - terrain.minX());
+    const float invZ = 1.0f / (terrain.maxZ() - terrain.minZ());
+    const TransformPool& tp = reg.transforms;
+    const SpritePool& sp = reg.sprites;
+
+    out.clear();
+    out.reserve(sp.size() + 1);
+    out.push_back(MinimapDot{0.0f, 0.0f, 0, 0});
+    for (size_t s = 0; s < sp.size(); ++s) {
+        uint32_t e = sp.entities[s];
+        if (!tp.has(e)) {
+            continue;
+        }
+        uint32_t t = tp.row(e);
+        MinimapDot dot;
+        dot.u = (tp.x[t] - terrain.minX()) * invX;
+        dot.v = (tp.z[t] - terrain.minZ()) * invZ;
+        dot.flags = 0;
+        if (std::binary_search(own.begin(), own.end(), e)) {
+            dot.flags |= kOwn;
+        }
+        if (std::binary_search(selection.begin(), selection.end(), e)) {
+            dot.flags |= kSelected;
+        }
+        if (dot.flags & kSelected) {
+            dot.color = dotColor(255, 230, 80);
+        } else if (dot.flags & kOwn) {
+            dot.color = dotColor(80, 220, 255);
+        } else {
+            dot.color = dotColor(230, 60, 50);
+        }
+        out.push_back(dot);
+    }
+}
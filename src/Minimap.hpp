@@ -0,0 +1,78 @@
+#ifndef MINIMAP_HPP
+#define MINIMAP_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include "Registry.hpp"
+
+class Heightfield;
+
+// Half-open pixel rectangle [x0, x1) x [y0, y1) of the terrain image.
+struct MinimapRect {
+    int x0, y0, x1, y1;
+};
+
+// One unit on the minimap: map UV (x and z across the terrain, 0..1),
+// an RGBA colour (bytes R, G, B, A) and kOwn / kSelected flags.
+struct MinimapDot {
+    float u, v;
+    uint32_t color;
+    uint32_t flags;
+};
+
+// CPU side of the minimap. The terrain is shaded into an RGBA8 image of
+// pixelsPerCell x pixelsPerCell per terrain cell, once when the map is
+// loaded; after that only the Heightfield tiles around invalidated height
+// samples are reshaded, and takeDirtyRects() hands them out merged along
+// rows for texture patches. Units are composited on top as dots, at
+// refreshInterval rather than every frame.
+class Minimap {
+public:
+    static constexpr uint32_t kOwn = 1;      // drawn even where the fog hides the map
+    static constexpr uint32_t kSelected = 2;
+
+    float refreshInterval = 0.1f; // seconds between dot composites
+
+    size_t pixelsShaded = 0; // cumulative; reset by the caller
+    size_t refreshes = 0;
+
+    // Every tile starts dirty, so the first takeDirtyRects() covers the map.
+    void create(const Heightfield& terrain, int pixelsPerCell);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // The height samples [sx0, sx1] x [sz0, sz1] changed. Shading looks at
+    // neighbouring samples, so cells one beyond them are redone as well.
+    void invalidate(int sx0, int sz0, int sx1, int sz1);
+    // Appends the pixel rects of the tiles changed since the last call and
+    // clears them. Rects never overlap.
+    void takeDirtyRects(std::vector<MinimapRect>& out);
+    // Terrain colours of `r`, rows tightly packed, 4 bytes per pixel.
+    void shade(const Heightfield& terrain, const MinimapRect& r, uint8_t* out);
+
+    // Advances the refresh clock by dt; true when the dots are due again.
+    bool tick(float dt);
+
+    // One dot per unit with a sprite and a transform, after a reserved
+    // first entry the renderer draws the map itself with, so the whole
+    // composite is a single instanced draw. `own` and `selection` are
+    // sorted entity indices.
+    void buildDots(const Registry& reg, const Heightfield& terrain, const std::vector<uint32_t>& own,
+                   const std::vector<uint32_t>& selection, std::vector<MinimapDot>& out) const;
+
+private:
+    int pixelsPerCell = 1;
+    int w = 0;
+    int h = 0;
+    int tilesX = 0;
+    int tilesZ = 0;
+    float clock = 0.0f;
+    float heightLo = 0.0f; // ends of the colour ramp
+    float heightHi = 0.0f;
+    std::vector<uint8_t> dirtyTiles;
+    std::vector<float> xs, xsNext, zs, zsNext, heights; // shade() scratch
+};
+
+#endif
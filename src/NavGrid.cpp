@@ -0,0 +1,44 @@
+#include "NavGrid.hpp"
+#include <algorithm>
+
+void NavGrid::create(int width, int height, float tileSize, float x0, float z0) {
+    w = width;
+    h = height;
+    size = tileSize;
+    invSize = 1.0f / tileSize;
+    originX = x0;
+    originZ = z0;
+    costs.assign(size_t(w) * h, 1);
+    // a new grid invalidates every consumer's cursor
+    logBase += changed.size() + 1;
+    changed.clear();
+}
+
+void NavGrid::setCost(int x, int y, uint8_t c) {
+    uint32_t i = index(x, y);
+    if (costs[i] == c) {
+        return;
+    }
+    costs[i] = c;
+    changed.push_back(i);
+}
+
+bool NavGrid::changesSince(uint64_t cursor, const uint32_t*& tiles, size_t& count) const {
+    if (cursor < logBase || cursor > changeCursor()) {
+        return false;
+    }
+    tiles = changed.data() + (cursor - logBase);
+    count = size_t(changeCursor() - cursor);
+    return true;
+}
+
+uint32_t NavGrid::tileAt(float x, float z) const {
+    int tx = std::clamp(int((x - originX) * invSize), 0, w - 1);
+    int ty = std::clamp(int((z - originZ) * invSize), 0, h - 1);
+    return index(tx, ty);
+}
+
+void NavGrid::tileCenter(uint32_t tile, float& x, float& z) const {
+    x = originX + (float(tile % uint32_t(w)) + 0.5f) * size;
+    z = originZ + (float(tile / uint32_t(w)) + 0.5f) * size;
+}
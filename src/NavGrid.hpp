@@ -0,0 +1,62 @@
+#ifndef NAVGRID_HPP
+#define NAVGRID_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// Walkability and movement cost per tile over the XZ plane. Every
+// pathfinder reads this one grid. Edits are logged so cached path data can
+// be repaired incrementally instead of rebuilt.
+class NavGrid {
+public:
+    static constexpr uint8_t kBlocked = 255;
+
+    void create(int width, int height, float tileSize, float originX, float originZ);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    float tileSize() const { return size; }
+    float minX() const { return originX; }
+    float minZ() const { return originZ; }
+
+    uint8_t cost(int x, int y) const { return costs[size_t(y) * w + x]; }
+    uint8_t cost(uint32_t tile) const { return costs[tile]; }
+    bool inside(int x, int y) const { return x >= 0 && y >= 0 && x < w && y < h; }
+    bool walkable(int x, int y) const { return inside(x, y) && cost(x, y) != kBlocked; }
+    uint32_t index(int x, int y) const { return uint32_t(y) * uint32_t(w) + uint32_t(x); }
+    const uint8_t* data() const { return costs.data(); }
+
+    // Cost 1..254, or kBlocked. Changed tiles are appended to changes().
+    void setCost(int x, int y, uint8_t c);
+
+    // Tile containing a world position, clamped to the grid.
+    uint32_t tileAt(float x, float z) const;
+    // World position of a tile centre.
+    void tileCenter(uint32_t tile, float& x, float& z) const;
+
+    // Edit log. Each consumer remembers the cursor it has caught up to and
+    // asks for the tiles edited since (a tile may appear more than once).
+    // changesSince() fails once the log has been trimmed past the cursor,
+    // and the consumer must rebuild from scratch.
+    uint64_t changeCursor() const { return logBase + changed.size(); }
+    bool changesSince(uint64_t cursor, const uint32_t*& tiles, size_t& count) const;
+    // Drops the log; call once every consumer has caught up (e.g. per frame).
+    void trimChanges() {
+        logBase += changed.size();
+        changed.clear();
+    }
+
+private:
+    int w = 0;
+    int h = 0;
+    float size = 1.0f;
+    float invSize = 1.0f;
+    float originX = 0.0f;
+    float originZ = 0.0f;
+    std::vector<uint8_t> costs;
+    std::vector<uint32_t> changed;
+    uint64_t logBase = 0;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "Overlay.hpp"
+#include "DebugFont.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// atlas texel of a glyph cell's top left corner
+inline void cellOrigin(int glyph, uint16_t& u, uint16_t& v) {
+    u = uint16_t(glyph % DebugFont::kColumns * DebugFont::kCellWidth);
+    v = uint16_t(glyph / DebugFont::kColumns * DebugFont::kCellHeight);
+}
+
+}
+
+int OverlayBatch::glyphWidth() {
+    return DebugFont::kCellWidth;
+}
+
+int OverlayBatch::lineHeight() {
+    return DebugFont::kCellHeight;
+}
+
+OverlayVertex* OverlayBatch::grow(size_t quads) {
+    size_t at = vertices.size();
+    vertices.resize(at + quads * 4);
+    return vertices.data() + at;
+}
+
+float OverlayBatch::text(float x, float y, const char* s, uint32_t color) {
+    const float w = float(DebugFont::kCellWidth);
+    const float h = float(DebugFont::kCellHeight);
+    // one allocation for the whole string; spaces and newlines are trimmed after
+    OverlayVertex* q = grow(std::strlen(s));
+    float cx = x;
+    for (; *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '\n') {
+            cx = x;
+            y += h;
+            continue;
+        }
+        if (c != ' ') {
+            int glyph = (c < DebugFont::kFirst || c > DebugFont::kLast) ? '?' - DebugFont::kFirst
+                                                                          : c - DebugFont::kFirst;
+            uint16_t u, v;
+            cellOrigin(glyph, u, v);
+            const uint16_t u1 = uint16_t(u + DebugFont::kCellWidth);
+            const uint16_t v1 = uint16_t(v + DebugFont::kCellHeight);
+            q[0] = OverlayVertex{cx, y, u, v, color};
+            q[1] = OverlayVertex{cx + w, y, u1, v, color};
+            q[2] = OverlayVertex{cx + w, y + h, u1, v1, color};
+            q[3] = OverlayVertex{cx, y + h, u, v1, color};
+            q += 4;
+        }
+        cx += w;
+    }
+    vertices.resize(size_t(q - vertices.data()));
+    return cx;
+}
+
+void OverlayBatch::rect(float x, float y, float w, float h, uint32_t color) {
+    // the middle of the solid cell, so filtering never reaches a neighbour
+    uint16_t u, v;
+    cellOrigin(DebugFont::kSolid, u, v);
+    u = uint16_t(u + DebugFont::kCellWidth / 2);
+    v = uint16_t(v + DebugFont::kCellHeight / 2);
+    OverlayVertex* q = grow(1);
+    q[0] = OverlayVertex{x, y, u, v, color};
+    q[1] = OverlayVertex{x + w, y, u, v, color};
+    q[2] = OverlayVertex{x + w, y + h, u, v, color};
+    q[3] = OverlayVertex{x, y + h, u, v, color};
+}
+
+void OverlayBatch::line(float x0, float y0, float x1, float y1, float width, uint32_t color) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len <= 0.0f) {
+        return;
+    }
+    // half the width across the segment
+    float nx = -dy / len * width * 0.5f;
+    float ny = dx / len * width * 0.5f;
+    uint16_t u, v;
+    cellOrigin(DebugFont::kSolid, u, v);
+    u = uint16_t(u + DebugFont::kCellWidth / 2);
+    v = uint16_t(v + DebugFont::kCellHeight / 2);
+    OverlayVertex* q = grow(1);
+    q[0] = OverlayVertex{x0 + nx, y0 + ny, u, v, color};
+    q[1] = OverlayVertex{x1 + nx, y1 + ny, u, v, color};
+    q[2] = OverlayVertex{x1 - nx, y1 - ny, u, v, color};
+    q[3] = OverlayVertex{x0 - nx, y0 - ny, u, v, color};
+}
+
+void OverlayBatch::graph(float x, float y, float w, float h, const float* values, size_t count, float maxValue,
+                         uint32_t color) {
+    if (count < 2 || maxValue <= 0.0f) {
+        return;
+    }
+    const float step = w / float(count - 1);
+    auto plotY = [&](float value) { return y + h - std::min(value / maxValue, 1.0f) * h; };
+    float px = x, py = plotY(values[0]);
+    for (size_t i = 1; i < count; ++i) {
+        float nx = x + step * float(i), ny = plotY(values[i]);
+        line(px, py, nx, ny, 1.0f, color);
+        px = nx;
+        py = ny;
+    }
+}
+
+void OverlayBatch::atlasPixels(std::vector<uint8_t>& out, int& width, int& height) {
+    width = DebugFont::kWidth;
+    height = DebugFont::kHeight;
+    const int stride = (width + 7) / 8;
+    out.resize(size_t(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            bool on = (DebugFont::kBits[y * stride + x / 8] >> (7 - x % 8)) & 1;
+            out[size_t(y) * width + x] = on ? 255 : 0;
+        }
+    }
+}
+
+void OverlayBatch::quadIndices(size_t quads, std::vector<uint32_t>& out) {
+    out.resize(quads * 6);
+    for (size_t i = 0; i < quads; ++i) {
+        uint32_t b = uint32_t(i * 4);
+        uint32_t* o = &out[i * 6];
+        o[0] = b; o[1] = b + 1; o[2] = b + 2;
+        o[3] = b + 2; o[4] = b + 3; o[5] = b;
+    }
+}
+
+void PerfHud::frame(float ms) {
+    history[head] = ms;
+    head = (head + 1) % kHistory;
+    filled = std::min(filled + 1, kHistory);
+}
+
+void PerfHud::counter(const char* name, double value) {
+    for (Counter& c : counters) {
+        if (c.name == name || std::strcmp(c.name, name) == 0) {
+            c.value = value;
+            return;
+        }
+    }
+    counters.push_back(Counter{name, value});
+}
+
+void PerfHud::build(OverlayBatch& batch, float x, float y) const {
+    const float graphW = float(kHistory);
+    const float graphH = 60.0f;
+    const float line = float(OverlayBatch::lineHeight());
+    const float pad = 4.0f;
+    const float width = graphW + 2.0f * pad;
+    const float height = graphH + line * float(2 + counters.size()) + 3.0f * pad;
+
+    // oldest first, and the frame time statistics on the way
+    float ordered[kHistory];
+    float sum = 0.0f, worst = 0.0f;
+    for (size_t i = 0; i < filled; ++i) {
+        float ms = history[(head + kHistory - filled + i) % kHistory];
+        ordered[i] = ms;
+        sum += ms;
+        worst = std::max(worst, ms);
+    }
+    const float last = filled ? history[(head + kHistory - 1) % kHistory] : 0.0f;
+
+    batch.rect(x, y, width, height, overlayColor(0, 0, 0, 160));
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "frame %5.2f ms  avg %5.2f  max %5.2f", last, filled ? sum / float(filled) : 0.0f,
+                  worst);
+    float ty = y + pad;
+    batch.text(x + pad, ty, buf, overlayColor(255, 255, 255));
+    ty += line + pad;
+
+    // the 60 Hz budget sits at two thirds of the graph's height
+    const float scale = 25.0f;
+    const float gx = x + pad;
+    batch.rect(gx, ty, graphW, graphH, overlayColor(255, 255, 255, 24));
+    float budgetY = ty + graphH - 16.667f / scale * graphH;
+    batch.line(gx, budgetY, gx + graphW, budgetY, 1.0f, overlayColor(255, 80, 80, 200));
+    batch.graph(gx + graphW - float(filled), ty, float(filled), graphH, ordered, filled, scale,
+                overlayColor(120, 255, 120));
+    ty += graphH + pad;
+
+    for (const Counter& c : counters) {
+        std::snprintf(buf, sizeof(buf), "%-14s %10.6g", c.name, c.value);
+        batch.text(x + pad, ty, buf, overlayColor(220, 220, 220));
+        ty += line;
+    }
+}
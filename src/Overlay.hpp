@@ -0,0 +1,74 @@
+#ifndef OVERLAY_HPP
+#define OVERLAY_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// One corner of an overlay quad: pixels from the top left of the screen,
+// a DebugFont atlas texel and a colour.
+struct OverlayVertex {
+    float x, y;
+    uint16_t u, v;
+    uint32_t color; // overlayColor()
+};
+
+// Bytes in memory are R, G, B, A, for a normalised GL_UNSIGNED_BYTE attribute.
+inline uint32_t overlayColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 | uint32_t(a) << 24;
+}
+
+// Text, rectangles and line graphs for one frame, all as quads on the
+// debug font atlas; rectangles and lines sample its solid cell. Since
+// every quad has the same texture and shader the whole overlay is one
+// vertex stream and one indexed draw (quadIndices() order).
+class OverlayBatch {
+public:
+    std::vector<OverlayVertex> vertices; // four per quad: tl, tr, br, bl
+
+    void clear() { vertices.clear(); }
+    size_t quads() const { return vertices.size() / 4; }
+
+    // Draws `s` from (x, y), the top left of its first cell; '\n' starts
+    // a new line back at x. Returns the x after the last glyph.
+    float text(float x, float y, const char* s, uint32_t color);
+    void rect(float x, float y, float w, float h, uint32_t color);
+    void line(float x0, float y0, float x1, float y1, float width, uint32_t color);
+    // count values as a polyline across the box; maxValue maps to its top
+    void graph(float x, float y, float w, float h, const float* values, size_t count, float maxValue,
+               uint32_t color);
+
+    static int glyphWidth();
+    static int lineHeight();
+    // The atlas as one byte per pixel (0 or 255), for an R8 texture.
+    static void atlasPixels(std::vector<uint8_t>& out, int& width, int& height);
+    // Two triangles per quad, for a static index buffer.
+    static void quadIndices(size_t quads, std::vector<uint32_t>& out);
+
+private:
+    OverlayVertex* grow(size_t quads);
+};
+
+// Frame-time graph and counters for the top left corner. Counters keep
+// the order they were first set in; names must outlive the HUD (string
+// literals).
+class PerfHud {
+public:
+    static constexpr size_t kHistory = 240;
+
+    void frame(float ms);
+    void counter(const char* name, double value);
+    void build(OverlayBatch& batch, float x, float y) const;
+
+private:
+    struct Counter {
+        const char* name;
+        double value;
+    };
+    float history[kHistory] = {};
+    size_t head = 0;   // next slot to write
+    size_t filled = 0;
+    std::vector<Counter> counters;
+};
+
+#endif
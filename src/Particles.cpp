@@ -0,0 +1,255 @@
+#include "Particles.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+# define PARTICLES_X86 1
+# include <immintrin.h>
+#endif
+
+namespace {
+
+struct UpdateArgs {
+    float* x;
+    float* y;
+    float* z;
+    float* vx;
+    float* vy;
+    float* vz;
+    float* age;
+    const float* invLife;
+    uint8_t* deadMask;
+    size_t count;
+    float dt;
+    float gdt;  // gravity * dt
+    float damp; // velocity scale for this step
+};
+
+void updateScalar(const UpdateArgs& a, size_t begin) {
+    for (size_t i = begin; i < a.count; ++i) {
+        float vy = a.vy[i] + a.gdt;
+        float vx = a.vx[i] * a.damp;
+        vy = vy * a.damp;
+        float vz = a.vz[i] * a.damp;
+        a.x[i] += vx * a.dt;
+        a.y[i] += vy * a.dt;
+        a.z[i] += vz * a.dt;
+        a.vx[i] = vx;
+        a.vy[i] = vy;
+        a.vz[i] = vz;
+        float age = a.age[i] + a.dt;
+        a.age[i] = age;
+        if (age * a.invLife[i] >= 1.0f) {
+            a.deadMask[i / 8] |= uint8_t(1u << (i % 8));
+        }
+    }
+}
+
+#ifdef PARTICLES_X86
+
+// Four particles; returns their expired lanes as a 4-bit mask.
+inline int update4(const UpdateArgs& a, size_t i, __m128 dt, __m128 gdt, __m128 damp, __m128 one) {
+    __m128 vy = _mm_add_ps(_mm_loadu_ps(a.vy + i), gdt);
+    __m128 vx = _mm_mul_ps(_mm_loadu_ps(a.vx + i), damp);
+    vy = _mm_mul_ps(vy, damp);
+    __m128 vz = _mm_mul_ps(_mm_loadu_ps(a.vz + i), damp);
+    _mm_storeu_ps(a.x + i, _mm_add_ps(_mm_loadu_ps(a.x + i), _mm_mul_ps(vx, dt)));
+    _mm_storeu_ps(a.y + i, _mm_add_ps(_mm_loadu_ps(a.y + i), _mm_mul_ps(vy, dt)));
+    _mm_storeu_ps(a.z + i, _mm_add_ps(_mm_loadu_ps(a.z + i), _mm_mul_ps(vz, dt)));
+    _mm_storeu_ps(a.vx + i, vx);
+    _mm_storeu_ps(a.vy + i, vy);
+    _mm_storeu_ps(a.vz + i, vz);
+    __m128 age = _mm_add_ps(_mm_loadu_ps(a.age + i), dt);
+    _mm_storeu_ps(a.age + i, age);
+    return _mm_movemask_ps(_mm_cmpge_ps(_mm_mul_ps(age, _mm_loadu_ps(a.invLife + i)), one));
+}
+
+size_t updateSSE2(const UpdateArgs& a) {
+    const __m128 dt = _mm_set1_ps(a.dt);
+    const __m128 gdt = _mm_set1_ps(a.gdt);
+    const __m128 damp = _mm_set1_ps(a.damp);
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= a.count; i += 8) {
+        int lo = update4(a, i, dt, gdt, damp, one);
+        int hi = update4(a, i + 4, dt, gdt, damp, one);
+        a.deadMask[i / 8] = uint8_t(lo | (hi << 4));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t updateAVX2(const UpdateArgs& a) {
+    const __m256 dt = _mm256_set1_ps(a.dt);
+    const __m256 gdt = _mm256_set1_ps(a.gdt);
+    const __m256 damp = _mm256_set1_ps(a.damp);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= a.count; i += 8) {
+        __m256 vy = _mm256_add_ps(_mm256_loadu_ps(a.vy + i), gdt);
+        __m256 vx = _mm256_mul_ps(_mm256_loadu_ps(a.vx + i), damp);
+        vy = _mm256_mul_ps(vy, damp);
+        __m256 vz = _mm256_mul_ps(_mm256_loadu_ps(a.vz + i), damp);
+        _mm256_storeu_ps(a.x + i, _mm256_add_ps(_mm256_loadu_ps(a.x + i), _mm256_mul_ps(vx, dt)));
+        _mm256_storeu_ps(a.y + i, _mm256_add_ps(_mm256_loadu_ps(a.y + i), _mm256_mul_ps(vy, dt)));
+        _mm256_storeu_ps(a.z + i, _mm256_add_ps(_mm256_loadu_ps(a.z + i), _mm256_mul_ps(vz, dt)));
+        _mm256_storeu_ps(a.vx + i, vx);
+        _mm256_storeu_ps(a.vy + i, vy);
+        _mm256_storeu_ps(a.vz + i, vz);
+        __m256 age = _mm256_add_ps(_mm256_loadu_ps(a.age + i), dt);
+        _mm256_storeu_ps(a.age + i, age);
+        __m256 dead = _mm256_cmp_ps(_mm256_mul_ps(age, _mm256_loadu_ps(a.invLife + i)), one, _CMP_GE_OQ);
+        a.deadMask[i / 8] = uint8_t(_mm256_movemask_ps(dead));
+    }
+    return i;
+}
+
+#endif
+
+}
+
+void ParticlePool::init(const ParticleType& t) {
+    type = t;
+    count = 0;
+    for (std::vector<float>* col : {&x, &y, &z, &vx, &vy, &vz, &age, &invLife}) {
+        col->assign(t.capacity, 0.0f);
+    }
+    deadMask.assign((t.capacity + 7) / 8, 0);
+}
+
+bool ParticlePool::spawn(const glm::vec3& p, const glm::vec3& v, float life) {
+    if (count == type.capacity) {
+        ++dropped;
+        return false;
+    }
+    size_t i = count++;
+    x[i] = p.x;
+    y[i] = p.y;
+    z[i] = p.z;
+    vx[i] = v.x;
+    vy[i] = v.y;
+    vz[i] = v.z;
+    age[i] = 0.0f;
+    invLife[i] = 1.0f / life;
+    return true;
+}
+
+void ParticlePool::update(float dt) {
+    update(dt, detectSimdLevel());
+}
+
+void ParticlePool::update(float dt, SimdLevel level) {
+    killed = 0;
+    if (count == 0) {
+        return;
+    }
+    UpdateArgs a = {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), age.data(), invLife.data(),
+                    deadMask.data(), count, dt, type.gravity * dt, std::max(0.0f, 1.0f - type.drag * dt)};
+    size_t i = 0;
+#ifdef PARTICLES_X86
+    if (level == SimdLevel::AVX2) {
+        i = updateAVX2(a);
+    } else if (level == SimdLevel::SSE2) {
+        i = updateSSE2(a);
+    }
+#else
+    (void)level;
+#endif
+    // the kernels write whole mask bytes; the scalar tail only sets bits
+    std::memset(deadMask.data() + i / 8, 0, (count + 7) / 8 - i / 8);
+    updateScalar(a, i);
+
+    // Highest hole first: every particle above it is alive by then, so
+    // the last one can always be moved in.
+    for (size_t b = (count + 7) / 8; b-- > 0;) {
+        unsigned m = deadMask[b];
+        while (m) {
+            unsigned bit = 31u - unsigned(__builtin_clz(m));
+            m &= ~(1u << bit);
+            size_t hole = b * 8 + bit;
+            size_t last = --count;
+            if (hole != last) {
+                x[hole] = x[last];
+                y[hole] = y[last];
+                z[hole] = z[last];
+                vx[hole] = vx[last];
+                vy[hole] = vy[last];
+                vz[hole] = vz[last];
+                age[hole] = age[last];
+                invLife[hole] = invLife[last];
+            }
+            ++killed;
+        }
+    }
+}
+
+void ParticlePool::writeInstances(ParticleInstance* out) const {
+    size_t i = 0;
+#ifdef PARTICLES_X86
+    // transpose four SoA lanes into four x, y, z, t instances
+    float* dst = reinterpret_cast<float*>(out);
+    for (; i + 4 <= count; i += 4) {
+        __m128 r0 = _mm_loadu_ps(x.data() + i);
+        __m128 r1 = _mm_loadu_ps(y.data() + i);
+        __m128 r2 = _mm_loadu_ps(z.data() + i);
+        __m128 r3 = _mm_mul_ps(_mm_loadu_ps(age.data() + i), _mm_loadu_ps(invLife.data() + i));
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst + i * 4, r0);
+        _mm_storeu_ps(dst + i * 4 + 4, r1);
+        _mm_storeu_ps(dst + i * 4 + 8, r2);
+        _mm_storeu_ps(dst + i * 4 + 12, r3);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = ParticleInstance{x[i], y[i], z[i], age[i] * invLife[i]};
+    }
+}
+
+uint16_t ParticleSystem::addType(const ParticleType& type) {
+    pools.emplace_back();
+    pools.back().init(type);
+    return uint16_t(pools.size() - 1);
+}
+
+float ParticleSystem::random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return float(rng >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleSystem::burst(uint16_t type, const glm::vec3& origin, int count, float speed, float lifeMin,
+                           float lifeMax) {
+    ParticlePool& pool = pools[type];
+    for (int k = 0; k < count; ++k) {
+        float a = random() * 6.2831853f;
+        float out = speed * random();
+        glm::vec3 v(std::cos(a) * out, speed * (0.5f + 0.5f * random()), std::sin(a) * out);
+        pool.spawn(origin, v, lifeMin + (lifeMax - lifeMin) * random());
+    }
+}
+
+void ParticleSystem::update(float dt) {
+    for (ParticlePool& pool : pools) {
+        pool.update(dt);
+    }
+}
+
+size_t ParticleSystem::liveCount() const {
+    size_t n = 0;
+    for (const ParticlePool& pool : pools) {
+        n += pool.count;
+    }
+    return n;
+}
+
+void ParticleSystem::writeInstances(ParticleInstance* out, std::vector<size_t>& first) const {
+    first.clear();
+    size_t at = 0;
+    for (const ParticlePool& pool : pools) {
+        first.push_back(at);
+        pool.writeInstances(out + at);
+        at += pool.count;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PARTICLES_HPP
+#define PARTICLES_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include <glm/glm.hpp>
+# include "Kinematics.hpp"
+
+// How one kind of particle moves and looks. Size and colour are blended
+// from start to end over each particle's life by the particle shader, so
+// a type is also the unit of drawing: one instanced draw per pool.
+struct ParticleType {
+    uint32_t capacity = 4096;
+    float gravity = -9.8f;
+    float drag = 0.0f; // fraction of velocity lost per second
+    float sizeStart = 0.1f;
+    float sizeEnd = 0.1f;
+    glm::vec4 colorStart {1.0f};
+    glm::vec4 colorEnd {1.0f, 1.0f, 1.0f, 0.0f};
+};
+
+// Per-instance data of a live particle; w is the fraction of life used.
+struct ParticleInstance {
+    float x, y, z, t;
+};
+
+// Fixed capacity pool of one particle type, stored as parallel arrays.
+// Spawns beyond capacity are dropped. update() integrates and ages
+// every particle in SIMD lanes, recording the expired ones in a bit mask,
+// then kills them by swapping the last live particle into each hole,
+// highest hole first, so each kill is a single move.
+class ParticlePool {
+public:
+    ParticleType type;
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> age, invLife;
+    size_t count = 0;
+
+    size_t dropped = 0; // spawns refused because the pool was full
+    size_t killed = 0;  // by the last update
+
+    void init(const ParticleType& t);
+    bool spawn(const glm::vec3& p, const glm::vec3& v, float life);
+    void clear() { count = 0; }
+
+    void update(float dt, SimdLevel level);
+    void update(float dt);
+
+    // Writes the count live particles to `out` in pool order.
+    void writeInstances(ParticleInstance* out) const;
+
+private:
+    std::vector<uint8_t> deadMask; // one bit per particle, 8 per byte
+};
+
+// Every particle pool of the game plus the random source for bursts.
+// Particles are cosmetic: nothing here feeds back into the simulation.
+class ParticleSystem {
+public:
+    std::vector<ParticlePool> pools;
+
+    uint16_t addType(const ParticleType& type);
+
+    // `count` particles from `origin`, thrown outwards and up at up to
+    // `speed`, each living between lifeMin and lifeMax seconds.
+    void burst(uint16_t type, const glm::vec3& origin, int count, float speed, float lifeMin, float lifeMax);
+    float random(); // uniform in [0, 1)
+
+    void update(float dt);
+    size_t liveCount() const;
+
+    // Writes every pool's live particles back to back; `first` receives
+    // each pool's offset into `out`, which needs liveCount() entries.
+    void writeInstances(ParticleInstance* out, std::vector<size_t>& first) const;
+
+private:
+    uint32_t rng = 0x9E3779B9u;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "PathService.hpp"
+#include <algorithm>
+
+PathService::PathService(const NavGrid& nav, HierarchicalPathfinder& finder, JobSystem& jobs)
+    : nav(nav), finder(finder), jobs(jobs), gridCursor(nav.changeCursor()) {
+    // one search job per worker thread, or one run inline without workers
+    unsigned count = jobs.threadCount() > 1 ? jobs.threadCount() - 1 : 1;
+    for (unsigned i = 0; i < count; ++i) {
+        queries.push_back(std::make_unique<HierarchicalPathfinder::Query>());
+    }
+    for (auto& q : queries) {
+        workers.push_back({this, q.get()});
+    }
+    batch.resize(kMaxBatch);
+    latencies.reserve(kLatencySamples);
+}
+
+PathService::~PathService() {
+    if (inFlight) {
+        jobs.wait(counter);
+    }
+}
+
+uint32_t PathService::request(uint32_t start, uint32_t goal, PathPriority priority) {
+    Waiter waiter = {nextTicket++, Clock::now()};
+    ++requests;
+    const uint64_t key = keyOf(start, goal);
+
+    if (gridCursor == nav.changeCursor()) {
+        auto cached = cache.find(key);
+        if (cached != cache.end()) {
+            ++cacheHits;
+            hits.push_back({waiter, cached->second});
+            return waiter.ticket;
+        }
+    }
+
+    auto it = pending.find(key);
+    if (it != pending.end()) {
+        ++merged;
+        it->second.waiters.push_back(waiter);
+        if (priority == PathPriority::Player && it->second.priority == PathPriority::Ai && !it->second.inFlight) {
+            // promoted: the stale entry in the AI queue is skipped later
+            it->second.priority = PathPriority::Player;
+            queues[0].push_back(key);
+        }
+        return waiter.ticket;
+    }
+    Pending& p = pending[key];
+    p.waiters.push_back(waiter);
+    p.priority = priority;
+    queues[int(priority)].push_back(key);
+    return waiter.ticket;
+}
+
+void PathService::runWorker(const Job& job) {
+    const Worker& w = *static_cast<const Worker*>(job.context);
+    w.service->work(*w.query);
+}
+
+void PathService::work(HierarchicalPathfinder::Query& query) {
+    // A search that starts before the deadline runs to the end, so one
+    // long query can overrun the budget by its own length.
+    while (Clock::now() < deadline) {
+        size_t i = nextSlot.fetch_add(1, std::memory_order_relaxed);
+        if (i >= batchSize) {
+            return;
+        }
+        Slot& s = batch[i];
+        s.cost = finder.findPath(uint32_t(s.key >> 32), uint32_t(s.key), s.tiles, query);
+        completed.push(uint32_t(i));
+    }
+}
+
+void PathService::dispatch() {
+    if (inFlight || pending.empty()) {
+        return;
+    }
+    if (gridCursor != nav.changeCursor()) {
+        finder.sync();
+        cache.clear();
+        cacheOrder.clear();
+        gridCursor = nav.changeCursor();
+    }
+
+    batchSize = 0;
+    for (int p = 0; p < 2; ++p) {
+        while (batchSize < kMaxBatch && !queues[p].empty()) {
+            uint64_t key = queues[p].front();
+            queues[p].pop_front();
+            auto it = pending.find(key);
+            if (it == pending.end() || it->second.inFlight || int(it->second.priority) != p) {
+                continue;
+            }
+            it->second.inFlight = true;
+            batch[batchSize].key = key;
+            batch[batchSize].cost = HierarchicalPathfinder::kNoPath;
+            ++batchSize;
+        }
+    }
+    if (batchSize == 0) {
+        return;
+    }
+
+    nextSlot.store(0, std::memory_order_relaxed);
+    deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double, std::milli>(budgetMs));
+    inFlight = true;
+    for (const Worker& w : workers) {
+        jobs.schedule(&PathService::runWorker, &w, &counter);
+    }
+    if (jobs.threadCount() == 1) {
+        jobs.wait(counter);
+    }
+}
+
+void PathService::deliver(const Waiter& waiter, const Cached& path, std::vector<PathResult>& out) {
+    out.push_back({waiter.ticket, path.cost, path.tiles});
+    float ms = std::chrono::duration<float, std::milli>(Clock::now() - waiter.issued).count();
+    if (latencies.size() < kLatencySamples) {
+        latencies.push_back(ms);
+    } else {
+        latencies[latencyNext] = ms;
+        latencyNext = (latencyNext + 1) % kLatencySamples;
+    }
+}
+
+void PathService::collect(std::vector<PathResult>& out) {
+    auto drain = [&] {
+        uint32_t i;
+        while (completed.pop(i)) {
+            Slot& s = batch[i];
+            ++solved;
+            Cached path = {s.cost, std::make_shared<const std::vector<uint32_t>>(std::move(s.tiles))};
+            s.tiles.clear();
+            if (cache.size() >= cacheCapacity && !cacheOrder.empty()) {
+                cache.erase(cacheOrder.front());
+                cacheOrder.pop_front();
+            }
+            if (cache.emplace(s.key, path).second) {
+                cacheOrder.push_back(s.key);
+            }
+            auto it = pending.find(s.key);
+            for (const Waiter& w : it->second.waiters) {
+                deliver(w, path, out);
+            }
+            pending.erase(it);
+        }
+    };
+    drain();
+    if (!inFlight || !counter.done()) {
+        return;
+    }
+    // pushes that landed after the first drain but before the jobs ended
+    drain();
+    // requests left over at the deadline go back to the front of their queue
+    size_t claimed = std::min(nextSlot.load(std::memory_order_relaxed), batchSize);
+    for (size_t k = batchSize; k-- > claimed;) {
+        Pending& p = pending[batch[k].key];
+        p.inFlight = false;
+        queues[int(p.priority)].push_front(batch[k].key);
+    }
+    inFlight = false;
+}
+
+void PathService::update(std::vector<PathResult>& out) {
+    collect(out);
+    for (const Hit& h : hits) {
+        deliver(h.waiter, h.path, out);
+    }
+    hits.clear();
+    dispatch();
+    collect(out);
+}
+
+void PathService::finish(std::vector<PathResult>& out) {
+    if (inFlight) {
+        jobs.wait(counter);
+    }
+    collect(out);
+}
+
+double PathService::latencyPercentileMs(double p) const {
+    if (latencies.empty()) {
+        return 0.0;
+    }
+    std::vector<float> sorted(latencies);
+    size_t k = size_t(p / 100.0 * double(sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
@@ -0,0 +1,179 @@
+#ifndef PATHSERVICE_HPP
+#define PATHSERVICE_HPP
+
+# include <atomic>
+# include <chrono>
+# include <cstddef>
+# include <cstdint>
+# include <deque>
+# include <memory>
+# include <unordered_map>
+# include <vector>
+# include "HierarchicalPathfinder.hpp"
+# include "JobSystem.hpp"
+
+// Bounded multi-producer single-consumer ring (Vyukov's sequence-number
+// queue): workers push without locks, the main thread pops.
+template <typename T, size_t Capacity>
+class CompletionQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    CompletionQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells[pos & (Capacity - 1)];
+            intptr_t diff = intptr_t(c.seq.load(std::memory_order_acquire)) - intptr_t(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = value;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& value) {
+        Cell& c = cells[head & (Capacity - 1)];
+        if (c.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        value = c.value;
+        c.seq.store(head + Capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    Cell cells[Capacity];
+    alignas(64) std::atomic<size_t> tail {0};
+    alignas(64) size_t head = 0;
+};
+
+enum class PathPriority : uint8_t { Player, Ai };
+
+struct PathResult {
+    uint32_t ticket;
+    uint32_t cost; // HierarchicalPathfinder::kNoPath when unreachable
+    std::shared_ptr<const std::vector<uint32_t>> tiles; // shared by merged requests
+};
+
+// Queues path requests from unit orders and solves them with HPA* on the
+// job system's worker threads, never for longer than budgetMs per frame.
+// Identical (start, goal) requests share one search, solved paths are
+// cached until the NavGrid changes, and player orders go ahead of AI ones.
+//
+// Everything but the searches runs on the main thread. The NavGrid must
+// not be edited while a batch is in flight: call finish() first.
+class PathService {
+public:
+    PathService(const NavGrid& nav, HierarchicalPathfinder& finder, JobSystem& jobs);
+    ~PathService();
+
+    double budgetMs = 2.0;
+    size_t cacheCapacity = 4096;
+
+    // Returns a ticket that a later update() hands back with the path.
+    uint32_t request(uint32_t start, uint32_t goal, PathPriority priority);
+
+    // Once per frame: appends finished paths to `out` and hands the next
+    // batch to the workers. With no worker threads the batch runs here,
+    // still within the budget.
+    void update(std::vector<PathResult>& out);
+
+    // Waits for the batch in flight and appends its paths to `out`.
+    void finish(std::vector<PathResult>& out);
+
+    size_t queueDepth() const { return pending.size(); }
+    // Request-to-delivery time (p in 0..100) over the last kLatencySamples
+    // deliveries.
+    double latencyPercentileMs(double p) const;
+    double cacheHitRate() const { return requests ? double(cacheHits) / double(requests) : 0.0; }
+
+    size_t requests = 0;
+    size_t cacheHits = 0;
+    size_t merged = 0; // joined a search already queued or running
+    size_t solved = 0;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kMaxBatch = 256;
+    static constexpr size_t kLatencySamples = 4096;
+
+    struct Waiter {
+        uint32_t ticket;
+        Clock::time_point issued;
+    };
+    struct Pending {
+        std::vector<Waiter> waiters;
+        PathPriority priority;
+        bool inFlight = false;
+    };
+    struct Cached {
+        uint32_t cost;
+        std::shared_ptr<const std::vector<uint32_t>> tiles;
+    };
+    struct Hit {
+        Waiter waiter;
+        Cached path;
+    };
+    struct Slot {
+        uint64_t key;
+        uint32_t cost;
+        std::vector<uint32_t> tiles;
+    };
+    struct Worker {
+        PathService* service;
+        HierarchicalPathfinder::Query* query;
+    };
+
+    static uint64_t keyOf(uint32_t start, uint32_t goal) { return (uint64_t(start) << 32) | goal; }
+    static void runWorker(const Job& job);
+    void work(HierarchicalPathfinder::Query& query);
+    void dispatch();
+    void collect(std::vector<PathResult>& out);
+    void deliver(const Waiter& waiter, const Cached& path, std::vector<PathResult>& out);
+
+    const NavGrid& nav;
+    HierarchicalPathfinder& finder;
+    JobSystem& jobs;
+    uint64_t gridCursor = 0;
+    uint32_t nextTicket = 1;
+
+    std::unordered_map<uint64_t, Pending> pending;
+    std::deque<uint64_t> queues[2]; // by PathPriority
+    std::vector<Hit> hits;          // answered from the cache, delivered next update
+    std::unordered_map<uint64_t, Cached> cache;
+    std::deque<uint64_t> cacheOrder; // oldest first
+
+    // the batch in flight
+    std::vector<Slot> batch;
+    size_t batchSize = 0;
+    std::atomic<size_t> nextSlot {0};
+    Clock::time_point deadline;
+    JobCounter counter;
+    bool inFlight = false;
+    CompletionQueue<uint32_t, kMaxBatch> completed;
+    std::vector<std::unique_ptr<HierarchicalPathfinder::Query>> queries;
+    std::vector<Worker> workers;
+
+    std::vector<float> latencies;
+    size_t latencyNext = 0;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "Registry.hpp"
+
+Entity Registry::create() {
+    Entity e;
+    if (!freeList.empty()) {
+        e.index = freeList.back();
+        freeList.pop_back();
+    } else {
+        e.index = static_cast<uint32_t>(generations.size());
+        generations.push_back(0);
+    }
+    e.generation = generations[e.index];
+    ++aliveCount;
+    return e;
+}
+
+void Registry::destroy(Entity e) {
+    if (!alive(e)) {
+        return;
+    }
+    transforms.remove(e.index);
+    velocities.remove(e.index);
+    grounded.remove(e.index);
+    animations.remove(e.index);
+    colliders.remove(e.index);
+    sprites.remove(e.index);
+
+    ++generations[e.index];
+    freeList.push_back(e.index);
+    --aliveCount;
+}
+
+bool Registry::alive(Entity e) const {
+    return e.index < generations.size() && generations[e.index] == e.generation;
+}
+
+void Registry::reserve(size_t n) {
+    generations.reserve(n);
+    transforms.reserve(n);
+    velocities.reserve(n);
+    grounded.reserve(n);
+    animations.reserve(n);
+    colliders.reserve(n);
+    sprites.reserve(n);
+}
+
+bool Registry::kinematicsPacked() const {
+    if (packedVersions[0] == transforms.version &&
+        packedVersions[1] == velocities.version &&
+        packedVersions[2] == grounded.version) {
+        return packedCache;
+    }
+    packedVersions[0] = transforms.version;
+    packedVersions[1] = velocities.version;
+    packedVersions[2] = grounded.version;
+    packedCache = transforms.entities == velocities.entities &&
+                  transforms.entities == grounded.entities;
+    return packedCache;
+}
+
+bool Registry::consistent() const {
+    if (!transforms.consistent() || !velocities.consistent() || !grounded.consistent() ||
+        !animations.consistent() || !colliders.consistent() || !sprites.consistent()) {
+        return false;
+    }
+    const size_t slots = generations.size();
+    for (const std::vector<uint32_t>* rows : {&transforms.entities, &velocities.entities, &grounded.entities,
+                                              &animations.entities, &colliders.entities, &sprites.entities}) {
+        for (uint32_t e : *rows) {
+            if (e >= slots) {
+                return false;
+            }
+        }
+    }
+    for (uint32_t e : colliders.entities) {
+        if (!transforms.has(e)) {
+            return false;
+        }
+    }
+    for (uint32_t e : freeList) {
+        if (e >= slots) {
+            return false;
+        }
+    }
+    return true;
+}
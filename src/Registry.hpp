@@ -0,0 +1,238 @@
+#ifndef REGISTRY_HPP
+#define REGISTRY_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+static constexpr uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+// Stable handle to an entity. The generation is bumped every time a slot is
+// recycled, so handles to destroyed entities never alias new ones.
+struct Entity {
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const Entity& o) const { return !(*this == o); }
+};
+
+// Sparse set keyed by entity index. The component data lives in the Columns
+// base as parallel arrays (structure of arrays); rows stay densely packed
+// because removal swaps the last row into the hole.
+//
+// Rows are also grouped into chunks of kChunkRows with a dirty flag each.
+// Anything that writes component data marks the chunks it touched so the
+// state hasher only rehashes those. Concurrent writers must work on
+// disjoint chunks.
+template <typename Columns>
+class ComponentPool : public Columns {
+public:
+    static constexpr size_t kChunkRows = 1024;
+
+    std::vector<uint32_t> entities; // dense row -> entity index
+    std::vector<uint32_t> sparse;   // entity index -> dense row
+    std::vector<uint8_t> dirty;     // per chunk, cleared by StateHasher
+    uint64_t version = 0;           // bumped on every insert/remove
+
+    size_t size() const { return entities.size(); }
+    size_t chunkCount() const { return (entities.size() + kChunkRows - 1) / kChunkRows; }
+    bool has(uint32_t e) const { return e < sparse.size() && sparse[e] != kInvalidIndex; }
+    uint32_t row(uint32_t e) const { return sparse[e]; }
+
+    void markDirty(size_t r) { dirty[r / kChunkRows] = 1; }
+    void markDirty(size_t begin, size_t end) {
+        for (size_t c = begin / kChunkRows; c * kChunkRows < end; ++c) {
+            dirty[c] = 1;
+        }
+    }
+
+    uint32_t insert(uint32_t e) {
+        if (e >= sparse.size()) {
+            sparse.resize(e + 1, kInvalidIndex);
+        }
+        if (sparse[e] != kInvalidIndex) {
+            return sparse[e];
+        }
+        uint32_t r = static_cast<uint32_t>(entities.size());
+        entities.push_back(e);
+        sparse[e] = r;
+        this->forEachColumn([](auto& col) { col.emplace_back(); });
+        dirty.resize(chunkCount(), 1);
+        markDirty(r);
+        ++version;
+        return r;
+    }
+
+    void remove(uint32_t e) {
+        if (!has(e)) {
+            return;
+        }
+        uint32_t r = sparse[e];
+        uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+        if (r != last) {
+            this->forEachColumn([&](auto& col) { col[r] = col[last]; });
+            entities[r] = entities[last];
+            sparse[entities[r]] = r;
+        }
+        markDirty(r);
+        markDirty(last);
+        this->forEachColumn([](auto& col) { col.pop_back(); });
+        entities.pop_back();
+        dirty.resize(chunkCount());
+        sparse[e] = kInvalidIndex;
+        ++version;
+    }
+
+    // Saves or restores every array through a Snapshot archive. Loading
+    // bumps version instead of restoring it, so caches keyed on it never
+    // mistake the restored rows for ones they have already seen.
+    template <typename Archive>
+    void snapshot(Archive& ar) {
+        ar.array(entities);
+        ar.array(sparse);
+        ar.array(dirty);
+        this->forEachColumn([&](auto& col) { ar.array(col); });
+        if (Archive::kLoading) {
+            ++version;
+        }
+    }
+
+    // Rows, columns, dirty flags and the sparse array agree with each
+    // other. Pools restored from untrusted bytes must pass this before
+    // anything indexes them.
+    bool consistent() const {
+        const size_t n = entities.size();
+        bool ok = dirty.size() == chunkCount();
+        const_cast<ComponentPool*>(this)->forEachColumn([&](const auto& col) { ok = ok && col.size() == n; });
+        size_t mapped = 0;
+        for (uint32_t r : sparse) {
+            if (r != kInvalidIndex) {
+                ok = ok && r < n;
+                ++mapped;
+            }
+        }
+        if (!ok || mapped != n) {
+            return false;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            if (entities[r] >= sparse.size() || sparse[entities[r]] != r) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void reserve(size_t n) {
+        entities.reserve(n);
+        dirty.reserve((n + kChunkRows - 1) / kChunkRows);
+        this->forEachColumn([&](auto& col) { col.reserve(n); });
+    }
+};
+
+struct TransformColumns {
+    std::vector<float> x, y, z;
+    std::vector<float> height;
+
+    template <typename F> void forEachColumn(F&& f) { f(x); f(y); f(z); f(height); }
+};
+
+struct VelocityColumns {
+    std::vector<float> x, y, z;
+    std::vector<float> gravity;
+    std::vector<float> jumpForce;
+
+    template <typename F> void forEachColumn(F&& f) { f(x); f(y); f(z); f(gravity); f(jumpForce); }
+};
+
+struct GroundedColumns {
+    std::vector<float> floorY;
+    std::vector<uint8_t> grounded;
+
+    template <typename F> void forEachColumn(F&& f) { f(floorY); f(grounded); }
+};
+
+// Playback state of an AnimationLibrary clip. The clip's frame count and
+// duration and the facing's UV table base are copied in by playClip(), so
+// the per-tick update streams these arrays without any table lookups.
+struct AnimationColumns {
+    std::vector<uint16_t> clip;        // AnimationLibrary clip id
+    std::vector<uint8_t> facing;       // 0..7 clockwise from up the screen
+    std::vector<int32_t> frameIndex;
+    std::vector<float> frameTimer;
+    std::vector<int32_t> frameCount;
+    std::vector<float> frameDuration;  // 0 for a still pose
+    std::vector<uint32_t> uvBase;      // UV table index of frame 0; add frameIndex
+
+    template <typename F> void forEachColumn(F&& f) {
+        f(clip); f(facing); f(frameIndex); f(frameTimer);
+        f(frameCount); f(frameDuration); f(uvBase);
+    }
+};
+
+struct ColliderColumns {
+    std::vector<float> radius; // circle on the XZ plane
+
+    template <typename F> void forEachColumn(F&& f) { f(radius); }
+};
+
+struct SpriteColumns {
+    std::vector<uint16_t> sheet; // index into the renderer's sprite sheet table
+
+    template <typename F> void forEachColumn(F&& f) { f(sheet); }
+};
+
+using TransformPool = ComponentPool<TransformColumns>;
+using VelocityPool = ComponentPool<VelocityColumns>;
+using GroundedPool = ComponentPool<GroundedColumns>;
+using AnimationPool = ComponentPool<AnimationColumns>;
+using ColliderPool = ComponentPool<ColliderColumns>;
+using SpritePool = ComponentPool<SpriteColumns>;
+
+class Registry {
+public:
+    TransformPool transforms;
+    VelocityPool velocities;
+    GroundedPool grounded;
+    AnimationPool animations;
+    ColliderPool colliders;
+    SpritePool sprites;
+
+    Entity create();
+    void destroy(Entity e);
+    bool alive(Entity e) const;
+    size_t count() const { return aliveCount; }
+    void reserve(size_t n);
+
+    // True when transforms, velocities and grounded hold the same entities in
+    // the same row order, so the kinematics system can walk them with a
+    // single row index instead of going through the sparse arrays.
+    bool kinematicsPacked() const;
+
+    // Every pool is consistent(), names only allocated entity slots, and
+    // each collider has the transform the separation pass looks up.
+    bool consistent() const;
+
+    template <typename Archive>
+    void snapshot(Archive& ar) {
+        transforms.snapshot(ar);
+        velocities.snapshot(ar);
+        grounded.snapshot(ar);
+        animations.snapshot(ar);
+        colliders.snapshot(ar);
+        sprites.snapshot(ar);
+        ar.array(generations);
+        ar.array(freeList);
+        ar.value(aliveCount);
+    }
+
+private:
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeList;
+    size_t aliveCount = 0;
+
+    mutable uint64_t packedVersions[3] = {~0ull, ~0ull, ~0ull};
+    mutable bool packedCache = false;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "RenderQueue.hpp"
+#include "JobSystem.hpp"
+#include <cstring>
+
+// Bounding sphere radius of a unit billboard quad
+static const float kSpriteRadius = 0.75f;
+
+void RenderQueue::prepare(const Registry& reg, const glm::mat4& viewProj, const glm::vec3& cameraPos) {
+    // Frustum planes from the combined matrix (Gribb/Hartmann)
+    glm::mat4 m = glm::transpose(viewProj);
+    planes[0] = m[3] + m[0];
+    planes[1] = m[3] - m[0];
+    planes[2] = m[3] + m[1];
+    planes[3] = m[3] - m[1];
+    planes[4] = m[3] + m[2];
+    planes[5] = m[3] - m[2];
+    for (glm::vec4& p : planes) {
+        p /= glm::length(glm::vec3(p));
+    }
+    eye = cameraPos;
+    keys.resize(reg.sprites.size());
+}
+
+void RenderQueue::keyRows(const Registry& reg, size_t begin, size_t end) {
+    const SpritePool& sp = reg.sprites;
+    const TransformPool& tp = reg.transforms;
+    for (size_t i = begin; i < end; ++i) {
+        uint32_t e = sp.entities[i];
+        if (!tp.has(e)) {
+            keys[i] = kCulled;
+            continue;
+        }
+        uint32_t t = tp.row(e);
+        glm::vec3 p(tp.x[t], tp.y[t], tp.z[t]);
+
+        bool visible = true;
+        for (const glm::vec4& pl : planes) {
+            if (glm::dot(glm::vec3(pl), p) + pl.w < -kSpriteRadius) {
+                visible = false;
+                break;
+            }
+        }
+        if (!visible) {
+            keys[i] = kCulled;
+            continue;
+        }
+
+        // Farthest first: invert the (positive) distance bits so an
+        // ascending sort yields back-to-front order. Row in the low half.
+        glm::vec3 d = p - eye;
+        float dist2 = glm::dot(d, d);
+        uint32_t bits;
+        std::memcpy(&bits, &dist2, sizeof(bits));
+        keys[i] = (uint64_t(~bits) << 32) | uint32_t(i);
+    }
+}
+
+void RenderQueue::finish() {
+    depth.sort(keys, order);
+}
+
+void RenderQueue::build(const Registry& reg, const glm::mat4& viewProj, const glm::vec3& cameraPos,
+                        JobSystem& jobs) {
+    prepare(reg, viewProj, cameraPos);
+    JobCounter counter;
+    auto cull = [&](size_t b, size_t e) { keyRows(reg, b, e); };
+    jobs.parallelFor(counter, 0, reg.sprites.size(), 4096, cull);
+    jobs.wait(counter);
+    finish();
+}
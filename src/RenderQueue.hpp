@@ -0,0 +1,38 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+# include <cstdint>
+# include <vector>
+# include <glm/glm.hpp>
+# include "DepthOrder.hpp"
+# include "Registry.hpp"
+
+class JobSystem;
+
+// Per-frame list of visible sprites in draw order. Culling and sort-key
+// generation run in parallel over the sprite pool; the surviving keys are
+// ordered on the calling thread by a DepthOrder, which repairs the last
+// frame's order instead of sorting from scratch.
+class RenderQueue {
+public:
+    static constexpr uint64_t kCulled = DepthOrder::kCulled;
+
+    std::vector<uint32_t> order; // sprite pool rows, back to front
+    DepthOrder depth;
+
+    void build(const Registry& reg, const glm::mat4& viewProj, const glm::vec3& cameraPos,
+               JobSystem& jobs);
+
+    // Culls and computes keys for sprite rows [begin, end); safe to call
+    // concurrently for disjoint ranges once prepare() has run.
+    void prepare(const Registry& reg, const glm::mat4& viewProj, const glm::vec3& cameraPos);
+    void keyRows(const Registry& reg, size_t begin, size_t end);
+    void finish();
+
+private:
+    glm::vec4 planes[6];
+    glm::vec3 eye {0.0f};
+    std::vector<uint64_t> keys; // per sprite row, kCulled when invisible
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "Replay.hpp"
+#include "Snapshot.hpp"
+#include <fstream>
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && pos < in.size(); shift += 7) {
+        uint8_t b = in[pos++];
+        v |= uint32_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---- file io -------------------------------------------------------------
+
+template <typename T>
+static void put(std::ofstream& f, const T& v) {
+    f.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static void putArray(std::ofstream& f, const std::vector<T>& v) {
+    put(f, uint64_t(v.size()));
+    f.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+static bool get(std::ifstream& f, T& v) {
+    return bool(f.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+// bytes between the read position and `size`, the length of the file
+static uint64_t remaining(std::ifstream& f, uint64_t size) {
+    uint64_t at = uint64_t(f.tellg());
+    return at < size ? size - at : 0;
+}
+
+template <typename T>
+static bool getArray(std::ifstream& f, std::vector<T>& v, uint64_t size) {
+    uint64_t n;
+    if (!get(f, n) || n > remaining(f, size) / sizeof(T)) {
+        return false;
+    }
+    v.resize(n);
+    return bool(f.read(reinterpret_cast<char*>(v.data()), n * sizeof(T)));
+}
+
+bool Replay::save(const std::string& path) const {
+    std::ofstream f(path, std::ios::binary);
+    if (!f) {
+        return false;
+    }
+    put(f, kMagic);
+    put(f, int32_t(playerCount));
+    put(f, int32_t(extraUnits));
+    put(f, seed);
+    put(f, tickCount);
+    putArray(f, stream);
+    put(f, uint32_t(keyframes.size()));
+    for (const Keyframe& kf : keyframes) {
+        put(f, kf.tick);
+        put(f, kf.checksum);
+        put(f, kf.offset);
+        putArray(f, kf.commands);
+        putArray(f, kf.state);
+    }
+    return bool(f);
+}
+
+// Every animation row indexes the clip library and its UV table safely:
+// a known clip (or none) and facing, the clip's own frame count, a frame
+// inside it and the UV base playClip() would have set.
+static bool validAnimations(const AnimationPool& ap, const AnimationLibrary& clips) {
+    for (size_t a = 0; a < ap.size(); ++a) {
+        const uint16_t clip = ap.clip[a];
+        if (ap.facing[a] >= AnimationClip::kFacings || ap.frameCount[a] < 1 || ap.frameIndex[a] < 0 ||
+            ap.frameIndex[a] >= ap.frameCount[a] ||
+            uint64_t(ap.uvBase[a]) + uint64_t(ap.frameCount[a]) > clips.uvCount()) {
+            return false;
+        }
+        if (clip == AnimationLibrary::kNoClip) {
+            continue;
+        }
+        if (clip >= clips.clipCount() || ap.frameCount[a] != clips.clip(clip).frames ||
+            ap.uvBase[a] != clips.uvIndex(clip, ap.facing[a], 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Restores a loaded keyframe into `scratch` and checks it is a state
+// step() can run from: the bytes match the snapshot layout exactly, the
+// pools are consistent, the players are the recorded ones and alive, the
+// animation rows fit scratch.clips, and the world and the restored
+// per-chunk hashes match the stored checksum.
+static bool validKeyframe(const Replay::Keyframe& kf, int playerCount, Simulation& scratch) {
+    SnapshotReader reader{kf.state.data(), kf.state.data() + kf.state.size()};
+    scratch.snapshot(reader);
+    if (!reader.complete() || !scratch.world.consistent() || scratch.tick != kf.tick ||
+        scratch.checksum != kf.checksum || scratch.players.size() != size_t(playerCount)) {
+        return false;
+    }
+    const Registry& w = scratch.world;
+    if (!validAnimations(w.animations, scratch.clips)) {
+        return false;
+    }
+    for (const PlayerState& p : scratch.players) {
+        uint32_t e = p.entity.index;
+        if (!w.alive(p.entity) || !w.transforms.has(e) || !w.velocities.has(e) || !w.grounded.has(e) ||
+            !w.animations.has(e)) {
+            return false;
+        }
+    }
+    StateHasher fresh;
+    return fresh.update(scratch.world, true) == kf.checksum && scratch.hasher.checksum() == kf.checksum &&
+           fresh.firstDivergence(scratch.hasher).empty();
+}
+
+bool Replay::load(const std::string& path, const AnimationLibrary& clips) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) {
+        return false;
+    }
+    const uint64_t size = uint64_t(f.tellg());
+    f.seekg(0);
+    uint32_t magic = 0, keyframeCount = 0;
+    int32_t players = 0, extra = 0;
+    if (!get(f, magic) || magic != kMagic) {
+        return false;
+    }
+    if (!get(f, players) || !get(f, extra) || !get(f, seed) || !get(f, tickCount) ||
+        !getArray(f, stream, size) || !get(f, keyframeCount)) {
+        return false;
+    }
+    if (players < 1 || players > 8) {
+        return false;
+    }
+    // tick, checksum, offset and two array lengths at the least
+    const uint64_t minKeyframe = 4 + 8 + 8 + 8 + 8;
+    if (keyframeCount > remaining(f, size) / minKeyframe) {
+        return false;
+    }
+    playerCount = players;
+    extraUnits = extra;
+    keyframes.resize(keyframeCount);
+    Simulation scratch;
+    scratch.clips = clips;
+    for (size_t k = 0; k < keyframes.size(); ++k) {
+        Keyframe& kf = keyframes[k];
+        if (!get(f, kf.tick) || !get(f, kf.checksum) || !get(f, kf.offset) ||
+            !getArray(f, kf.commands, size) || !getArray(f, kf.state, size) ||
+            kf.commands.size() != size_t(playerCount) || kf.offset > stream.size()) {
+            return false;
+        }
+        // seeking assumes keyframes in tick order within the recording
+        if (kf.tick > tickCount || (k > 0 && kf.tick <= keyframes[k - 1].tick)) {
+            return false;
+        }
+        if (!validKeyframe(kf, playerCount, scratch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---- recording -----------------------------------------------------------
+
+void ReplayRecorder::begin(Simulation& sim, int extraUnits, uint32_t seed, uint32_t keyframeInterval) {
+    replay = Replay();
+    replay.playerCount = static_cast<int>(sim.players.size());
+    replay.extraUnits = extraUnits;
+    replay.seed = seed;
+    current.assign(sim.players.size(), PlayerCommand());
+    run = 0;
+    interval = keyframeInterval ? keyframeInterval : 1;
+}
+
+void ReplayRecorder::flushRun(uint8_t mask, const PlayerCommand* commands) {
+    putVarint(replay.stream, run);
+    replay.stream.push_back(mask);
+    for (size_t p = 0; p < current.size(); ++p) {
+        if (mask & (1u << p)) {
+            replay.stream.push_back(commands[p].buttons);
+        }
+    }
+    run = 0;
+}
+
+void ReplayRecorder::record(Simulation& sim, const PlayerCommand* commands) {
+    if (replay.tickCount % interval == 0) {
+        // close the open record so decoding can start right here
+        if (run > 0) {
+            flushRun(0, nullptr);
+        }
+        Replay::Keyframe kf;
+        kf.tick = replay.tickCount;
+        kf.checksum = sim.checksum;
+        kf.offset = replay.stream.size();
+        kf.commands = current;
+        SnapshotSizer sizer;
+        sim.snapshot(sizer);
+        kf.state.resize(sizer.bytes);
+        SnapshotWriter writer{kf.state.data()};
+        sim.snapshot(writer);
+        replay.keyframes.push_back(std::move(kf));
+    }
+
+    uint8_t mask = 0;
+    for (size_t p = 0; p < current.size(); ++p) {
+        if (!(commands[p] == current[p])) {
+            mask |= static_cast<uint8_t>(1u << p);
+        }
+    }
+    if (mask) {
+        flushRun(mask, commands);
+        for (size_t p = 0; p < current.size(); ++p) {
+            current[p] = commands[p];
+        }
+    } else {
+        ++run;
+    }
+    ++replay.tickCount;
+}
+
+const Replay& ReplayRecorder::finish() {
+    if (run > 0) {
+        flushRun(0, nullptr);
+    }
+    return replay;
+}
+
+// ---- playback ------------------------------------------------------------
+
+void ReplayPlayer::restore(const Replay::Keyframe& kf, Simulation& sim) {
+    // loaded replays were checked by validKeyframe(), recorded ones are ours
+    SnapshotReader reader{kf.state.data(), kf.state.data() + kf.state.size()};
+    sim.snapshot(reader);
+    offset = kf.offset;
+    current = kf.commands;
+    pendingRun = 0;
+    pendingChange = false;
+    tick = kf.tick;
+}
+
+void ReplayPlayer::start(const Replay& r, Simulation& sim) {
+    replay = &r;
+    sim.init(r.playerCount, r.extraUnits, r.seed);
+    staged.assign(r.playerCount, PlayerCommand());
+    commands.assign(r.playerCount, PlayerCommand());
+    desyncTick = ~0u;
+    if (!r.keyframes.empty()) {
+        restore(r.keyframes[0], sim);
+        nextKeyframe = 1;
+    } else {
+        offset = 0;
+        current.assign(r.playerCount, PlayerCommand());
+        pendingRun = 0;
+        pendingChange = false;
+        tick = 0;
+        nextKeyframe = 0;
+    }
+}
+
+bool ReplayPlayer::next(PlayerCommand* out) {
+    if (!replay || tick >= replay->tickCount) {
+        return false;
+    }
+    const std::vector<uint8_t>& in = replay->stream;
+    while (pendingRun == 0 && !pendingChange) {
+        uint32_t run;
+        if (!getVarint(in, offset, run) || offset >= in.size()) {
+            return false;
+        }
+        stagedMask = in[offset++];
+        for (size_t p = 0; p < current.size(); ++p) {
+            if (stagedMask & (1u << p)) {
+                if (offset >= in.size()) {
+                    return false;
+                }
+                staged[p].buttons = in[offset++];
+            }
+        }
+        pendingRun = run;
+        pendingChange = stagedMask != 0;
+    }
+    if (pendingRun > 0) {
+        --pendingRun;
+    } else {
+        for (size_t p = 0; p < current.size(); ++p) {
+            if (stagedMask & (1u << p)) {
+                current[p] = staged[p];
+            }
+        }
+        pendingChange = false;
+    }
+    for (size_t p = 0; p < current.size(); ++p) {
+        out[p] = current[p];
+    }
+    ++tick;
+    return true;
+}
+
+bool ReplayPlayer::step(Simulation& sim, JobSystem* jobs) {
+    const std::vector<Replay::Keyframe>& kfs = replay->keyframes;
+    if (nextKeyframe < kfs.size() && kfs[nextKeyframe].tick == tick) {
+        if (sim.checksum != kfs[nextKeyframe].checksum && desyncTick == ~0u) {
+            desyncTick = tick;
+        }
+        ++nextKeyframe;
+    }
+    if (!next(commands.data())) {
+        return false;
+    }
+    sim.step(commands.data(), jobs);
+    return true;
+}
+
+bool ReplayPlayer::seek(Simulation& sim, uint32_t target, JobSystem* jobs) {
+    const std::vector<Replay::Keyframe>& kfs = replay->keyframes;
+    if (target > replay->tickCount) {
+        return false;
+    }
+    // jump back to a keyframe unless the target is still ahead in this segment
+    size_t k = kfs.size();
+    while (k > 0 && kfs[k - 1].tick > target) {
+        --k;
+    }
+    if (k > 0 && (target < tick || kfs[k - 1].tick > tick)) {
+        restore(kfs[k - 1], sim);
+        nextKeyframe = k;
+    } else if (target < tick) {
+        return false;
+    }
+    while (tick < target) {
+        if (!step(sim, jobs)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <vector>
+# include "Simulation.hpp"
+
+class JobSystem;
+
+// A recorded session: the Simulation::init arguments, every tick's player
+// commands as a delta-encoded stream, and full-state keyframes every few
+// seconds. Since the simulation is deterministic the commands alone
+// reproduce the session; keyframes only make seeking cheap and let
+// playback verify it is still in sync.
+//
+// Stream records: varint run, u8 mask, then one button byte per set mask
+// bit. A record means "repeat the current commands for `run` ticks, then
+// (if mask != 0) one tick with the masked players' buttons replaced".
+// Recording starts a fresh record at every keyframe so decoding can begin
+// there.
+struct Replay {
+    static constexpr uint32_t kMagic = 0x31505252; // "RRP1"
+
+    int playerCount = 1;
+    int extraUnits = 0;
+    uint32_t seed = 0;
+    uint32_t tickCount = 0;
+    std::vector<uint8_t> stream;
+
+    struct Keyframe {
+        uint32_t tick = 0;
+        uint64_t checksum = 0;
+        uint64_t offset = 0;                 // stream position of this tick
+        std::vector<PlayerCommand> commands; // current commands at offset
+        std::vector<uint8_t> state;          // Simulation::snapshot bytes
+    };
+    std::vector<Keyframe> keyframes;
+
+    // Binary file in native byte order. load() refuses files whose
+    // keyframes do not fit `clips`, the library playback will run with.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, const AnimationLibrary& clips);
+};
+
+class ReplayRecorder {
+public:
+    // Starts recording a simulation that was just init()ed with these
+    // arguments; a keyframe is taken every `keyframeInterval` ticks.
+    void begin(Simulation& sim, int extraUnits, uint32_t seed, uint32_t keyframeInterval = 600);
+
+    // Call once per tick with the commands about to be passed to step().
+    void record(Simulation& sim, const PlayerCommand* commands);
+
+    // Flushes the pending run; the replay is complete afterwards.
+    const Replay& finish();
+
+    Replay replay;
+
+private:
+    void flushRun(uint8_t mask, const PlayerCommand* commands);
+
+    std::vector<PlayerCommand> current;
+    uint32_t run = 0;
+    uint32_t interval = 600;
+};
+
+class ReplayPlayer {
+public:
+    // Initialises sim from the replay header and rewinds to tick 0.
+    void start(const Replay& replay, Simulation& sim);
+
+    // Decodes and runs the next tick; false at the end of the replay.
+    // Keyframe checksums are compared as they are passed.
+    bool step(Simulation& sim, JobSystem* jobs = nullptr);
+
+    // Restores the nearest keyframe at or before `tick` and runs headless
+    // up to it.
+    bool seek(Simulation& sim, uint32_t tick, JobSystem* jobs = nullptr);
+
+    // Commands for the next tick without running it (for a live game that
+    // wants to drive its own step).
+    bool next(PlayerCommand* out);
+
+    uint32_t currentTick() const { return tick; }
+    uint32_t desyncTick = ~0u; // first keyframe tick that failed to match
+
+private:
+    void restore(const Replay::Keyframe& kf, Simulation& sim);
+
+    const Replay* replay = nullptr;
+    size_t offset = 0;
+    uint32_t pendingRun = 0;
+    bool pendingChange = false;
+    uint8_t stagedMask = 0;
+    uint32_t tick = 0;
+    size_t nextKeyframe = 0;
+    std::vector<PlayerCommand> current, staged, commands;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "ShadowBatch.hpp"
+
+void ShadowBatch::build(const Registry& reg, const std::vector<uint32_t>& order) {
+    const SpritePool& sp = reg.sprites;
+    const TransformPool& tp = reg.transforms;
+    const GroundedPool& gp = reg.grounded;
+
+    instances.clear();
+    for (uint32_t i : order) {
+        uint32_t e = sp.entities[i];
+        if (!tp.has(e) || !gp.has(e)) {
+            continue;
+        }
+        uint32_t t = tp.row(e);
+        uint32_t g = gp.row(e);
+        bool grounded = gp.grounded[g] != 0;
+
+        ShadowInstance s;
+        s.x = tp.x[t];
+        // just above the floor to avoid z-fighting
+        s.y = gp.floorY[g] + 0.01f;
+        s.z = tp.z[t];
+        // shrink and soften shadow while airborne
+        s.sx = grounded ? 0.8f : 0.5f;
+        s.sz = grounded ? 0.5f : 0.3f;
+        s.alpha = grounded ? 1.0f : 0.55f;
+        instances.push_back(s);
+    }
+}
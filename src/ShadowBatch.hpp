@@ -0,0 +1,26 @@
+#ifndef SHADOWBATCH_HPP
+#define SHADOWBATCH_HPP
+
+# include <cstdint>
+# include <vector>
+# include "Registry.hpp"
+
+// One blob shadow, streamed as per-instance attributes: a quad lying on
+// the XZ plane at the unit's floor height.
+struct ShadowInstance {
+    float x, y, z;
+    float sx, sz; // quad size along x and z
+    float alpha;
+};
+
+// Blob shadows of every listed sprite, sized and faded by whether the
+// unit stands on the ground, so the renderer can draw them all at once.
+class ShadowBatch {
+public:
+    std::vector<ShadowInstance> instances;
+
+    // `order` holds sprite pool rows, as in RenderQueue::order.
+    void build(const Registry& reg, const std::vector<uint32_t>& order);
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "Simulation.hpp"
+#include "JobSystem.hpp"
+#include <cmath>
+
+void Simulation::init(int playerCount, int extraUnits, uint32_t seed) {
+    world = Registry();
+    players.clear();
+    tick = 0;
+
+    if (clips.empty()) {
+        clips.loadDefaults();
+    }
+    idleClip = clips.find("idle");
+    walkClip = clips.find("walk");
+    if (walkClip == AnimationLibrary::kNoClip) {
+        walkClip = idleClip;
+    }
+
+    // 10x10 floor centred on the origin with gentle hills
+    terrain.create(32, 32, 10.0f / 32.0f, -5.0f, -5.0f);
+    terrain.generate(seed, 0.25f);
+
+    for (int i = 0; i < playerCount; ++i) {
+        glm::vec3 pos(float(i) * 1.0f, 0.5f, 0.0f);
+        PlayerState p;
+        p.entity = spawnUnit(world, pos, 0);
+        setFloorHeight(world, p.entity, terrain.heightAt(pos.x, pos.z));
+        playClip(world, clips, p.entity, idleClip, 0);
+        players.push_back(p);
+    }
+
+    // Idle units on rings around the origin to bump into
+    for (int i = 0; i < extraUnits; ++i) {
+        int ring = i / 8;
+        float a = glm::radians(45.0f * float(i % 8) + 22.5f * float(ring % 2));
+        float r = 2.5f + 0.7f * float(ring);
+        glm::vec3 pos(r * std::cos(a), 0.5f, r * std::sin(a));
+        Entity unit = spawnUnit(world, pos, 0);
+        setFloorHeight(world, unit, terrain.heightAt(pos.x, pos.z));
+        playClip(world, clips, unit, idleClip, 0);
+    }
+    hasher = StateHasher();
+    checksum = hasher.update(world, true);
+}
+
+void Simulation::applyCommand(PlayerState& player, PlayerCommand cmd, float dt) {
+    const float speed = 3.0f;
+
+    // Forward and right projected onto ground plane
+    glm::vec3 cameraPos = glm::vec3(5,5,5);
+    glm::vec3 cameraTarget = glm::vec3(0,0,0);
+
+    glm::vec3 forward = glm::normalize(glm::vec3(cameraTarget - cameraPos));
+    forward.y = 0.0f;
+    forward = glm::normalize(forward);
+
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0,1,0)));
+
+    bool moving = false;
+
+    glm::vec3 move(0.0f);
+    glm::vec2 dir2(0.0f, 0.0f);
+    if (cmd.buttons & PlayerCommand::Forward) {
+        move += forward * speed * dt;
+        moving = true;
+        dir2.y += 1.0f;
+    }
+    if (cmd.buttons & PlayerCommand::Back) {
+        move -= forward * speed * dt;
+        moving = true;
+        dir2.y -= 1.0f;
+    }
+    if (cmd.buttons & PlayerCommand::Left) {
+        move -= right * speed * dt;
+        moving = true;
+        dir2.x -= 1.0f;
+    }
+    if (cmd.buttons & PlayerCommand::Right) {
+        move += right * speed * dt;
+        moving = true;
+        dir2.x += 1.0f;
+    }
+
+    translate(world, player.entity, move);
+
+    // Handle jump
+    if (cmd.buttons & PlayerCommand::Jump) {
+        jump(world, player.entity);
+    }
+
+    // track last non-zero move direction for idle facing selection
+    if (glm::length(dir2) > 0.001f) {
+        player.lastMoveDir = glm::normalize(dir2);
+    }
+
+    // rows and mirroring per facing come from the clip data
+    int facing = facingFromDirection(player.lastMoveDir.x, player.lastMoveDir.y);
+    playClip(world, clips, player.entity, moving ? walkClip : idleClip, facing);
+}
+
+void Simulation::step(const PlayerCommand* commands, JobSystem* jobs) {
+    const float dt = kTickDt;
+    for (size_t i = 0; i < players.size(); ++i) {
+        applyCommand(players[i], commands[i], dt);
+    }
+
+    if (jobs && world.kinematicsPacked()) {
+        // Animation and kinematics touch disjoint pools, so both phases are
+        // split into chunks and run together; this thread helps until done.
+        JobCounter phase;
+        auto animate = [&](size_t b, size_t e) { animationRows(world, dt, b, e); };
+        auto integrate = [&](size_t b, size_t e) {
+            groundHeightRows(world, terrain, b, e);
+            kinematicsRows(world, dt, b, e);
+        };
+        jobs->parallelFor(phase, 0, world.animations.size(), 4096, animate);
+        jobs->parallelFor(phase, 0, world.transforms.size(), 4096, integrate);
+        jobs->wait(phase);
+    } else {
+        animationSystem(world, dt);
+        groundHeightSystem(world, terrain);
+        kinematicsSystem(world, dt);
+    }
+
+    // unit-vs-unit collision on the ground plane
+    separationSystem(world, separation);
+    checksum = hasher.update(world);
+    ++tick;
+}
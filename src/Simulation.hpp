@@ -0,0 +1,85 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+# include <cstdint>
+# include <vector>
+# include <glm/glm.hpp>
+# include "Animation.hpp"
+# include "Heightfield.hpp"
+# include "Registry.hpp"
+# include "StateHash.hpp"
+# include "Systems.hpp"
+
+class JobSystem;
+
+// Everything a player can do in one tick. This is all that lockstep peers
+// exchange, so it stays a few bytes no matter how many units exist.
+struct PlayerCommand {
+    enum : uint8_t {
+        Forward = 1 << 0,
+        Back    = 1 << 1,
+        Left    = 1 << 2,
+        Right   = 1 << 3,
+        Jump    = 1 << 4,
+    };
+    uint8_t buttons = 0;
+
+    bool operator==(const PlayerCommand& o) const { return buttons == o.buttons; }
+};
+
+struct PlayerState {
+    Entity entity;
+    // last move direction used to determine facing row when idle
+    glm::vec2 lastMoveDir {0.0f, 1.0f};
+};
+
+// Deterministic game simulation advanced in fixed ticks from player
+// commands only. Given the same build, the same init() arguments and the
+// same command stream, every run produces bit-identical state: the tick
+// length is fixed, FP contraction is disabled, parallel phases only write
+// disjoint rows and order-dependent passes (separation) run serially.
+class Simulation {
+public:
+    static constexpr float kTickDt = 1.0f / 60.0f;
+
+    Registry world;
+    Heightfield terrain;
+    // Static data, not part of the state: load before init() to replace
+    // the built-in clips. Every peer must use the same definitions.
+    AnimationLibrary clips;
+    SeparationState separation;
+    std::vector<PlayerState> players;
+    uint32_t tick = 0;
+
+    // Incremental checksum of the world after the latest tick; peers and
+    // replays compare this one value per tick.
+    StateHasher hasher;
+    uint64_t checksum = 0;
+
+    // Builds the 10x10 terrain, one unit per player and `extraUnits` idle
+    // units laid out from `seed`.
+    void init(int playerCount, int extraUnits, uint32_t seed);
+
+    // Advances one tick; commands holds one entry per player. With a job
+    // system the row-parallel phases are spread across its threads.
+    void step(const PlayerCommand* commands, JobSystem* jobs = nullptr);
+
+    // Everything step() reads besides the static terrain. The separation
+    // scratch is rebuilt every tick and is not part of the state.
+    template <typename Archive>
+    void snapshot(Archive& ar) {
+        world.snapshot(ar);
+        hasher.snapshot(ar);
+        ar.array(players);
+        ar.value(tick);
+        ar.value(checksum);
+    }
+
+private:
+    void applyCommand(PlayerState& player, PlayerCommand cmd, float dt);
+
+    uint16_t idleClip = AnimationLibrary::kNoClip;
+    uint16_t walkClip = AnimationLibrary::kNoClip;
+};
+
+#endif
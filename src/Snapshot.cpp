@@ -0,0 +1,55 @@
+#include "Snapshot.hpp"
+
+// Bytes per entity across every pool column, sparse entry and generation,
+// rounded up; used only to presize the arenas.
+static constexpr size_t kBytesPerEntity = 128;
+static constexpr size_t kSlack = 4096;
+
+void SnapshotRing::reserve(size_t count, size_t entities, size_t players) {
+    slots.resize(count);
+    size_t bytes = entities * kBytesPerEntity + players * sizeof(PlayerState) + kSlack;
+    for (Slot& s : slots) {
+        s.arena.resize(bytes);
+        s.tick = ~0u;
+    }
+    next = 0;
+}
+
+void SnapshotRing::save(Simulation& sim) {
+    if (slots.empty()) {
+        reserve(1, sim.world.count(), sim.players.size());
+    }
+    SnapshotSizer sizer;
+    sim.snapshot(sizer);
+
+    Slot& slot = slots[next];
+    next = (next + 1) % slots.size();
+    if (slot.arena.size() < sizer.bytes) {
+        // world outgrew the reservation: grow once, then stay put
+        slot.arena.resize(sizer.bytes + sizer.bytes / 4);
+    }
+    SnapshotWriter writer{slot.arena.data()};
+    sim.snapshot(writer);
+    slot.used = sizer.bytes;
+    slot.tick = sim.tick;
+    lastBytes = sizer.bytes;
+}
+
+const SnapshotRing::Slot* SnapshotRing::find(uint32_t tick) const {
+    for (const Slot& s : slots) {
+        if (s.tick == tick) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+bool SnapshotRing::restore(uint32_t tick, Simulation& sim) const {
+    const Slot* slot = find(tick);
+    if (!slot) {
+        return false;
+    }
+    SnapshotReader reader{slot->arena.data(), slot->arena.data() + slot->used};
+    sim.snapshot(reader);
+    return true;
+}
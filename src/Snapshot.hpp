@@ -0,0 +1,113 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <type_traits>
+# include <vector>
+# include "Simulation.hpp"
+
+// Archives passed to the snapshot(ar) members of Registry, ComponentPool,
+// StateHasher and Simulation. Every array is one memcpy of its SoA column;
+// only trivially copyable element types are allowed.
+
+// Counts the bytes a save needs.
+struct SnapshotSizer {
+    static constexpr bool kLoading = false;
+    size_t bytes = 0;
+
+    template <typename T> void value(const T&) { bytes += sizeof(T); }
+    template <typename T> void array(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot arrays must be POD");
+        bytes += sizeof(uint64_t) + v.size() * sizeof(T);
+    }
+};
+
+struct SnapshotWriter {
+    static constexpr bool kLoading = false;
+    uint8_t* out;
+
+    template <typename T> void value(const T& v) {
+        std::memcpy(out, &v, sizeof(T));
+        out += sizeof(T);
+    }
+    template <typename T> void array(const std::vector<T>& v) {
+        uint64_t n = v.size();
+        value(n);
+        if (n) {
+            std::memcpy(out, v.data(), n * sizeof(T));
+            out += n * sizeof(T);
+        }
+    }
+};
+
+// Restoring into vectors that already have the capacity (any world that
+// has been that large before) does not allocate. Reads stop at `end`: a
+// value or array that would run past it is skipped (arrays come back
+// empty) and clears ok, so bytes from a file can be walked safely and
+// checked with complete() afterwards.
+struct SnapshotReader {
+    static constexpr bool kLoading = true;
+    const uint8_t* in;
+    const uint8_t* end;
+    bool ok = true;
+
+    template <typename T> void value(T& v) {
+        if (!ok || size_t(end - in) < sizeof(T)) {
+            ok = false;
+            return;
+        }
+        std::memcpy(&v, in, sizeof(T));
+        in += sizeof(T);
+    }
+    template <typename T> void array(std::vector<T>& v) {
+        uint64_t n = 0;
+        value(n);
+        if (!ok || n > size_t(end - in) / sizeof(T)) {
+            ok = false;
+            v.clear();
+            return;
+        }
+        v.resize(n);
+        if (n) {
+            std::memcpy(v.data(), in, n * sizeof(T));
+            in += n * sizeof(T);
+        }
+    }
+    // every read fitted and the bytes were used up exactly
+    bool complete() const { return ok && in == end; }
+};
+
+// Fixed ring of preallocated snapshot buffers for rollback and replay
+// seeking. Each slot is one arena holding the whole simulation state back
+// to back; saving overwrites the oldest slot. After reserve() sized for
+// the largest world, save and restore never touch the heap.
+class SnapshotRing {
+public:
+    // `slots` buffers, each sized for `entities` entities and `players`
+    // players (plus a little slack for headers).
+    void reserve(size_t slots, size_t entities, size_t players);
+
+    void save(Simulation& sim);
+    // Restores the snapshot taken at `tick`; false if it was overwritten.
+    bool restore(uint32_t tick, Simulation& sim) const;
+    bool has(uint32_t tick) const { return find(tick) != nullptr; }
+
+    size_t slotCount() const { return slots.size(); }
+    size_t lastBytes = 0; // size of the most recent save
+
+private:
+    struct Slot {
+        uint32_t tick = ~0u;
+        size_t used = 0;
+        std::vector<uint8_t> arena;
+    };
+
+    const Slot* find(uint32_t tick) const;
+
+    std::vector<Slot> slots;
+    size_t next = 0;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "SpatialHash.hpp"
+#include <algorithm>
+#include <cmath>
+
+int32_t SpatialHash::cellCoord(float v) const {
+    return static_cast<int32_t>(std::floor(v * invCell));
+}
+
+void SpatialHash::build(const float* x, const float* z, const float* radius, size_t count) {
+    float maxR = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxR = std::max(maxR, radius[i]);
+    }
+    cell = fixedCell > 0.0f ? fixedCell : std::max(2.0f * maxR, 1e-3f);
+    invCell = 1.0f / cell;
+
+    // square table with at least two buckets per item
+    wrapShift = 3;
+    while ((size_t(1) << (2 * wrapShift)) < count * 2) {
+        ++wrapShift;
+    }
+    wrapMask = (1u << wrapShift) - 1;
+    uint32_t buckets = 1u << (2 * wrapShift);
+    mask = buckets - 1;
+
+    // Counting sort by bucket
+    cellStart.assign(buckets + 1, 0);
+    stamps.assign(buckets, 0);
+    stampEpoch = 0;
+    bucket.resize(count);
+    cellX.resize(count);
+    cellZ.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        cellX[i] = cellCoord(x[i]);
+        cellZ[i] = cellCoord(z[i]);
+        uint32_t b = bucketOf(cellX[i], cellZ[i]);
+        bucket[i] = b;
+        ++cellStart[b + 1];
+    }
+    for (uint32_t b = 0; b < buckets; ++b) {
+        cellStart[b + 1] += cellStart[b];
+    }
+
+    ids.resize(count);
+    sx.resize(count);
+    sz.resize(count);
+    sr.resize(count);
+    scx.resize(count);
+    scz.resize(count);
+    // cellStart[b] doubles as the write cursor, then gets shifted back
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t slot = cellStart[bucket[i]]++;
+        ids[slot] = static_cast<uint32_t>(i);
+        sx[slot] = x[i];
+        sz[slot] = z[i];
+        sr[slot] = radius[i];
+        scx[slot] = cellX[i];
+        scz[slot] = cellZ[i];
+    }
+    for (uint32_t b = buckets; b > 0; --b) {
+        cellStart[b] = cellStart[b - 1];
+    }
+    cellStart[0] = 0;
+}
+
+template <typename Visit>
+void SpatialHash::forEachBucketIn(float minX, float minZ, float maxX, float maxZ, Visit&& visit) const {
+    if (ids.empty()) {
+        return;
+    }
+    int32_t x0 = cellCoord(minX), x1 = cellCoord(maxX);
+    int32_t z0 = cellCoord(minZ), z1 = cellCoord(maxZ);
+    // Large boxes would touch every bucket anyway; walk the table once instead
+    uint64_t cells = uint64_t(x1 - x0 + 1) * uint64_t(z1 - z0 + 1);
+    if (cells > mask) {
+        for (uint32_t b = 0; b <= mask; ++b) {
+            visit(b);
+        }
+        return;
+    }
+    // Spans no wider than the wrap never alias: every cell has its own bucket
+    if (uint32_t(x1 - x0) <= wrapMask && uint32_t(z1 - z0) <= wrapMask) {
+        for (int32_t cz = z0; cz <= z1; ++cz) {
+            for (int32_t cx = x0; cx <= x1; ++cx) {
+                visit(bucketOf(cx, cz));
+            }
+        }
+        return;
+    }
+    // distinct cells share buckets; stamp each bucket on its first visit
+    if (++stampEpoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stampEpoch = 1;
+    }
+    for (int32_t cz = z0; cz <= z1; ++cz) {
+        for (int32_t cx = x0; cx <= x1; ++cx) {
+            uint32_t b = bucketOf(cx, cz);
+            if (stamps[b] == stampEpoch) {
+                continue;
+            }
+            stamps[b] = stampEpoch;
+            visit(b);
+        }
+    }
+}
+
+void SpatialHash::queryRadius(float x, float z, float r, std::vector<uint32_t>& out) const {
+    out.clear();
+    forEachBucketIn(x - r, z - r, x + r, z + r, [&](uint32_t b) {
+        for (uint32_t s = cellStart[b]; s < cellStart[b + 1]; ++s) {
+            float dx = sx[s] - x;
+            float dz = sz[s] - z;
+            float rr = r + sr[s];
+            if (dx * dx + dz * dz <= rr * rr) {
+                out.push_back(ids[s]);
+            }
+        }
+    });
+}
+
+void SpatialHash::queryAABB(float minX, float minZ, float maxX, float maxZ,
+                            std::vector<uint32_t>& out) const {
+    out.clear();
+    // items are filed by centre, so widen by the largest possible radius
+    float pad = cell * 0.5f;
+    forEachBucketIn(minX - pad, minZ - pad, maxX + pad, maxZ + pad, [&](uint32_t b) {
+        for (uint32_t s = cellStart[b]; s < cellStart[b + 1]; ++s) {
+            float cx = std::clamp(sx[s], minX, maxX);
+            float cz = std::clamp(sz[s], minZ, maxZ);
+            float dx = sx[s] - cx;
+            float dz = sz[s] - cz;
+            if (dx * dx + dz * dz <= sr[s] * sr[s]) {
+                out.push_back(ids[s]);
+            }
+        }
+    });
+}
+
+size_t SpatialHash::resolveOverlaps(float* dx, float* dz) const {
+    const uint32_t n = static_cast<uint32_t>(ids.size());
+    // accumulate in cell order, scatter to ids at the end
+    sdx.assign(n, 0.0f);
+    sdz.assign(n, 0.0f);
+
+    size_t pairs = 0;
+    uint32_t rangeBegin[9];
+    uint32_t rangeEnd[9];
+    int ranges = 0;
+    int32_t lastX = 0, lastZ = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        // The cell size is at least twice the largest radius, so every
+        // overlapping partner lives in the surrounding 3x3 cells. With the
+        // wrapping hash each row of three cells is one contiguous slot
+        // range, and items are grouped by cell so the ranges are reused.
+        if (i == 0 || scx[i] != lastX || scz[i] != lastZ) {
+            lastX = scx[i];
+            lastZ = scz[i];
+            ranges = 0;
+            for (int oz = -1; oz <= 1; ++oz) {
+                uint32_t b0 = bucketOf(lastX - 1, lastZ + oz);
+                uint32_t b2 = bucketOf(lastX + 1, lastZ + oz);
+                if (b2 == b0 + 2) {
+                    rangeBegin[ranges] = cellStart[b0];
+                    rangeEnd[ranges++] = cellStart[b0 + 3];
+                } else {
+                    // row wraps around the table edge
+                    for (int ox = -1; ox <= 1; ++ox) {
+                        uint32_t b = bucketOf(lastX + ox, lastZ + oz);
+                        rangeBegin[ranges] = cellStart[b];
+                        rangeEnd[ranges++] = cellStart[b + 1];
+                    }
+                }
+            }
+        }
+        const float xi = sx[i], zi = sz[i], ri = sr[i];
+        float accX = 0.0f, accZ = 0.0f;
+        for (int k = 0; k < ranges; ++k) {
+            // each pair once: only partners stored after i
+            uint32_t s = std::max(rangeBegin[k], i + 1);
+            for (; s < rangeEnd[k]; ++s) {
+                float ddx = sx[s] - xi;
+                float ddz = sz[s] - zi;
+                float rr = ri + sr[s];
+                float d2 = ddx * ddx + ddz * ddz;
+                if (d2 >= rr * rr) {
+                    continue;
+                }
+                ++pairs;
+                float nx = 1.0f, nz = 0.0f, d = 0.0f;
+                if (d2 > 1e-12f) {
+                    d = std::sqrt(d2);
+                    nx = ddx / d;
+                    nz = ddz / d;
+                }
+                float push = (rr - d) * 0.5f;
+                accX -= nx * push;
+                accZ -= nz * push;
+                sdx[s] += nx * push;
+                sdz[s] += nz * push;
+            }
+        }
+        sdx[i] += accX;
+        sdz[i] += accZ;
+    }
+
+    for (uint32_t s = 0; s < n; ++s) {
+        dx[ids[s]] = sdx[s];
+        dz[ids[s]] = sdz[s];
+    }
+    return pairs;
+}
+
+uint32_t SpatialHash::nearestSlots(uint32_t slot, float range, uint32_t maxCount, uint32_t* out) const {
+    const int32_t cx = scx[slot], cz = scz[slot];
+    const float x = sx[slot], z = sz[slot];
+    const float range2 = range * range;
+    float best[64];
+    if (maxCount > 64) {
+        maxCount = 64;
+    }
+    uint32_t found = 0;
+    // range <= cell, so the 3x3 cells around the item cover it
+    for (int oz = -1; oz <= 1; ++oz) {
+        for (int ox = -1; ox <= 1; ++ox) {
+            uint32_t b = bucketOf(cx + ox, cz + oz);
+            for (uint32_t s = cellStart[b]; s < cellStart[b + 1]; ++s) {
+                float dx = sx[s] - x;
+                float dz = sz[s] - z;
+                float d2 = dx * dx + dz * dz;
+                if (s == slot || d2 > range2 || (found == maxCount && d2 >= best[found - 1])) {
+                    continue;
+                }
+                // insertion into the sorted shortlist, dropping the farthest
+                uint32_t k = found < maxCount ? found++ : found - 1;
+                for (; k > 0 && best[k - 1] > d2; --k) {
+                    best[k] = best[k - 1];
+                    out[k] = out[k - 1];
+                }
+                best[k] = d2;
+                out[k] = s;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,73 @@
+#ifndef SPATIALHASH_HPP
+#define SPATIALHASH_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+// Uniform grid over the XZ plane, hashed into a square power-of-two table.
+// build() counting-sorts the items by bucket into cell-ordered arrays, so
+// a neighbourhood walk reads contiguous memory. Ids are the indices of the
+// arrays passed to build().
+class SpatialHash {
+public:
+    // Cell size is chosen by build() as twice the largest radius unless a
+    // fixed size is given here; a fixed size must be at least that large.
+    explicit SpatialHash(float fixedCellSize = 0.0f) : fixedCell(fixedCellSize) {}
+
+    void build(const float* x, const float* z, const float* radius, size_t count);
+
+    // Items whose circle overlaps the query circle / box.
+    void queryRadius(float x, float z, float r, std::vector<uint32_t>& out) const;
+    void queryAABB(float minX, float minZ, float maxX, float maxZ, std::vector<uint32_t>& out) const;
+
+    // Pushes overlapping circles apart by half the penetration each. The
+    // accumulated displacement per id is written to dx/dz (count entries).
+    // Returns the number of overlapping pairs.
+    size_t resolveOverlaps(float* dx, float* dz) const;
+
+    // Up to maxCount other items within `range` of the item in sorted slot
+    // `slot`, nearest first, written as sorted slots; returns how many.
+    // range may not exceed the cell size. Unlike the queries above this
+    // keeps no scratch, so threads may call it concurrently.
+    uint32_t nearestSlots(uint32_t slot, float range, uint32_t maxCount, uint32_t* out) const;
+
+    // Sorted slot -> id given to build().
+    const uint32_t* sortedIds() const { return ids.data(); }
+
+    size_t size() const { return ids.size(); }
+    float cellSize() const { return cell; }
+
+private:
+    // Wrapping grid hash: cells tile the table modulo its width/height, so
+    // neighbouring cells land in neighbouring buckets (unlike a scrambling
+    // hash) while the world itself stays unbounded.
+    uint32_t bucketOf(int32_t cx, int32_t cz) const {
+        return (uint32_t(cx) & wrapMask) | ((uint32_t(cz) & wrapMask) << wrapShift);
+    }
+    int32_t cellCoord(float v) const;
+    template <typename Visit>
+    void forEachBucketIn(float minX, float minZ, float maxX, float maxZ, Visit&& visit) const;
+
+    float fixedCell = 0.0f;
+    float cell = 1.0f;
+    float invCell = 1.0f;
+    uint32_t mask = 0;
+    uint32_t wrapMask = 0;
+    uint32_t wrapShift = 0;
+
+    std::vector<uint32_t> cellStart; // bucket -> first sorted slot, size buckets + 1
+    std::vector<uint32_t> bucket;    // per input item, scratch for the sort
+    std::vector<int32_t> cellX, cellZ;
+
+    // Cell-ordered copies of the input
+    std::vector<uint32_t> ids;
+    std::vector<float> sx, sz, sr;
+    std::vector<int32_t> scx, scz;
+
+    mutable std::vector<uint32_t> stamps; // per bucket, == stampEpoch once visited
+    mutable uint32_t stampEpoch = 0;
+    mutable std::vector<float> sdx, sdz;
+};
+
+#endif
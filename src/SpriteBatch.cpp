@@ -0,0 +1,92 @@
+#include "SpriteBatch.hpp"
+#include "Animation.hpp"
+#include <algorithm>
+
+void SpriteBatch::build(const Registry& reg, const AnimationLibrary& clips, const std::vector<uint32_t>& order,
+                        const std::vector<uint32_t>& selection, float clock, Mode mode) {
+    const SpritePool& sp = reg.sprites;
+    const TransformPool& tp = reg.transforms;
+    const AnimationPool& ap = reg.animations;
+
+    dirtyRows.clear();
+    animationBytes = 0;
+    transitions = 0;
+    if (mode == Mode::Clips) {
+        updateClipStates(reg, clips, clock);
+    }
+
+    instances.clear();
+    runs.clear();
+    for (uint32_t i : order) {
+        uint32_t e = sp.entities[i];
+        if (!tp.has(e) || !ap.has(e)) {
+            continue;
+        }
+        uint32_t t = tp.row(e);
+        uint32_t a = ap.row(e);
+        SpriteInstance inst;
+        inst.x = tp.x[t];
+        inst.y = tp.y[t];
+        inst.z = tp.z[t];
+        inst.anim = mode == Mode::Clips ? a : ap.uvBase[a] + uint32_t(ap.frameIndex[a]);
+        inst.flags = std::binary_search(selection.begin(), selection.end(), e) ? kSelected : 0;
+
+        uint16_t sheet = sp.sheet[i];
+        if (runs.empty() || runs.back().sheet != sheet) {
+            runs.push_back(SpriteRun{sheet, uint32_t(instances.size()), 0});
+        }
+        ++runs.back().count;
+        instances.push_back(inst);
+    }
+
+    instanceBytes = instances.size() * sizeof(SpriteInstance);
+    if (mode == Mode::Frames) {
+        animationBytes = instances.size() * sizeof(uint32_t);
+    }
+}
+
+void SpriteBatch::updateClipStates(const Registry& reg, const AnimationLibrary& clips, float clock) {
+    const AnimationPool& ap = reg.animations;
+    const size_t n = ap.size();
+    clipStates.resize(n);
+    stateEntity.resize(n, kInvalidIndex);
+
+    // a row changes hands when the pool swaps the last row into a hole
+    for (size_t a = 0; a < n; ++a) {
+        SpriteClipState& s = clipStates[a];
+        if (stateEntity[a] == ap.entities[a] && s.clip == ap.clip[a] && s.facing == ap.facing[a]) {
+            continue;
+        }
+        stateEntity[a] = ap.entities[a];
+        s.clip = ap.clip[a];
+        s.facing = ap.facing[a];
+        s.rate = 1.0f;
+        // back-date frame 0 so the shader lands on the CPU's frame
+        float elapsed = 0.0f;
+        if (s.clip != AnimationLibrary::kNoClip) {
+            elapsed = float(ap.frameIndex[a]) * clips.clip(uint16_t(s.clip)).frameDuration + ap.frameTimer[a];
+        }
+        s.start = clock - elapsed / s.rate;
+
+        uint32_t row = uint32_t(a);
+        if (!dirtyRows.empty() && dirtyRows.back().end == row) {
+            ++dirtyRows.back().end;
+        } else {
+            dirtyRows.push_back(SpriteRowRange{row, row + 1});
+        }
+        ++transitions;
+    }
+    animationBytes = transitions * sizeof(SpriteClipState);
+}
+
+void SpriteBatch::invalidate() {
+    std::fill(stateEntity.begin(), stateEntity.end(), kInvalidIndex);
+}
+
+void SpriteBatch::clipTable(const AnimationLibrary& clips, std::vector<SpriteClipEntry>& out) {
+    out.clear();
+    for (size_t i = 0; i < clips.clipCount(); ++i) {
+        const AnimationClip& c = clips.clip(uint16_t(i));
+        out.push_back(SpriteClipEntry{c.firstUv, uint32_t(c.frames), c.frameDuration, 0});
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include "Registry.hpp"
+
+class AnimationLibrary;
+
+// One visible sprite, streamed in draw order as per-instance attributes.
+struct SpriteInstance {
+    float x, y, z;
+    uint32_t anim;  // UV table index (Frames) or animation pool row (Clips)
+    uint32_t flags; // SpriteBatch::kSelected
+};
+
+// Consecutive instances drawn from the same sprite sheet.
+struct SpriteRun {
+    uint16_t sheet;
+    uint32_t first;
+    uint32_t count;
+};
+
+// Everything the vertex shader needs to play a clip by itself, one
+// RGBA32UI texel per animation pool row; start and rate are float bits.
+struct SpriteClipState {
+    uint32_t clip;   // AnimationLibrary clip id; kNoClip draws UV entry 0
+    uint32_t facing;
+    float start;     // animation clock time at which frame 0 began
+    float rate;      // playback speed multiplier
+};
+
+// Per clip: the inputs of AnimationLibrary::uvIndex(), for a texture buffer.
+struct SpriteClipEntry {
+    uint32_t firstUv;
+    uint32_t frames;
+    float frameDuration;
+    uint32_t pad;
+};
+
+struct SpriteRowRange {
+    uint32_t begin;
+    uint32_t end;
+};
+
+// Builds the instance stream for the sprite renderer from the render
+// queue's draw order.
+//
+// In Frames mode every instance carries its current UV table index, so
+// animation costs an upload per sprite per frame. In Clips mode the
+// instance carries its animation row instead and the shader evaluates
+// the frame from a global clock, the clip table and clipStates; those
+// only change when a sprite switches clip or facing, and dirtyRows lists
+// the rows to re-upload. A new state is phase aligned with the CPU frame
+// and timer so picking and the drawn frame agree.
+class SpriteBatch {
+public:
+    enum class Mode { Frames, Clips };
+    static constexpr uint32_t kSelected = 1;
+
+    std::vector<SpriteInstance> instances;
+    std::vector<SpriteRun> runs;
+    std::vector<SpriteClipState> clipStates; // Clips mode, per animation row
+    std::vector<SpriteRowRange> dirtyRows;   // clipStates changed by build()
+
+    // what the last build() asks to upload
+    size_t instanceBytes = 0;
+    size_t animationBytes = 0; // UV indices in the instances, or dirty clip states
+    size_t transitions = 0;
+
+    // `selection` holds sorted entity indices; `clock` is the animation
+    // clock in seconds, the same one the shader gets.
+    void build(const Registry& reg, const AnimationLibrary& clips, const std::vector<uint32_t>& order,
+               const std::vector<uint32_t>& selection, float clock, Mode mode);
+
+    // Marks every clip state dirty, e.g. after the GPU buffer was replaced.
+    void invalidate();
+
+    static void clipTable(const AnimationLibrary& clips, std::vector<SpriteClipEntry>& out);
+
+private:
+    void updateClipStates(const Registry& reg, const AnimationLibrary& clips, float clock);
+
+    std::vector<uint32_t> stateEntity; // entity each clip state was made for
+};
+
+#endif
@@ -0,0 +1,278 @@
+#include "SpritePicker.hpp"
+#include "Animation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Half diagonal of the unit billboard quad: the largest extent it can
+// have along any world axis, whichever way the camera faces.
+static const float kPickRadius = 0.7072f;
+// Rebuild once refits have grown the summed node area by this factor.
+static const float kRebuildGrowth = 1.5f;
+// Stack entries for nodes already known to be inside the selection.
+static const uint32_t kInsideBit = 0x80000000u;
+
+bool SpriteAlphaMask::opaque(const glm::vec4& uvRect, float u, float v) const {
+    if (alpha.empty()) {
+        return true;
+    }
+    float su = uvRect.x + (uvRect.z - uvRect.x) * u;
+    float sv = uvRect.y + (uvRect.w - uvRect.y) * v;
+    int x = std::clamp(int(su * float(width)), 0, width - 1);
+    int y = std::clamp(int(sv * float(height)), 0, height - 1);
+    return alpha[size_t(y) * width + x] >= 128;
+}
+
+glm::vec3 SpritePicker::position(const Registry& reg, uint32_t row) const {
+    const TransformPool& tp = reg.transforms;
+    uint32_t t = tp.row(reg.sprites.entities[row]);
+    return glm::vec3(tp.x[t], tp.y[t], tp.z[t]);
+}
+
+void SpritePicker::update(const Registry& reg) {
+    if (builtVersions[0] != reg.sprites.version || builtVersions[1] != reg.transforms.version) {
+        build(reg);
+        return;
+    }
+    if (nodes.empty()) {
+        return;
+    }
+    ++refits;
+    if (refit(reg) > builtArea * kRebuildGrowth) {
+        build(reg);
+    }
+}
+
+void SpritePicker::build(const Registry& reg) {
+    const SpritePool& sp = reg.sprites;
+    items.clear();
+    nodes.clear();
+    for (uint32_t i = 0; i < uint32_t(sp.size()); ++i) {
+        // sprites without a transform are never drawn, so never picked
+        if (reg.transforms.has(sp.entities[i])) {
+            items.push_back({position(reg, i), i});
+        }
+    }
+    if (!items.empty()) {
+        buildNode(0, uint32_t(items.size()));
+    }
+    rows.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        rows[i] = items[i].row;
+    }
+    builtVersions[0] = sp.version;
+    builtVersions[1] = reg.transforms.version;
+    builtArea = nodes.empty() ? 0.0f : refit(reg);
+    ++rebuilds;
+}
+
+uint32_t SpritePicker::buildNode(uint32_t begin, uint32_t end) {
+    uint32_t index = uint32_t(nodes.size());
+    nodes.emplace_back();
+    if (end - begin <= kLeafSize) {
+        nodes[index].start = begin;
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    // median split along the widest axis of the centres
+    glm::vec3 lo = items[begin].centre, hi = items[begin].centre;
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        lo = glm::min(lo, items[i].centre);
+        hi = glm::max(hi, items[i].centre);
+    }
+    glm::vec3 extent = hi - lo;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                     [axis](const BuildItem& a, const BuildItem& b) { return a.centre[axis] < b.centre[axis]; });
+
+    buildNode(begin, mid);
+    uint32_t right = buildNode(mid, end);
+    nodes[index].start = right;
+    return index;
+}
+
+float SpritePicker::refit(const Registry& reg) {
+    float area = 0.0f;
+    const glm::vec3 r(kPickRadius);
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& n = nodes[i];
+        if (n.count) {
+            glm::vec3 p = position(reg, rows[n.start]);
+            n.lo = p - r;
+            n.hi = p + r;
+            for (uint32_t k = 1; k < n.count; ++k) {
+                p = position(reg, rows[n.start + k]);
+                n.lo = glm::min(n.lo, p - r);
+                n.hi = glm::max(n.hi, p + r);
+            }
+        } else {
+            const Node& a = nodes[i + 1];
+            const Node& b = nodes[n.start];
+            n.lo = glm::min(a.lo, b.lo);
+            n.hi = glm::max(a.hi, b.hi);
+        }
+        glm::vec3 d = n.hi - n.lo;
+        area += d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+    return area;
+}
+
+uint32_t SpritePicker::pick(const Registry& reg, const glm::mat4& view, const glm::mat4& proj, float viewportW,
+                            float viewportH, float mouseX, float mouseY, const AnimationLibrary* clips) {
+    nodesVisited = 0;
+    if (nodes.empty()) {
+        return kNone;
+    }
+
+    // Ray from the near to the far plane through the cursor
+    glm::mat4 inv = glm::inverse(proj * view);
+    float nx = 2.0f * mouseX / viewportW - 1.0f;
+    float ny = 1.0f - 2.0f * mouseY / viewportH;
+    glm::vec4 a = inv * glm::vec4(nx, ny, -1.0f, 1.0f);
+    glm::vec4 b = inv * glm::vec4(nx, ny, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(a) / a.w;
+    glm::vec3 dir = glm::normalize(glm::vec3(b) / b.w - origin);
+    glm::vec3 invDir = 1.0f / dir;
+
+    // Billboards face the camera: their plane is spanned by the camera's
+    // right and up axes (the rows of the view matrix).
+    glm::vec3 right(view[0][0], view[1][0], view[2][0]);
+    glm::vec3 up(view[0][1], view[1][1], view[2][1]);
+    glm::vec3 back(view[0][2], view[1][2], view[2][2]);
+    float facing = glm::dot(dir, back);
+    if (std::fabs(facing) < 1e-6f) {
+        return kNone;
+    }
+
+    float best = std::numeric_limits<float>::max();
+    uint32_t bestRow = kNone;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& n = nodes[stack.back()];
+        stack.pop_back();
+        ++nodesVisited;
+
+        glm::vec3 t0 = (n.lo - origin) * invDir;
+        glm::vec3 t1 = (n.hi - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+        if (enter > exit || enter >= best) {
+            continue;
+        }
+        if (!n.count) {
+            stack.push_back(n.start);
+            stack.push_back(uint32_t(&n - nodes.data()) + 1);
+            continue;
+        }
+
+        for (uint32_t k = 0; k < n.count; ++k) {
+            uint32_t row = rows[n.start + k];
+            glm::vec3 p = position(reg, row);
+            float t = glm::dot(p - origin, back) / facing;
+            if (t < 0.0f || t >= best) {
+                continue;
+            }
+            glm::vec3 hit = origin + dir * t - p;
+            float u = glm::dot(hit, right), w = glm::dot(hit, up);
+            if (std::fabs(u) > 0.5f || std::fabs(w) > 0.5f) {
+                continue;
+            }
+            if (clips) {
+                uint16_t sheet = reg.sprites.sheet[row];
+                uint32_t e = reg.sprites.entities[row];
+                if (sheet < masks.size() && reg.animations.has(e)) {
+                    // the frame the renderer draws; the quad is flipped so
+                    // its top edge is v = 0
+                    const AnimationPool& ap = reg.animations;
+                    uint32_t a = ap.row(e);
+                    const glm::vec4& rect = clips->uv(ap.uvBase[a] + uint32_t(ap.frameIndex[a]));
+                    if (!masks[sheet].opaque(rect, u + 0.5f, 0.5f - w)) {
+                        continue;
+                    }
+                }
+            }
+            best = t;
+            bestRow = row;
+        }
+    }
+    return bestRow == kNone ? kNone : reg.sprites.entities[bestRow];
+}
+
+void SpritePicker::selectRect(const Registry& reg, const glm::mat4& viewProj, float viewportW, float viewportH,
+                              float x0, float y0, float x1, float y1, std::vector<uint32_t>& out) {
+    nodesVisited = 0;
+    if (nodes.empty()) {
+        return;
+    }
+
+    // Sub-frustum of the rectangle: x0 <= x/w <= x1 in NDC is
+    // x - x0*w >= 0 and x1*w - x >= 0 in clip space, likewise for y.
+    float nx0 = 2.0f * std::min(x0, x1) / viewportW - 1.0f;
+    float nx1 = 2.0f * std::max(x0, x1) / viewportW - 1.0f;
+    float ny0 = 1.0f - 2.0f * std::max(y0, y1) / viewportH;
+    float ny1 = 1.0f - 2.0f * std::min(y0, y1) / viewportH;
+    glm::mat4 m = glm::transpose(viewProj);
+    const glm::vec4 planes[6] = {
+        m[0] - nx0 * m[3], nx1 * m[3] - m[0],
+        m[1] - ny0 * m[3], ny1 * m[3] - m[1],
+        m[3] + m[2], m[3] - m[2],
+    };
+
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        uint32_t entry = stack.back();
+        stack.pop_back();
+        const Node& n = nodes[entry & ~kInsideBit];
+        ++nodesVisited;
+
+        bool inside = (entry & kInsideBit) != 0;
+        if (!inside) {
+            inside = true;
+            bool outside = false;
+            for (const glm::vec4& pl : planes) {
+                glm::vec3 normal(pl);
+                // the box corners farthest along and against the normal
+                glm::vec3 far = glm::mix(n.lo, n.hi, glm::vec3(glm::greaterThan(normal, glm::vec3(0.0f))));
+                glm::vec3 near = glm::mix(n.hi, n.lo, glm::vec3(glm::greaterThan(normal, glm::vec3(0.0f))));
+                if (glm::dot(normal, far) + pl.w < 0.0f) {
+                    outside = true;
+                    break;
+                }
+                if (glm::dot(normal, near) + pl.w < 0.0f) {
+                    inside = false;
+                }
+            }
+            if (outside) {
+                continue;
+            }
+        }
+        if (!n.count) {
+            uint32_t flag = inside ? kInsideBit : 0;
+            stack.push_back(n.start | flag);
+            stack.push_back((uint32_t(&n - nodes.data()) + 1) | flag);
+            continue;
+        }
+        for (uint32_t k = 0; k < n.count; ++k) {
+            uint32_t row = rows[n.start + k];
+            if (!inside) {
+                glm::vec3 p = position(reg, row);
+                bool in = true;
+                for (const glm::vec4& pl : planes) {
+                    if (glm::dot(glm::vec3(pl), p) + pl.w < 0.0f) {
+                        in = false;
+                        break;
+                    }
+                }
+                if (!in) {
+                    continue;
+                }
+            }
+            out.push_back(reg.sprites.entities[row]);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef SPRITEPICKER_HPP
+#define SPRITEPICKER_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# include <glm/glm.hpp>
+# include "Registry.hpp"
+
+class AnimationLibrary;
+
+// Per-texel alpha of a sprite sheet, kept on the CPU for pixel-exact picks.
+struct SpriteAlphaMask {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> alpha; // row 0 is the top of the image, as uploaded
+
+    // True when the texel at (u, v) across the quad, mapped through a clip
+    // frame's UV rect, is at least half opaque.
+    bool opaque(const glm::vec4& uvRect, float u, float v) const;
+};
+
+// Mouse picking and drag-box selection over the billboarded unit sprites.
+//
+// Keeps a BVH of camera-independent world bounds per sprite row (a cube
+// that holds the unit quad at any orientation), so the tree survives
+// camera moves. update() rebuilds it when sprites were added or removed,
+// or once refits have bloated it; otherwise it only refits the existing
+// nodes to the new positions. Queries then visit a few dozen nodes
+// instead of every sprite.
+class SpritePicker {
+public:
+    static constexpr uint32_t kNone = kInvalidIndex;
+    static constexpr uint32_t kLeafSize = 4;
+
+    // Optional per sprite sheet; given the animation clips, pick() skips
+    // transparent texels of sheets that have a mask.
+    std::vector<SpriteAlphaMask> masks;
+
+    void update(const Registry& reg);
+
+    // Entity index of the nearest sprite under the cursor (pixels, origin
+    // top left), or kNone.
+    uint32_t pick(const Registry& reg, const glm::mat4& view, const glm::mat4& proj, float viewportW,
+                  float viewportH, float mouseX, float mouseY, const AnimationLibrary* clips = nullptr);
+
+    // Entity indices of every sprite whose centre projects inside the
+    // screen rectangle spanned by two corners (pixels, any order).
+    void selectRect(const Registry& reg, const glm::mat4& viewProj, float viewportW, float viewportH,
+                    float x0, float y0, float x1, float y1, std::vector<uint32_t>& out);
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t nodesVisited = 0; // by the last query
+    size_t rebuilds = 0;
+    size_t refits = 0;
+
+private:
+    // Children of an interior node are this + 1 and `start`; depth-first
+    // order puts both after their parent, so a backwards pass refits.
+    struct Node {
+        glm::vec3 lo, hi;
+        uint32_t start = 0; // leaf: first index into rows; interior: right child
+        uint32_t count = 0; // sprites in the leaf, 0 for interior nodes
+    };
+
+    void build(const Registry& reg);
+    uint32_t buildNode(uint32_t begin, uint32_t end);
+    // Sum of node surface areas; refits that inflate it too far trigger a
+    // rebuild.
+    float refit(const Registry& reg);
+    glm::vec3 position(const Registry& reg, uint32_t row) const;
+
+    std::vector<Node> nodes;
+    struct BuildItem {
+        glm::vec3 centre;
+        uint32_t row;
+    };
+
+    std::vector<uint32_t> rows;   // sprite rows in leaf order
+    std::vector<BuildItem> items; // build scratch
+    std::vector<uint32_t> stack;
+    uint64_t builtVersions[2] = {~0ull, ~0ull};
+    float builtArea = 0.0f;
+};
+
+#endif
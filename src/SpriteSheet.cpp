@@ -1,52 +1,14 @@
-#include "Player.hpp"
+#include "SpriteSheet.hpp"
+#include "SpritePicker.hpp"
 #include "thirdparty/stb_image.h"
 #include "thirdparty/glad/include/glad/glad.h"
 #include <iostream>
 
-Player::Player() : position(0.0f, 0.5f, 0.0f) {}
-
-void Player::setFloorHeight(float floorHeight) {
-    floorY = floorHeight;
-    // Place player on top of the floor
-    position.y = floorY + height * 0.5f;
-    velocity.y = 0.0f;
-}
-
-void Player::setAnimation(int cols, int rows, int count, float duration) {
-    animCols = cols;
-    animRows = rows;
-    frameCount = count;
-    frameDuration = duration;
-    frameIndex = 0;
-    frameTimer = 0.0f;
-}
-
-void Player::updateAnimation(float dt, bool moving, int direction) {
-    // Update facing direction
-    if (direction != 0) {
-        facingDirection = direction;
-    }
-
-    if (moving) {
-        animPlaying = true;
-        frameTimer += dt;
-        
-        if (frameTimer >= frameDuration) {
-            frameIndex = (frameIndex + 1) % frameCount;
-            frameTimer -= frameDuration;
-        }
-    } else {
-        animPlaying = false;
-        frameIndex = 0;
-        frameTimer = 0.0f;
-    }
-}
-
-void Player::loadTexture(const char* path) {
+void SpriteSheet::loadTexture(const char* path, SpriteAlphaMask* mask) {
     int w, h, n;
     unsigned char* data = stbi_load(path, &w, &h, &n, 4);
     if (!data) {
-        std::cerr << "Failed to load player texture\n";
+        std::cerr << "Failed to load sprite texture: " << path << "\n";
         return;
     }
 
@@ -62,10 +24,19 @@ void Player::loadTexture(const char* path) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    if (mask) {
+        mask->width = w;
+        mask->height = h;
+        mask->alpha.resize(size_t(w) * h);
+        for (size_t i = 0; i < mask->alpha.size(); ++i) {
+            mask->alpha[i] = data[i * 4 + 3];
+        }
+    }
+
     stbi_image_free(data);
 }
 
-void Player::initMesh() {
+void SpriteSheet::initMesh() {
     float vertices[] = {
         // pos         // uv
         -0.5f, -0.5f, 0.0f,   0.0f, 0.0f,
@@ -95,26 +66,10 @@ void Player::initMesh() {
     glEnableVertexAttribArray(1);
 }
 
-void Player::jump() {
-    if (isGrounded) {
-        velocity.y = jumpForce;
-        isGrounded = false;
-    }
-}
-
-void Player::update(float dt) {
-    // Apply gravity
-    velocity.y += gravity * dt;
-    // Apply velocity
-    position.y += velocity.y * dt;
-
-    // Collision with ground - player's bottom is at position.y - height * 0.5f
-    float bottomY = position.y - height * 0.5f;
-    if (bottomY <= floorY) {
-        position.y = floorY + height * 0.5f;
-        velocity.y = 0.0f;
-        isGrounded = true;
-    } else {
-        isGrounded = false;
-    }
+void SpriteSheet::destroy() {
+    glDeleteTextures(1, &textureID);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteVertexArrays(1, &vao);
+    textureID = vao = vbo = ebo = 0;
 }
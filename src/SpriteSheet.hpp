@@ -0,0 +1,23 @@
+#ifndef SPRITESHEET_HPP
+#define SPRITESHEET_HPP
+
+struct SpriteAlphaMask;
+
+// GL resources shared by every entity drawn from the same sheet. Entities
+// only carry the index of their sheet (SpriteColumns::sheet).
+struct SpriteSheet {
+    int cols = 1;
+    int rows = 1;
+
+    unsigned int textureID = 0;
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    unsigned int ebo = 0;
+
+    // With a mask, also keeps the texture's alpha channel for picking.
+    void loadTexture(const char* path, SpriteAlphaMask* mask = nullptr);
+    void initMesh();
+    void destroy();
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "StateHash.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+# define STATEHASH_X86 1
+# include <immintrin.h>
+#endif
+
+static constexpr size_t kLanes = 16;
+static constexpr size_t kBlock = kLanes * sizeof(uint32_t);
+static constexpr uint32_t kPrime = 0x9E3779B1u;
+
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static void initLanes(uint32_t* lanes, uint64_t seed) {
+    for (size_t j = 0; j < kLanes; ++j) {
+        lanes[j] = static_cast<uint32_t>(mix64(seed + j));
+    }
+}
+
+static void blocksScalar(uint32_t* lanes, const uint8_t* p, size_t blocks) {
+    for (size_t b = 0; b < blocks; ++b, p += kBlock) {
+        uint32_t w[kLanes];
+        std::memcpy(w, p, kBlock);
+        for (size_t j = 0; j < kLanes; ++j) {
+            uint32_t h = (lanes[j] ^ w[j]) * kPrime;
+            lanes[j] = h ^ (h >> 15);
+        }
+    }
+}
+
+#ifdef STATEHASH_X86
+__attribute__((target("avx2")))
+static void blocksAVX2(uint32_t* lanes, const uint8_t* p, size_t blocks) {
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(kPrime));
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes + 8));
+    for (size_t b = 0; b < blocks; ++b, p += kBlock) {
+        __m256i wlo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i whi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        lo = _mm256_mullo_epi32(_mm256_xor_si256(lo, wlo), prime);
+        hi = _mm256_mullo_epi32(_mm256_xor_si256(hi, whi), prime);
+        lo = _mm256_xor_si256(lo, _mm256_srli_epi32(lo, 15));
+        hi = _mm256_xor_si256(hi, _mm256_srli_epi32(hi, 15));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes + 8), hi);
+}
+#endif
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed, SimdLevel level) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t lanes[kLanes];
+    initLanes(lanes, seed);
+
+    size_t blocks = size / kBlock;
+#ifdef STATEHASH_X86
+    if (level == SimdLevel::AVX2) {
+        blocksAVX2(lanes, p, blocks);
+    } else {
+        blocksScalar(lanes, p, blocks);
+    }
+#else
+    (void)level;
+    blocksScalar(lanes, p, blocks);
+#endif
+
+    // zero-padded tail; the length is folded in below so padding can't collide
+    size_t tail = size - blocks * kBlock;
+    if (tail) {
+        uint8_t last[kBlock] = {};
+        std::memcpy(last, p + blocks * kBlock, tail);
+        blocksScalar(lanes, last, 1);
+    }
+
+    uint64_t h = seed ^ (uint64_t(size) * 0x9E3779B97F4A7C15ull);
+    for (size_t j = 0; j < kLanes; ++j) {
+        h = mix64(h + lanes[j]);
+    }
+    return h;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    return hashBytes(data, size, seed, detectSimdLevel());
+}
+
+static const char* const kPoolNames[] = {
+    "transforms", "velocities", "grounded", "animations", "colliders", "sprites",
+};
+
+template <typename Pool>
+void StateHasher::updatePool(PoolHashes& out, Pool& pool, bool full) {
+    const size_t rows = pool.size();
+    const size_t chunks = pool.chunkCount();
+    if (out.chunks.size() != chunks) {
+        out.chunks.resize(chunks);
+    }
+    out.rows = rows;
+
+    const SimdLevel level = detectSimdLevel();
+    for (size_t c = 0; c < chunks; ++c) {
+        if (!full && !pool.dirty[c]) {
+            continue;
+        }
+        pool.dirty[c] = 0;
+        size_t b = c * Pool::kChunkRows;
+        size_t n = std::min(rows - b, Pool::kChunkRows);
+        uint64_t h = hashBytes(pool.entities.data() + b, n * sizeof(uint32_t), c, level);
+        pool.forEachColumn([&](auto& col) {
+            h = hashBytes(col.data() + b, n * sizeof(col[0]), h, level);
+        });
+        out.chunks[c] = h;
+        ++chunksHashed;
+    }
+    out.hash = hashBytes(out.chunks.data(), chunks * sizeof(uint64_t), rows, level);
+}
+
+uint64_t StateHasher::update(Registry& reg, bool full) {
+    chunksHashed = 0;
+    updatePool(pools[0], reg.transforms, full);
+    updatePool(pools[1], reg.velocities, full);
+    updatePool(pools[2], reg.grounded, full);
+    updatePool(pools[3], reg.animations, full);
+    updatePool(pools[4], reg.colliders, full);
+    updatePool(pools[5], reg.sprites, full);
+
+    uint64_t h = 0;
+    for (const PoolHashes& p : pools) {
+        h = mix64(h ^ p.hash);
+    }
+    combined = h;
+    return combined;
+}
+
+std::string StateHasher::firstDivergence(const StateHasher& other) const {
+    for (int i = 0; i < kPools; ++i) {
+        const PoolHashes& a = pools[i];
+        const PoolHashes& b = other.pools[i];
+        if (a.rows != b.rows) {
+            return std::string(kPoolNames[i]) + " row count " + std::to_string(a.rows) +
+                   " vs " + std::to_string(b.rows);
+        }
+        for (size_t c = 0; c < a.chunks.size(); ++c) {
+            if (a.chunks[c] != b.chunks[c]) {
+                size_t first = c * TransformPool::kChunkRows;
+                size_t last = std::min(a.rows, first + TransformPool::kChunkRows) - 1;
+                return std::string(kPoolNames[i]) + " chunk " + std::to_string(c) +
+                       " (rows " + std::to_string(first) + "-" + std::to_string(last) + ")";
+            }
+        }
+    }
+    return std::string();
+}
@@ -0,0 +1,61 @@
+#ifndef STATEHASH_HPP
+#define STATEHASH_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <vector>
+# include "Kinematics.hpp"
+# include "Registry.hpp"
+
+// Fast non-cryptographic hash for desync checks. Sixteen 32-bit lanes each
+// fold in one word per 64-byte block, then the lanes are mixed down to 64
+// bits. Every level returns the same value, so peers on different CPUs
+// agree. There is no SSE2 kernel (no 32-bit multiply before SSE4.1); those
+// CPUs take the scalar loop.
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed, SimdLevel level);
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed);
+
+// Incremental checksum of every component pool in a Registry. Each pool
+// keeps one hash per ComponentPool chunk; update() rehashes only chunks
+// flagged dirty since the previous call and then clears the flags, so use
+// one hasher per Registry.
+class StateHasher {
+public:
+    // Rehashes dirty chunks (every chunk when `full`) and returns the
+    // combined 64-bit checksum.
+    uint64_t update(Registry& reg, bool full = false);
+    uint64_t checksum() const { return combined; }
+
+    // Describes the first pool chunk whose hash differs from `other`, e.g.
+    // "transforms chunk 3 (rows 3072-4095)"; empty when both match.
+    std::string firstDivergence(const StateHasher& other) const;
+
+    size_t chunksHashed = 0; // by the last update()
+
+    template <typename Archive>
+    void snapshot(Archive& ar) {
+        for (PoolHashes& p : pools) {
+            ar.value(p.rows);
+            ar.array(p.chunks);
+            ar.value(p.hash);
+        }
+        ar.value(combined);
+    }
+
+private:
+    struct PoolHashes {
+        size_t rows = 0;
+        std::vector<uint64_t> chunks;
+        uint64_t hash = 0;
+    };
+
+    template <typename Pool>
+    void updatePool(PoolHashes& out, Pool& pool, bool full);
+
+    static constexpr int kPools = 6;
+    PoolHashes pools[kPools];
+    uint64_t combined = 0;
+};
+
+#endif
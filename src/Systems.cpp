@@ -0,0 +1,222 @@
+#include "Systems.hpp"
+#include "Animation.hpp"
+#include "Heightfield.hpp"
+#include "Kinematics.hpp"
+#include <algorithm>
+
+Entity spawnUnit(Registry& reg, const glm::vec3& position, uint16_t sheet) {
+    Entity e = reg.create();
+
+    uint32_t t = reg.transforms.insert(e.index);
+    reg.transforms.x[t] = position.x;
+    reg.transforms.y[t] = position.y;
+    reg.transforms.z[t] = position.z;
+    reg.transforms.height[t] = 1.0f;
+
+    uint32_t v = reg.velocities.insert(e.index);
+    reg.velocities.gravity[v] = -9.8f;
+    reg.velocities.jumpForce[v] = 5.0f;
+
+    uint32_t g = reg.grounded.insert(e.index);
+    reg.grounded.floorY[g] = 0.0f;
+    reg.grounded.grounded[g] = 1;
+
+    // no clip yet: a still pose on the first UV table entry
+    uint32_t a = reg.animations.insert(e.index);
+    reg.animations.clip[a] = AnimationLibrary::kNoClip;
+    reg.animations.frameCount[a] = 1;
+
+    uint32_t c = reg.colliders.insert(e.index);
+    reg.colliders.radius[c] = 0.3f;
+
+    uint32_t s = reg.sprites.insert(e.index);
+    reg.sprites.sheet[s] = sheet;
+
+    return e;
+}
+
+void setFloorHeight(Registry& reg, Entity e, float floorHeight) {
+    if (!reg.alive(e)) {
+        return;
+    }
+    uint32_t g = reg.grounded.row(e.index);
+    uint32_t t = reg.transforms.row(e.index);
+    uint32_t v = reg.velocities.row(e.index);
+    reg.grounded.floorY[g] = floorHeight;
+    // Place entity on top of the floor
+    reg.transforms.y[t] = floorHeight + reg.transforms.height[t] * 0.5f;
+    reg.velocities.y[v] = 0.0f;
+    reg.grounded.markDirty(g);
+    reg.transforms.markDirty(t);
+    reg.velocities.markDirty(v);
+}
+
+void playClip(Registry& reg, const AnimationLibrary& clips, Entity e, uint16_t clip, int facing) {
+    if (!reg.alive(e) || clip == AnimationLibrary::kNoClip) {
+        return;
+    }
+    AnimationPool& ap = reg.animations;
+    uint32_t a = ap.row(e.index);
+    if (ap.clip[a] == clip && ap.facing[a] == facing) {
+        return;
+    }
+    const AnimationClip& c = clips.clip(clip);
+    if (ap.clip[a] != clip) {
+        ap.clip[a] = clip;
+        ap.frameIndex[a] = 0;
+        ap.frameTimer[a] = 0.0f;
+        ap.frameCount[a] = c.frames;
+        ap.frameDuration[a] = c.frameDuration;
+    }
+    ap.facing[a] = static_cast<uint8_t>(facing);
+    ap.uvBase[a] = clips.uvIndex(clip, facing, 0);
+    ap.markDirty(a);
+}
+
+void jump(Registry& reg, Entity e) {
+    if (!reg.alive(e)) {
+        return;
+    }
+    uint32_t g = reg.grounded.row(e.index);
+    if (reg.grounded.grounded[g]) {
+        uint32_t v = reg.velocities.row(e.index);
+        reg.velocities.y[v] = reg.velocities.jumpForce[v];
+        reg.grounded.grounded[g] = 0;
+        reg.velocities.markDirty(v);
+        reg.grounded.markDirty(g);
+    }
+}
+
+glm::vec3 getPosition(const Registry& reg, Entity e) {
+    uint32_t t = reg.transforms.row(e.index);
+    return glm::vec3(reg.transforms.x[t], reg.transforms.y[t], reg.transforms.z[t]);
+}
+
+void translate(Registry& reg, Entity e, const glm::vec3& delta) {
+    uint32_t t = reg.transforms.row(e.index);
+    reg.transforms.x[t] += delta.x;
+    reg.transforms.y[t] += delta.y;
+    reg.transforms.z[t] += delta.z;
+    reg.transforms.markDirty(t);
+}
+
+void kinematicsRows(Registry& reg, float dt, size_t begin, size_t end) {
+    TransformPool& tp = reg.transforms;
+    VelocityPool& vp = reg.velocities;
+    GroundedPool& gp = reg.grounded;
+
+    KinematicsBatch batch;
+    batch.px = tp.x.data() + begin;
+    batch.py = tp.y.data() + begin;
+    batch.pz = tp.z.data() + begin;
+    batch.height = tp.height.data() + begin;
+    batch.vx = vp.x.data() + begin;
+    batch.vy = vp.y.data() + begin;
+    batch.vz = vp.z.data() + begin;
+    batch.gravity = vp.gravity.data() + begin;
+    batch.floorY = gp.floorY.data() + begin;
+    batch.grounded = gp.grounded.data() + begin;
+    batch.count = end - begin;
+    integrateKinematics(batch, dt);
+    tp.markDirty(begin, end);
+    vp.markDirty(begin, end);
+    gp.markDirty(begin, end);
+}
+
+void kinematicsSystem(Registry& reg, float dt) {
+    if (reg.kinematicsPacked()) {
+        kinematicsRows(reg, dt, 0, reg.transforms.size());
+        return;
+    }
+
+    TransformPool& tp = reg.transforms;
+    VelocityPool& vp = reg.velocities;
+    GroundedPool& gp = reg.grounded;
+
+    // Pools diverged (some entity lacks one of the components): drive the
+    // loop from velocities and resolve the other rows through the sparse sets.
+    for (size_t v = 0; v < vp.size(); ++v) {
+        uint32_t e = vp.entities[v];
+        if (!tp.has(e) || !gp.has(e)) {
+            continue;
+        }
+        uint32_t t = tp.row(e);
+        uint32_t g = gp.row(e);
+        kinematicsRow(tp.x[t], tp.y[t], tp.z[t], tp.height[t], vp.x[v], vp.y[v], vp.z[v],
+                      vp.gravity[v], gp.floorY[g], gp.grounded[g], dt);
+        tp.markDirty(t);
+        vp.markDirty(v);
+        gp.markDirty(g);
+    }
+}
+
+void groundHeightRows(Registry& reg, const Heightfield& terrain, size_t begin, size_t end) {
+    terrain.heightsAt(reg.transforms.x.data() + begin, reg.transforms.z.data() + begin,
+                      reg.grounded.floorY.data() + begin, end - begin);
+    reg.grounded.markDirty(begin, end);
+}
+
+void groundHeightSystem(Registry& reg, const Heightfield& terrain) {
+    if (reg.kinematicsPacked()) {
+        groundHeightRows(reg, terrain, 0, reg.grounded.size());
+        return;
+    }
+    GroundedPool& gp = reg.grounded;
+    const TransformPool& tp = reg.transforms;
+    for (size_t g = 0; g < gp.size(); ++g) {
+        uint32_t e = gp.entities[g];
+        if (tp.has(e)) {
+            uint32_t t = tp.row(e);
+            gp.floorY[g] = terrain.heightAt(tp.x[t], tp.z[t]);
+            gp.markDirty(g);
+        }
+    }
+}
+
+void animationRows(Registry& reg, float dt, size_t begin, size_t end) {
+    AnimationPool& ap = reg.animations;
+    // chunk by chunk, so a chunk of still poses is left clean
+    for (size_t c = begin; c < end;) {
+        size_t last = std::min(end, (c / AnimationPool::kChunkRows + 1) * AnimationPool::kChunkRows);
+        if (advanceAnimations(ap.frameIndex.data() + c, ap.frameTimer.data() + c,
+                              ap.frameCount.data() + c, ap.frameDuration.data() + c,
+                              last - c, dt)) {
+            ap.markDirty(c);
+        }
+        c = last;
+    }
+}
+
+void animationSystem(Registry& reg, float dt) {
+    animationRows(reg, dt, 0, reg.animations.size());
+}
+
+void separationSystem(Registry& reg, SeparationState& state) {
+    ColliderPool& cp = reg.colliders;
+    TransformPool& tp = reg.transforms;
+    const size_t n = cp.size();
+
+    state.x.resize(n);
+    state.z.resize(n);
+    state.dx.resize(n);
+    state.dz.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t t = tp.row(cp.entities[i]);
+        state.x[i] = tp.x[t];
+        state.z[i] = tp.z[t];
+    }
+
+    state.hash.build(state.x.data(), state.z.data(), cp.radius.data(), n);
+    state.pairs = state.hash.resolveOverlaps(state.dx.data(), state.dz.data());
+    if (state.pairs == 0) {
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (state.dx[i] != 0.0f || state.dz[i] != 0.0f) {
+            uint32_t t = tp.row(cp.entities[i]);
+            tp.x[t] += state.dx[i];
+            tp.z[t] += state.dz[i];
+            tp.markDirty(t);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SYSTEMS_HPP
+#define SYSTEMS_HPP
+
+# include <vector>
+# include <glm/glm.hpp>
+# include "Registry.hpp"
+# include "SpatialHash.hpp"
+
+class AnimationLibrary;
+class Heightfield;
+
+// Creates a unit with every component the game uses, with the defaults the
+// old Player class had (1 unit tall, standing on floorY = 0).
+Entity spawnUnit(Registry& reg, const glm::vec3& position, uint16_t sheet);
+
+void setFloorHeight(Registry& reg, Entity e, float floorHeight);
+// Switches to `clip` at `facing`. A new clip restarts from frame 0; a new
+// facing alone keeps the frame and timer so a turning walk stays in step.
+void playClip(Registry& reg, const AnimationLibrary& clips, Entity e, uint16_t clip, int facing);
+void jump(Registry& reg, Entity e);
+
+glm::vec3 getPosition(const Registry& reg, Entity e);
+void translate(Registry& reg, Entity e, const glm::vec3& delta);
+
+// Gravity, velocity integration and ground clamp for every entity that has
+// a transform, a velocity and a grounded component.
+void kinematicsSystem(Registry& reg, float dt);
+
+// Samples the terrain under every grounded-component entity into floorY,
+// in one batched query, ahead of the kinematics ground clamp.
+void groundHeightSystem(Registry& reg, const Heightfield& terrain);
+
+// Advances every animation timer and frame. Still poses have a zero
+// frame duration and simply never step, so the loop has no per-entity
+// branches.
+void animationSystem(Registry& reg, float dt);
+
+// Broadphase and scratch buffers reused by separationSystem between ticks.
+struct SeparationState {
+    SpatialHash hash;
+    std::vector<float> x, z, dx, dz;
+    size_t pairs = 0;
+};
+
+// Rebuilds the spatial hash from every collider and pushes overlapping
+// units apart on the XZ plane.
+void separationSystem(Registry& reg, SeparationState& state);
+
+// Row-range variants used by the parallel update. kinematicsRows requires
+// reg.kinematicsPacked(); rows index the transform/velocity/grounded pools.
+// Each marks the chunks it writes dirty, so concurrent ranges must be
+// aligned to ComponentPool::kChunkRows.
+void kinematicsRows(Registry& reg, float dt, size_t begin, size_t end);
+void groundHeightRows(Registry& reg, const Heightfield& terrain, size_t begin, size_t end);
+void animationRows(Registry& reg, float dt, size_t begin, size_t end);
+
+#endif
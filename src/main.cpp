@@ -1,13 +1,30 @@
 #include <SDL3/SDL.h>
+#include <cstring>
 #include <iostream>
 
 #include "Game.hpp"
 
-int main() {
+int main(int argc, char** argv) {
 	Game game;
 	if (!game.init("SDL3 Test Window", 800, 600)) {
 		return 1;
 	}
+	// --record <file> saves this session's input, --replay <file> plays one back;
+	// the two cannot be combined
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (std::strcmp(argv[i], "--record") == 0) {
+			if (!game.recordTo(argv[i + 1])) {
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--replay") == 0) {
+			if (!game.playReplay(argv[i + 1])) {
+				return 1;
+			}
+		} else {
+			std::cerr << "Unknown option: " << argv[i] << "\n";
+			return 1;
+		}
+	}
 	game.run();
 	game.clean();
 	return 0;
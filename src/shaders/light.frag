@@ -0,0 +1,19 @@
+#version 330 core
+flat in uvec2 vList; // first entry in uTileLights, light count
+
+out vec4 FragColor;
+
+uniform samplerBuffer uLights;      // per light: (x, y, radius, 0) in pixels, (r, g, b, 0)
+uniform usamplerBuffer uTileLights; // light indices, grouped by tile
+uniform vec3 uAmbient;
+
+void main() {
+    vec3 sum = uAmbient;
+    for (uint i = 0u; i < vList.y; ++i) {
+        int l = int(texelFetch(uTileLights, int(vList.x + i)).r);
+        vec4 disc = texelFetch(uLights, 2 * l);
+        float f = max(1.0 - distance(gl_FragCoord.xy, disc.xy) / disc.z, 0.0);
+        sum += texelFetch(uLights, 2 * l + 1).rgb * (f * f);
+    }
+    FragColor = vec4(sum, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+// One lit tile of the light buffer per instance, six vertices each; no
+// vertex attributes. Unlit tiles keep the ambient clear colour.
+uniform usamplerBuffer uTiles; // x, y in tiles, first list entry, light count
+uniform vec2 uBufferSize;      // light buffer, pixels
+uniform float uTileSize;       // pixels
+
+flat out uvec2 vList;
+
+const vec2 kCorners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+                                 vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0));
+
+void main() {
+    uvec4 tile = texelFetch(uTiles, gl_InstanceID);
+    vec2 p = min((vec2(tile.xy) + kCorners[gl_VertexID]) * uTileSize, uBufferSize);
+    gl_Position = vec4(p / uBufferSize * 2.0 - 1.0, 0.0, 1.0);
+    vList = tile.zw;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+in vec2 vUV;
+in vec2 vCorner;
+in vec4 vColor;
+flat in uint vFlags;
+flat in int vMap;
+
+out vec4 FragColor;
+
+uniform sampler2D uTerrain; // shaded once at load, patched per tile
+uniform sampler2D uFog;     // 1 visible, 0.5 explored, 0 unexplored
+
+void main() {
+    float fog = texture(uFog, vUV).r;
+    if (vMap == 1) {
+        // unexplored ground stays faintly readable
+        FragColor = vec4(texture(uTerrain, vUV).rgb * mix(0.15, 1.0, fog), 1.0);
+        return;
+    }
+    // other units only show where the player currently sees
+    if (dot(vCorner, vCorner) > 1.0 || ((vFlags & 1u) == 0u && fog < 0.75)) {
+        discard;
+    }
+    FragColor = vColor;
+}
@@ -0,0 +1,36 @@
+#version 330 core
+// Instance 0 is the whole map, every other instance one unit dot; six
+// vertices each, drawn into the minimap target (map UV = clip space).
+layout(location = 0) in vec2 aPos;   // map UV of the dot
+layout(location = 1) in vec4 aColor;
+layout(location = 2) in uint aFlags; // Minimap::kOwn, kSelected
+
+uniform float uDotSize; // map UV
+
+out vec2 vUV;     // map UV, for the terrain and the fog
+out vec2 vCorner; // -1..1 across a dot
+out vec4 vColor;
+flat out uint vFlags;
+flat out int vMap;
+
+const vec2 kCorners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+                                 vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0));
+
+void main() {
+    vec2 corner = kCorners[gl_VertexID];
+    vMap = gl_InstanceID == 0 ? 1 : 0;
+    vec2 p;
+    if (vMap == 1) {
+        p = corner;
+        vUV = corner;
+    } else {
+        // selected units a little larger
+        float size = (aFlags & 2u) != 0u ? uDotSize * 1.5 : uDotSize;
+        p = aPos + (corner - 0.5) * size;
+        vUV = aPos;
+    }
+    vCorner = corner * 2.0 - 1.0;
+    vColor = aColor;
+    vFlags = aFlags;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
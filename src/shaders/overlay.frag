@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 vUV;
+in vec4 vColor;
+
+out vec4 FragColor;
+
+uniform sampler2D uFont; // glyph coverage in red
+
+void main() {
+    FragColor = vec4(vColor.rgb, vColor.a * texture(uFont, vUV).r);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout(location = 0) in vec2 aPos;   // pixels from the top left
+layout(location = 1) in vec2 aUV;    // atlas texels
+layout(location = 2) in vec4 aColor;
+
+uniform vec2 uScreen;    // viewport, pixels
+uniform vec2 uAtlasSize; // texels
+
+out vec2 vUV;
+out vec4 vColor;
+
+void main() {
+    vUV = aUV / uAtlasSize;
+    vColor = aColor;
+    gl_Position = vec4(aPos.x / uScreen.x * 2.0 - 1.0, 1.0 - aPos.y / uScreen.y * 2.0, 0.0, 1.0);
+}
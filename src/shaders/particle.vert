@@ -0,0 +1,29 @@
+#version 330 core
+layout(location = 0) in vec2 aPos; // quad corner, -0.5..0.5
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 iParticle; // position, fraction of life used (>= 1: dead)
+
+uniform mat4 uViewProj;
+uniform vec3 uRight; // camera axes in world space
+uniform vec3 uUp;
+// the pool's ParticleType: start and end of life
+uniform vec2 uSize;
+uniform vec4 uColorStart;
+uniform vec4 uColorEnd;
+
+out vec2 vUV;
+out vec4 vColor;
+
+void main() {
+    float t = iParticle.w;
+    if (t >= 1.0) {
+        // an expired GPU particle slot: outside the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    float size = mix(uSize.x, uSize.y, t);
+    vUV = aUV;
+    vColor = mix(uColorStart, uColorEnd, t);
+    vec3 p = iParticle.xyz + (uRight * aPos.x + uUp * aPos.y) * size;
+    gl_Position = uViewProj * vec4(p, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+// One particle per point; the result is captured by transform feedback
+// into the other buffer (see GpuParticles), nothing is rasterised.
+layout(location = 0) in vec4 aState;  // position, fraction of life used
+layout(location = 1) in vec4 aMotion; // velocity, 1 / lifetime
+
+uniform float uDt;
+uniform float uGravityDt; // gravity * dt
+uniform float uDamp;      // velocity scale for this step
+
+out vec4 vState;
+out vec4 vMotion;
+
+void main() {
+    if (aState.w >= 1.0) {
+        // dead slots stay as they are until a spawn reuses them
+        vState = aState;
+        vMotion = aMotion;
+        return;
+    }
+    vec3 v = aMotion.xyz;
+    v.y += uGravityDt;
+    v *= uDamp;
+    vState = vec4(aState.xyz + v * uDt, aState.w + uDt * aMotion.w);
+    vMotion = vec4(v, aMotion.w);
+}
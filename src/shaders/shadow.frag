@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 vUV;
+in float vAlpha;
+
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform int uLayer; // 1: write darkness into the shadow layer
+
+void main() {
+    vec4 c = texture(uTexture, vUV);
+    float a = c.a * vAlpha;
+    // the layer accumulates premultiplied darkness (blended ONE, 1 - a)
+    FragColor = uLayer == 1 ? vec4(a) : vec4(c.rgb, a);
+}
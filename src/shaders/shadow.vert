@@ -0,0 +1,19 @@
+#version 330 core
+layout(location = 0) in vec2 aPos; // quad corner on the XZ plane, -0.5..0.5
+layout(location = 1) in vec2 aUV;
+// per instance, see ShadowInstance
+layout(location = 2) in vec3 iPos;
+layout(location = 3) in vec2 iScale;
+layout(location = 4) in float iAlpha;
+
+// world to clip space, or world XZ to the shadow layer
+uniform mat4 uViewProj;
+
+out vec2 vUV;
+out float vAlpha;
+
+void main() {
+    vUV = aUV;
+    vAlpha = iAlpha;
+    gl_Position = uViewProj * vec4(iPos + vec3(aPos.x * iScale.x, 0.0, aPos.y * iScale.y), 1.0);
+}
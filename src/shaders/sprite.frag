@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 vUV;
+flat in uint vFlags;
+
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+
+void main() {
+    FragColor = texture(uTexture, vUV);
+    if ((vFlags & 1u) != 0u) {
+        // selected units get a yellow tint
+        FragColor *= vec4(1.0, 1.0, 0.55, 1.0);
+    }
+}
@@ -0,0 +1,41 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aUV;
+// per instance, see SpriteInstance
+layout(location = 2) in vec3 iPos;
+layout(location = 3) in uint iAnim;
+layout(location = 4) in uint iFlags;
+
+uniform mat4 uViewProj;
+uniform mat3 uBillboard;            // turns the quad to face the camera
+uniform int uClipMode;              // 0: iAnim is a UV table index, 1: an animation row
+uniform float uClock;               // animation clock, seconds
+uniform samplerBuffer uUVs;         // u0, v0, u1, v1 per clip frame
+uniform usamplerBuffer uClips;      // firstUv, frames, frameDuration bits
+uniform usamplerBuffer uClipStates; // clip, facing, start bits, rate bits
+
+out vec2 vUV;
+flat out uint vFlags;
+
+int clipFrame(int row) {
+    uvec4 state = texelFetch(uClipStates, row);
+    if (state.x == 0xFFFFu) {
+        return 0;
+    }
+    uvec4 clip = texelFetch(uClips, int(state.x));
+    float duration = uintBitsToFloat(clip.z);
+    int frame = 0;
+    if (duration > 0.0) {
+        float elapsed = (uClock - uintBitsToFloat(state.z)) * uintBitsToFloat(state.w);
+        frame = int(mod(floor(elapsed / duration), float(clip.y)));
+    }
+    return int(clip.x + state.y * clip.y) + frame;
+}
+
+void main() {
+    int index = uClipMode == 1 ? clipFrame(int(iAnim)) : int(iAnim);
+    vec4 rect = texelFetch(uUVs, index);
+    vUV = mix(rect.xy, rect.zw, aUV);
+    vFlags = iFlags;
+    gl_Position = uViewProj * vec4(iPos + uBillboard * aPos, 1.0);
+}